@@ -0,0 +1,351 @@
+#include "audio_decoder.h"
+#include <QDebug>
+#include <QMutexLocker>
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+AudioDecoder::AudioDecoder(std::shared_ptr<AudioOutput> output, int maxPackets)
+    : m_output(std::move(output)),
+      m_queue(maxPackets, 0)
+{
+}
+
+AudioDecoder::~AudioDecoder()
+{
+    stop();
+    avcodec_parameters_free(&m_pendingPar);
+}
+
+void AudioDecoder::start(std::shared_ptr<FramePresenter> clock)
+{
+    if (m_running.load())
+    {
+        return;
+    }
+    m_clock = std::move(clock);
+    m_queue.reset(AVRational{1, 1000});
+    m_aligned = false;
+    m_running.store(true);
+    m_thread = std::thread(&AudioDecoder::run, this);
+}
+
+void AudioDecoder::stop()
+{
+    m_running.store(false);
+    m_queue.abort();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    freeCodec();
+}
+
+void AudioDecoder::beginStream(const AVCodecParameters *par, AVRational timeBase)
+{
+    {
+        QMutexLocker locker(&m_paramMutex);
+        avcodec_parameters_free(&m_pendingPar);
+        m_pendingPar = avcodec_parameters_alloc();
+        if (m_pendingPar && avcodec_parameters_copy(m_pendingPar, par) < 0)
+        {
+            avcodec_parameters_free(&m_pendingPar);
+        }
+        m_pendingTimeBase = timeBase;
+    }
+    m_queue.reset(timeBase);
+}
+
+void AudioDecoder::pushPacket(AVPacket *packet)
+{
+    // 音频包都可独立解码，包队列溢出后不必等待关键帧
+    packet->flags |= AV_PKT_FLAG_KEY;
+    m_queue.push(packet);
+}
+
+void AudioDecoder::run()
+{
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    while (m_running.load())
+    {
+        int ret = m_queue.pop(packet, 100);
+        if (ret < 0)
+            break;
+        if (ret == 0)
+            continue;
+
+        if (!openCodec())
+        {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        const qint64 beginUs = av_gettime_relative();
+        ret = avcodec_send_packet(m_codecCtx, packet);
+        av_packet_unref(packet);
+        if (ret < 0 && ret != AVERROR(EAGAIN))
+        {
+            m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        while ((ret = avcodec_receive_frame(m_codecCtx, frame)) >= 0)
+        {
+            m_framesDecoded.fetch_add(1, std::memory_order_relaxed);
+            processFrame(frame);
+            av_frame_unref(frame);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+        {
+            m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_decodeUsTotal.fetch_add(static_cast<quint64>(av_gettime_relative() - beginUs), std::memory_order_relaxed);
+    }
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+}
+
+bool AudioDecoder::openCodec()
+{
+    AVCodecParameters *par = nullptr;
+    {
+        QMutexLocker locker(&m_paramMutex);
+        par = m_pendingPar;
+        m_pendingPar = nullptr;
+        m_timeBase = par ? m_pendingTimeBase : m_timeBase;
+    }
+    if (!par)
+    {
+        return m_codecCtx != nullptr;
+    }
+
+    freeCodec();
+    const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+    if (codec)
+    {
+        m_codecCtx = avcodec_alloc_context3(codec);
+    }
+    bool ok = m_codecCtx && avcodec_parameters_to_context(m_codecCtx, par) >= 0;
+    if (ok)
+    {
+        // 音频解码量很小，单线程即可，避免帧级多线程带来的额外延迟
+        m_codecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        m_codecCtx->thread_count = 1;
+        m_codecCtx->pkt_timebase = m_timeBase;
+        ok = avcodec_open2(m_codecCtx, codec, nullptr) >= 0;
+    }
+    avcodec_parameters_free(&par);
+    if (!ok)
+    {
+        qWarning() << "Failed to open audio decoder";
+        freeCodec();
+        return false;
+    }
+    m_codecName.store(codec->name, std::memory_order_relaxed);
+    m_aligned = false;
+    m_errorAvgUs = 0;
+    m_nextPtsUs = 0;
+    return true;
+}
+
+bool AudioDecoder::initResampler(const AVFrame *frame)
+{
+    if (m_swr && frame->format == m_swrInFormat && frame->sample_rate == m_swrInRate &&
+        av_channel_layout_compare(&frame->ch_layout, &m_swrInLayout) == 0)
+    {
+        return true;
+    }
+    swr_free(&m_swr);
+    av_channel_layout_uninit(&m_swrInLayout);
+
+    // 只给出声道数的流按默认声道排列处理
+    AVChannelLayout inLayout{};
+    if (frame->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+    {
+        av_channel_layout_default(&inLayout, frame->ch_layout.nb_channels);
+    }
+    else if (av_channel_layout_copy(&inLayout, &frame->ch_layout) < 0)
+    {
+        return false;
+    }
+    AVChannelLayout outLayout{};
+    av_channel_layout_default(&outLayout, m_output->channels());
+    int ret = swr_alloc_set_opts2(&m_swr, &outLayout, AV_SAMPLE_FMT_S16, m_output->sampleRate(),
+                                  &inLayout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
+                                  0, nullptr);
+    av_channel_layout_uninit(&outLayout);
+    av_channel_layout_uninit(&inLayout);
+    if (ret < 0 || swr_init(m_swr) < 0)
+    {
+        qWarning() << "Failed to initialize audio resampler";
+        swr_free(&m_swr);
+        return false;
+    }
+    av_channel_layout_copy(&m_swrInLayout, &frame->ch_layout);
+    m_swrInFormat = frame->format;
+    m_swrInRate = frame->sample_rate;
+    m_inputRate.store(frame->sample_rate, std::memory_order_relaxed);
+    m_inputChannels.store(frame->ch_layout.nb_channels, std::memory_order_relaxed);
+    return true;
+}
+
+int AudioDecoder::correctedSamples(const AVFrame *frame, qint64 ptsUs)
+{
+    const int samples = frame->nb_samples;
+    qint64 desiredUs = 0;
+    if (!m_clock || !m_clock->presentationTimeUs(ptsUs, &desiredUs))
+    {
+        // 视频时钟尚未建立：到达即播放
+        return samples;
+    }
+
+    // 欠载说明缓冲已经放空，播放位置与时钟的关系需要重新建立
+    const quint64 underruns = m_output->underruns();
+    if (underruns != m_seenUnderruns)
+    {
+        m_seenUnderruns = underruns;
+        m_aligned = false;
+    }
+
+    // 本帧第一个样本实际播放的时间 = 现在 + 已缓冲的时长，与时钟要求的时间之差即同步误差
+    const qint64 errorUs = LatencyTracer::nowUs() + m_output->latencyUs() - desiredUs;
+    if (!m_aligned)
+    {
+        const qint64 durationUs = static_cast<qint64>(samples) * 1000000 / frame->sample_rate;
+        if (errorUs > durationUs)
+        {
+            // 整帧都已过了播放时间：跳过，直到追上时钟
+            m_skippedUs.fetch_add(static_cast<quint64>(durationUs), std::memory_order_relaxed);
+            return -1;
+        }
+        if (errorUs < 0)
+        {
+            writeSilence(qMin(-errorUs, kMaxAlignUs));
+        }
+        m_aligned = true;
+        m_errorAvgUs = 0;
+        m_alignments.fetch_add(1, std::memory_order_relaxed);
+        return samples;
+    }
+
+    m_errorAvgUs += (static_cast<double>(errorUs) - m_errorAvgUs) * kErrorSmoothing;
+    m_syncErrorUs.store(static_cast<qint64>(m_errorAvgUs), std::memory_order_relaxed);
+    if (qAbs(m_errorAvgUs) < kSyncThresholdUs)
+    {
+        m_correctionPpm.store(0, std::memory_order_relaxed);
+        return samples;
+    }
+
+    // 偏晚时少输出样本（播放略快），偏早时多输出样本（播放略慢），幅度不超过 kMaxCorrection
+    const double maxDelta = samples * kMaxCorrection;
+    const double delta = qBound(-maxDelta, -m_errorAvgUs * frame->sample_rate / 1e6, maxDelta);
+    const int wanted = samples + qRound(delta);
+    m_correctionPpm.store(static_cast<int>((wanted - samples) * 1e6 / samples), std::memory_order_relaxed);
+    if (wanted != samples)
+    {
+        m_correctedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    return wanted;
+}
+
+void AudioDecoder::processFrame(AVFrame *frame)
+{
+    if (frame->sample_rate <= 0 || !initResampler(frame))
+    {
+        m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const int64_t ts = frame->best_effort_timestamp;
+    const qint64 ptsUs = ts != AV_NOPTS_VALUE ? av_rescale_q(ts, m_timeBase, AV_TIME_BASE_Q) : m_nextPtsUs;
+    m_nextPtsUs = ptsUs + static_cast<qint64>(frame->nb_samples) * 1000000 / frame->sample_rate;
+
+    const int wanted = correctedSamples(frame, ptsUs);
+    if (wanted < 0)
+    {
+        return;
+    }
+    const int outRate = m_output->sampleRate();
+    if (wanted != frame->nb_samples)
+    {
+        // 在本帧的时长内平摊增减的样本数，听感上只是极小的变速
+        swr_set_compensation(m_swr,
+                             (wanted - frame->nb_samples) * outRate / frame->sample_rate,
+                             wanted * outRate / frame->sample_rate);
+    }
+
+    const int capacity = wanted * outRate / frame->sample_rate + 256;
+    const int frameBytes = m_output->bytesPerFrame();
+    m_pcm.resize(static_cast<size_t>(capacity) * frameBytes);
+    uint8_t *out = m_pcm.data();
+    const int converted = swr_convert(m_swr, &out, capacity,
+                                      const_cast<const uint8_t **>(frame->extended_data), frame->nb_samples);
+    if (converted < 0)
+    {
+        m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    writePcm(out, static_cast<size_t>(converted) * frameBytes);
+}
+
+void AudioDecoder::writePcm(const uint8_t *data, size_t size)
+{
+    // 只按整帧写入，声卡回调读到的总是完整的采样帧
+    ByteRing &ring = m_output->ring();
+    const size_t frameBytes = static_cast<size_t>(m_output->bytesPerFrame());
+    size_t offset = 0;
+    while (offset < size && m_running.load())
+    {
+        const size_t space = (ring.capacity() - ring.available()) / frameBytes * frameBytes;
+        if (space == 0)
+        {
+            ring.waitForSpace(frameBytes, 50);
+            continue;
+        }
+        offset += ring.write(data + offset, qMin(space, size - offset));
+    }
+}
+
+void AudioDecoder::writeSilence(qint64 durationUs)
+{
+    const size_t frames = static_cast<size_t>(durationUs * m_output->sampleRate() / 1000000);
+    if (frames == 0)
+    {
+        return;
+    }
+    const std::vector<uint8_t> silence(frames * static_cast<size_t>(m_output->bytesPerFrame()), 0);
+    writePcm(silence.data(), silence.size());
+    m_silenceUs.fetch_add(static_cast<quint64>(durationUs), std::memory_order_relaxed);
+}
+
+void AudioDecoder::freeCodec()
+{
+    avcodec_free_context(&m_codecCtx);
+    swr_free(&m_swr);
+    av_channel_layout_uninit(&m_swrInLayout);
+    m_swrInFormat = -1;
+    m_swrInRate = 0;
+}
+
+AudioDecoder::Stats AudioDecoder::stats() const
+{
+    Stats s;
+    s.codec = m_codecName.load(std::memory_order_relaxed);
+    s.inputRate = m_inputRate.load(std::memory_order_relaxed);
+    s.inputChannels = m_inputChannels.load(std::memory_order_relaxed);
+    s.framesDecoded = m_framesDecoded.load(std::memory_order_relaxed);
+    s.decodeErrors = m_decodeErrors.load(std::memory_order_relaxed);
+    s.avgDecodeUs = s.framesDecoded
+                        ? static_cast<double>(m_decodeUsTotal.load(std::memory_order_relaxed)) / s.framesDecoded
+                        : 0;
+    s.syncErrorMs = m_syncErrorUs.load(std::memory_order_relaxed) / 1000.0;
+    s.correctionPct = m_correctionPpm.load(std::memory_order_relaxed) / 10000.0;
+    s.correctedFrames = m_correctedFrames.load(std::memory_order_relaxed);
+    s.alignments = m_alignments.load(std::memory_order_relaxed);
+    s.silenceInsertedMs = m_silenceUs.load(std::memory_order_relaxed) / 1000.0;
+    s.skippedMs = m_skippedUs.load(std::memory_order_relaxed) / 1000.0;
+    s.queue = m_queue.stats();
+    return s;
+}
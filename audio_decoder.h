@@ -0,0 +1,138 @@
+#ifndef AUDIODECODER_H
+#define AUDIODECODER_H
+
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+}
+
+#include "audio_output.h"
+#include "frame_presenter.h"
+#include "packet_queue.h"
+
+/**
+ * @brief 音频解码分支：解码、重采样到声卡格式后写入 AudioOutput 的环形缓冲
+ *
+ * 读取线程把音频包交给本对象的包队列，解码和重采样在独立线程中进行，不占用视频解码线程。
+ * 与视频共用 FramePresenter 的时钟：每帧按 PTS 换算出应播放的本地时间，
+ * 与“当前时间 + 已缓冲音频时长”比较，偏差经平均后用 swr_set_compensation
+ * 以不超过 kMaxCorrection 的速率微调重采样，逐渐消除而不是丢弃或插入样本。
+ * 流开始（或欠载后重新出声）时一次性对齐：音频偏早时补静音，偏晚时跳过开头的帧。
+ */
+class AudioDecoder
+{
+public:
+    /**
+     * @brief 音频解码统计信息
+     */
+    struct Stats
+    {
+        const char *codec = "";         // 解码器名称
+        int inputRate = 0;              // 流的采样率
+        int inputChannels = 0;          // 流的声道数
+        quint64 framesDecoded = 0;      // 解码出的音频帧数
+        quint64 decodeErrors = 0;       // 解码出错的次数
+        double avgDecodeUs = 0;         // 每帧平均解码 + 重采样耗时
+        double syncErrorMs = 0;         // 平均后的同步误差，正值表示音频偏晚
+        double correctionPct = 0;       // 当前重采样速率微调量（百分比）
+        quint64 correctedFrames = 0;    // 经速率微调的帧数
+        quint64 alignments = 0;         // 流开始或欠载后的一次性对齐次数
+        double silenceInsertedMs = 0;   // 对齐时补入的静音时长
+        double skippedMs = 0;           // 对齐时跳过的音频时长
+        PacketQueue::Stats queue;       // 音频包队列
+    };
+
+    /**
+     * @param output 声卡输出，需已成功 start()
+     * @param maxPackets 音频包队列上限
+     */
+    AudioDecoder(std::shared_ptr<AudioOutput> output, int maxPackets);
+    ~AudioDecoder();
+
+    AudioDecoder(const AudioDecoder &) = delete;
+    AudioDecoder &operator=(const AudioDecoder &) = delete;
+
+    /**
+     * @brief 开始一次连接的音频解码线程
+     * @param clock 视频的抖动缓冲，提供同步时钟；为空时音频到达即播放
+     */
+    void start(std::shared_ptr<FramePresenter> clock);
+
+    /**
+     * @brief 结束解码线程，队列中的包丢弃
+     */
+    void stop();
+
+    /**
+     * @brief 新的音频流开始（读取线程调用），解码线程在下一个包前按新参数重新打开解码器
+     */
+    void beginStream(const AVCodecParameters *par, AVRational timeBase);
+
+    /**
+     * @brief 写入一个音频包（读取线程调用），成功时接管 packet 的数据引用
+     */
+    void pushPacket(AVPacket *packet);
+
+    Stats stats() const;
+
+private:
+    void run();
+    bool openCodec();
+    bool initResampler(const AVFrame *frame);
+    void processFrame(AVFrame *frame);
+    int correctedSamples(const AVFrame *frame, qint64 ptsUs);
+    void writePcm(const uint8_t *data, size_t size);
+    void writeSilence(qint64 durationUs);
+    void freeCodec();
+
+    static constexpr qint64 kSyncThresholdUs = 10000;   // 平均误差超过该值才开始微调
+    static constexpr qint64 kMaxAlignUs = 500000;       // 一次性对齐时最多补入的静音
+    static constexpr double kMaxCorrection = 0.01;      // 重采样速率最多偏离 1%
+    static constexpr double kErrorSmoothing = 0.1;      // 同步误差的指数平均系数
+
+    const std::shared_ptr<AudioOutput> m_output;
+    PacketQueue m_queue;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::shared_ptr<FramePresenter> m_clock;
+
+    // 读取线程交来的新流参数，解码线程取走后重新打开解码器
+    QMutex m_paramMutex;
+    AVCodecParameters *m_pendingPar = nullptr;
+    AVRational m_pendingTimeBase{1, 1000};
+
+    // 以下仅限解码线程
+    AVCodecContext *m_codecCtx = nullptr;
+    SwrContext *m_swr = nullptr;
+    AVRational m_timeBase{1, 1000};
+    AVChannelLayout m_swrInLayout{};
+    int m_swrInFormat = -1;
+    int m_swrInRate = 0;
+    std::vector<uint8_t> m_pcm;             // 重采样输出
+    qint64 m_nextPtsUs = 0;                 // 无时间戳时按上一帧推算
+    bool m_aligned = false;                 // 是否已完成本次出声的对齐
+    quint64 m_seenUnderruns = 0;            // 上次检查时的欠载次数
+    double m_errorAvgUs = 0;
+
+    std::atomic<const char *> m_codecName{""};
+    std::atomic<int> m_inputRate{0};
+    std::atomic<int> m_inputChannels{0};
+    std::atomic<quint64> m_framesDecoded{0};
+    std::atomic<quint64> m_decodeErrors{0};
+    std::atomic<quint64> m_decodeUsTotal{0};
+    std::atomic<qint64> m_syncErrorUs{0};
+    std::atomic<int> m_correctionPpm{0};
+    std::atomic<quint64> m_correctedFrames{0};
+    std::atomic<quint64> m_alignments{0};
+    std::atomic<quint64> m_silenceUs{0};
+    std::atomic<quint64> m_skippedUs{0};
+};
+
+#endif // AUDIODECODER_H
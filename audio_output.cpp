@@ -0,0 +1,201 @@
+#include "audio_output.h"
+#include <QAudioDeviceInfo>
+#include <QAudioFormat>
+#include <QAudioOutput>
+#include <QDebug>
+#include <QIODevice>
+#include <cstring>
+
+/**
+ * @brief 供 QAudioOutput 拉取数据的只读设备，数据直接取自环形缓冲
+ */
+class AudioOutput::RingDevice : public QIODevice
+{
+public:
+    explicit RingDevice(AudioOutput *output) : m_output(output) {}
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        // 只按整帧读取，保证声道不会错位
+        const int frameBytes = m_output->bytesPerFrame();
+        const qint64 size = maxSize - maxSize % frameBytes;
+        if (size <= 0)
+        {
+            return 0;
+        }
+        const size_t got = m_output->m_ring->read(reinterpret_cast<uint8_t *>(data), static_cast<size_t>(size));
+        if (static_cast<qint64>(got) < size)
+        {
+            // 数据不足时补静音，声卡保持运行；开始出声之后的每次连续欠载记一次
+            std::memset(data + got, 0, static_cast<size_t>(size) - got);
+            if (m_playing && !m_starved)
+            {
+                m_output->m_underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_starved = true;
+            if (m_playing)
+            {
+                m_output->m_silenceBytes.fetch_add(static_cast<quint64>(size) - got, std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            m_starved = false;
+        }
+        m_playing = m_playing || got > 0;
+        m_output->m_playedBytes.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+        return size;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    AudioOutput *m_output;
+    bool m_playing = false;     // 是否已经播放过真实数据
+    bool m_starved = false;     // 当前是否处于欠载状态
+};
+
+AudioOutput::AudioOutput(int deviceBufferMs, int ringMs, QObject *parent)
+    : QObject(parent), m_deviceBufferMs(deviceBufferMs), m_ringMs(ringMs)
+{
+}
+
+AudioOutput::~AudioOutput()
+{
+    stop();
+}
+
+bool AudioOutput::start(QString *error)
+{
+    if (m_context)
+    {
+        return true;
+    }
+    const QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    if (device.isNull())
+    {
+        *error = "No audio output device";
+        return false;
+    }
+
+    // 采样率和声道数沿用设备的首选值，避免声卡驱动或混音器再做一次转换
+    QAudioFormat format = device.preferredFormat();
+    format.setCodec("audio/pcm");
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::LittleEndian);
+    if (!device.isFormatSupported(format))
+    {
+        format = device.nearestFormat(format);
+    }
+    if (format.sampleSize() != 16 || format.sampleType() != QAudioFormat::SignedInt ||
+        format.byteOrder() != QAudioFormat::LittleEndian || format.channelCount() <= 0)
+    {
+        *error = "Audio device does not support 16-bit PCM";
+        return false;
+    }
+    m_sampleRate = format.sampleRate();
+    m_channels = format.channelCount();
+
+    const int bytesPerSecond = m_sampleRate * bytesPerFrame();
+    m_ring.reset(new ByteRing(static_cast<size_t>(static_cast<qint64>(bytesPerSecond) * m_ringMs / 1000)));
+
+    // 拉取回调依赖所在线程的事件循环，放在专用线程中，不受界面线程繁忙的影响
+    m_thread.setObjectName("AudioOutput");
+    m_thread.start(QThread::TimeCriticalPriority);
+    m_context = new QObject;
+    m_context->moveToThread(&m_thread);
+    bool ok = false;
+    QMetaObject::invokeMethod(m_context, [&]() { ok = openDevice(device, format, error); },
+                              Qt::BlockingQueuedConnection);
+    if (!ok)
+    {
+        stop();
+        return false;
+    }
+    qInfo().noquote() << QString("[Audio] %1: %2 Hz, %3 ch, device buffer %4 ms")
+                             .arg(device.deviceName())
+                             .arg(m_sampleRate)
+                             .arg(m_channels)
+                             .arg(bytesToUs(m_deviceBufferBytes.load(std::memory_order_relaxed)) / 1000.0, 0, 'f', 1);
+    return true;
+}
+
+bool AudioOutput::openDevice(const QAudioDeviceInfo &device, const QAudioFormat &format, QString *error)
+{
+    const int bytesPerSecond = m_sampleRate * bytesPerFrame();
+    m_device = new RingDevice(this);
+    m_device->open(QIODevice::ReadOnly);
+
+    m_audio = new QAudioOutput(device, format);
+    m_audio->setBufferSize(bytesPerSecond * m_deviceBufferMs / 1000 / bytesPerFrame() * bytesPerFrame());
+    m_audio->start(m_device);
+    if (m_audio->error() != QAudio::NoError)
+    {
+        *error = QString("Failed to start audio output (error %1)").arg(m_audio->error());
+        closeDevice();
+        return false;
+    }
+    // 设备可能不接受请求的缓冲大小，以实际值为准
+    m_deviceBufferBytes.store(m_audio->bufferSize(), std::memory_order_relaxed);
+    return true;
+}
+
+void AudioOutput::stop()
+{
+    if (!m_context)
+    {
+        return;
+    }
+    QMetaObject::invokeMethod(m_context, [this]() { closeDevice(); }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+    m_context = nullptr;
+}
+
+void AudioOutput::closeDevice()
+{
+    if (m_audio)
+    {
+        m_audio->stop();
+        delete m_audio;
+        m_audio = nullptr;
+    }
+    delete m_device;
+    m_device = nullptr;
+}
+
+qint64 AudioOutput::bytesToUs(qint64 bytes) const
+{
+    const qint64 bytesPerSecond = static_cast<qint64>(m_sampleRate) * bytesPerFrame();
+    return bytesPerSecond > 0 ? bytes * 1000000 / bytesPerSecond : 0;
+}
+
+qint64 AudioOutput::latencyUs() const
+{
+    const size_t buffered = m_ring ? m_ring->available() : 0;
+    return bytesToUs(static_cast<qint64>(buffered) + m_deviceBufferBytes.load(std::memory_order_relaxed));
+}
+
+AudioOutput::Stats AudioOutput::stats() const
+{
+    Stats s;
+    s.sampleRate = m_sampleRate;
+    s.channels = m_channels;
+    if (m_ring)
+    {
+        const ByteRing::Stats ring = m_ring->stats();
+        s.bufferedMs = bytesToUs(static_cast<qint64>(ring.fill)) / 1000.0;
+        s.maxBufferedMs = bytesToUs(static_cast<qint64>(ring.maxFill)) / 1000.0;
+    }
+    s.deviceBufferMs = bytesToUs(m_deviceBufferBytes.load(std::memory_order_relaxed)) / 1000.0;
+    s.latencyMs = s.bufferedMs + s.deviceBufferMs;
+    s.underruns = m_underruns.load(std::memory_order_relaxed);
+    s.silenceMs = bytesToUs(static_cast<qint64>(m_silenceBytes.load(std::memory_order_relaxed))) / 1000.0;
+    s.playedMs = bytesToUs(static_cast<qint64>(m_playedBytes.load(std::memory_order_relaxed))) / 1000.0;
+    return s;
+}
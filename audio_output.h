@@ -0,0 +1,105 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include "byte_ring.h"
+
+class QAudioDeviceInfo;
+class QAudioFormat;
+class QAudioOutput;
+class QIODevice;
+
+/**
+ * @brief 音频输出：无锁环形缓冲 -> 声卡
+ *
+ * 解码线程把重采样后的 PCM（有符号 16 位交错）写入 ByteRing，
+ * QAudioOutput 以拉取模式从内部的 QIODevice 读取。读取回调只访问无锁环形缓冲，
+ * 不与解码线程争锁；缓冲中数据不足时补静音并记一次欠载，声卡不会因此停止。
+ * QAudioOutput 及其设备运行在专用线程的事件循环中，界面线程卡顿（布局、绘制）不会耽误拉取。
+ * 格式在 start() 之后确定，之后不再改变。
+ */
+class AudioOutput : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief 音频输出统计信息
+     */
+    struct Stats
+    {
+        int sampleRate = 0;         // 声卡采样率
+        int channels = 0;           // 声卡声道数
+        double bufferedMs = 0;      // 环形缓冲中待播放的时长
+        double maxBufferedMs = 0;   // 环形缓冲历史最大时长
+        double deviceBufferMs = 0;  // 声卡缓冲时长
+        double latencyMs = 0;       // 写入环形缓冲到播放的总延迟（估计值）
+        quint64 underruns = 0;      // 欠载次数（同一次连续欠载只记一次）
+        double silenceMs = 0;       // 因欠载补入的静音时长
+        double playedMs = 0;        // 已交给声卡的时长（含静音）
+    };
+
+    /**
+     * @param deviceBufferMs 声卡缓冲时长，越小延迟越低但越容易欠载
+     * @param ringMs 环形缓冲容量（时长）
+     */
+    AudioOutput(int deviceBufferMs, int ringMs, QObject *parent = nullptr);
+    ~AudioOutput() override;
+
+    /**
+     * @brief 打开默认输出设备，在专用线程中开始拉取（不可在音频线程中调用）
+     * @return 没有可用设备或不支持 16 位 PCM 时返回 false
+     */
+    bool start(QString *error);
+    void stop();
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    int bytesPerFrame() const { return m_channels * 2; }
+
+    /**
+     * @brief 解码线程写入 PCM 的环形缓冲（start() 成功后有效）
+     */
+    ByteRing &ring() { return *m_ring; }
+
+    /**
+     * @brief 现在写入的样本到播放出来的延迟（环形缓冲 + 声卡缓冲），可在任意线程调用
+     *
+     * 拉取模式下声卡缓冲基本保持满，按其容量估计。
+     */
+    qint64 latencyUs() const;
+
+    /**
+     * @brief 欠载次数，可在任意线程调用（解码端据此重新对齐）
+     */
+    quint64 underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+
+    Stats stats() const;
+
+private:
+    class RingDevice;
+
+    qint64 bytesToUs(qint64 bytes) const;
+    bool openDevice(const QAudioDeviceInfo &device, const QAudioFormat &format, QString *error);
+    void closeDevice();
+
+    const int m_deviceBufferMs;
+    const int m_ringMs;
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    std::unique_ptr<ByteRing> m_ring;
+    QThread m_thread;                   // 声卡拉取线程
+    QObject *m_context = nullptr;       // 驻留在拉取线程，用于把调用投递过去
+    QAudioOutput *m_audio = nullptr;    // 仅限拉取线程
+    RingDevice *m_device = nullptr;     // 仅限拉取线程
+
+    std::atomic<int> m_deviceBufferBytes{0};
+    std::atomic<quint64> m_underruns{0};
+    std::atomic<quint64> m_silenceBytes{0};
+    std::atomic<quint64> m_playedBytes{0};
+};
+
+#endif // AUDIOOUTPUT_H
@@ -0,0 +1,92 @@
+#include "alloc_counter.h"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+namespace
+{
+// 常量初始化，早于任何静态构造函数中的分配
+std::atomic<quint64> g_allocations{0};
+
+inline void countAllocation()
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+#ifdef __GLIBC__
+extern "C"
+{
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size)
+{
+    // av_malloc 走这里
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    void *ptr = __libc_memalign(alignment, size);
+    if (!ptr && size)
+    {
+        return ENOMEM;
+    }
+    countAllocation();
+    *out = ptr;
+    return 0;
+}
+}
+#endif
+
+quint64 allocationCount()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+bool allocationCountingAvailable()
+{
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
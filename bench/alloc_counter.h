@@ -0,0 +1,15 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief 进程内堆分配次数（malloc / calloc / realloc / memalign 系列）
+ *
+ * 在 glibc 上通过在可执行文件中重新定义 malloc 系列函数并转发给 __libc_malloc 等实现，
+ * FFmpeg、Qt 等动态库中的分配同样被计入。其他平台不计数。
+ */
+quint64 allocationCount();
+bool allocationCountingAvailable();
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,85 @@
+# 无界面的解码性能测试程序，与主程序共用解码相关源码
+# 通过 pkg-config 查找 FFmpeg，可在普通 Linux 主机上直接编译运行：
+#   qmake bench.pro && make && ./player_bench profiles clip.mp4
+#   ./player_bench convert > kernels.json
+#   ./player_bench decode --pattern 1920x1080 --realtime > result.json
+#   ./player_bench transport --loss 2 > transports.json
+#   ./player_bench keyframe --gop 10 > keyframe.json
+#   ./player_bench stop > stop.json
+
+QT       = core gui multimedia network
+CONFIG  += c++17 console link_pkgconfig
+CONFIG  -= app_bundle
+
+TARGET = player_bench
+
+PKGCONFIG += libavformat libavcodec libavutil libswscale libswresample
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../audio_decoder.cpp \
+    ../audio_output.cpp \
+    ../byte_ring.cpp \
+    ../catch_up_controller.cpp \
+    ../convert_worker_pool.cpp \
+    ../decoder_profile.cpp \
+    ../frame_mailbox.cpp \
+    ../frame_pool.cpp \
+    ../frame_presenter.cpp \
+    ../input_source.cpp \
+    ../latency_tracer.cpp \
+    ../packet_muxer.cpp \
+    ../packet_queue.cpp \
+    ../snapshot_capture.cpp \
+    ../stream_probe_cache.cpp \
+    ../stream_transport.cpp \
+    ../sws_context_cache.cpp \
+    ../video_decoder.cpp \
+    ../yuv_convert.cpp \
+    alloc_counter.cpp \
+    bench_util.cpp \
+    convert_bench.cpp \
+    decode_bench.cpp \
+    keyframe_bench.cpp \
+    lossy_relay.cpp \
+    main.cpp \
+    profile_bench.cpp \
+    stop_bench.cpp \
+    test_pattern.cpp \
+    trace_file.cpp \
+    transport_bench.cpp
+
+HEADERS += \
+    ../audio_decoder.h \
+    ../audio_output.h \
+    ../byte_ring.h \
+    ../catch_up_controller.h \
+    ../config.h \
+    ../convert_worker_pool.h \
+    ../decoder_profile.h \
+    ../frame_mailbox.h \
+    ../frame_pool.h \
+    ../frame_presenter.h \
+    ../input_source.h \
+    ../latency_tracer.h \
+    ../packet_muxer.h \
+    ../packet_queue.h \
+    ../packet_sink.h \
+    ../snapshot_capture.h \
+    ../stream_probe_cache.h \
+    ../stream_transport.h \
+    ../sws_context_cache.h \
+    ../video_decoder.h \
+    ../yuv_convert.h \
+    alloc_counter.h \
+    bench_util.h \
+    convert_bench.h \
+    decode_bench.h \
+    keyframe_bench.h \
+    lossy_relay.h \
+    profile_bench.h \
+    stop_bench.h \
+    test_pattern.h \
+    trace_file.h \
+    transport_bench.h
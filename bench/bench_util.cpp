@@ -0,0 +1,25 @@
+#include "bench_util.h"
+#include <QStringList>
+#include <algorithm>
+
+bool parseSize(const QString &text, QSize *size)
+{
+    const QStringList parts = text.split('x');
+    if (parts.size() != 2 || parts[0].toInt() <= 0 || parts[1].toInt() <= 0)
+    {
+        return false;
+    }
+    *size = QSize(parts[0].toInt(), parts[1].toInt());
+    return true;
+}
+
+double percentile(std::vector<double> &values, double p)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[qMin(index, values.size() - 1)];
+}
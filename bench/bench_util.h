@@ -0,0 +1,18 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <QSize>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief 解析 "宽x高" 形式的尺寸参数，格式不对或宽高不为正时返回 false
+ */
+bool parseSize(const QString &text, QSize *size);
+
+/**
+ * @brief 取第 p 分位数（p 取 0~1，按最近秩），为空时返回 0；会就地排序 values
+ */
+double percentile(std::vector<double> &values, double p);
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,379 @@
+#include "convert_bench.h"
+#include "bench_util.h"
+#include "yuv_convert.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+extern "C"
+{
+#include <libavutil/time.h>
+#include <libswscale/swscale.h>
+}
+
+namespace
+{
+// 与 sws_scale 比较的固定阈值：偶数尺寸要求完全一致；奇数尺寸时 sws 对奇数行取下一行色度，
+// 配合缓变色度误差不超过 5
+const int kMaxAbsDiff = 6;          // 仅用于宽或高为奇数的尺寸
+const double kMinPsnrDb = 45.0;
+const double kPsnrCap = 99.0;       // 完全一致时的 PSNR（JSON 不能表示无穷大）
+
+struct Options
+{
+    std::vector<QSize> sizes{QSize(1920, 1080), QSize(1279, 719), QSize(641, 361), QSize(33, 17)};
+    QSize timingSize{1920, 1080};
+    int iterations = 200;
+};
+
+struct InputFormat
+{
+    const char *name;
+    AVPixelFormat format;
+    AVColorSpace colorspace;
+};
+
+const InputFormat kFormats[] = {
+    {"yuv420p-bt601", AV_PIX_FMT_YUV420P, AVCOL_SPC_UNSPECIFIED},
+    {"yuv420p-bt709", AV_PIX_FMT_YUV420P, AVCOL_SPC_BT709},
+    {"yuvj420p", AV_PIX_FMT_YUVJ420P, AVCOL_SPC_UNSPECIFIED},
+    {"nv12", AV_PIX_FMT_NV12, AVCOL_SPC_UNSPECIFIED},
+};
+
+bool parseOptions(const QStringList &args, Options *o)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--sizes" && hasValue)
+        {
+            o->sizes.clear();
+            for (const QString &text : args[++i].split(','))
+            {
+                QSize size;
+                if (!parseSize(text, &size))
+                {
+                    return false;
+                }
+                o->sizes.push_back(size);
+            }
+        }
+        else if (arg == "--timing-size" && hasValue)
+        {
+            if (!parseSize(args[++i], &o->timingSize))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--iterations" && hasValue)
+        {
+            o->iterations = qMax(1, args[++i].toInt());
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 色度用斜率为 1 的三角波：相邻色度样本只差 1，两边取样位置不同带来的误差不超过舍入误差量级
+int triangle(int t)
+{
+    const int period = 448;
+    const int phase = ((t % period) + period) % period;
+    return 16 + qAbs(phase - period / 2);
+}
+
+/**
+ * @brief 生成测试帧：亮度为随机噪声（覆盖饱和截断），色度为缓变的三角波
+ *
+ * 有限范围输入的亮度限制在标称范围 [16, 235] 内：超出时 sws_scale 的 BT.709 路径会溢出回绕，无法作为参考。
+ */
+AVFrame *makeFrame(const InputFormat &input, const QSize &size, quint32 seed)
+{
+    AVFrame *frame = av_frame_alloc();
+    frame->format = input.format;
+    frame->width = size.width();
+    frame->height = size.height();
+    frame->colorspace = input.colorspace;
+    frame->color_range = input.format == AV_PIX_FMT_YUVJ420P ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
+    if (av_frame_get_buffer(frame, 0) < 0)
+    {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+
+    std::mt19937 rng(seed);
+    const bool fullRange = frame->color_range == AVCOL_RANGE_JPEG;
+    std::uniform_int_distribution<int> luma(fullRange ? 0 : 16, fullRange ? 255 : 235);
+    for (int y = 0; y < frame->height; y++)
+    {
+        uint8_t *row = frame->data[0] + static_cast<ptrdiff_t>(y) * frame->linesize[0];
+        for (int x = 0; x < frame->width; x++)
+        {
+            row[x] = static_cast<uint8_t>(luma(rng));
+        }
+    }
+    const int chromaWidth = (frame->width + 1) / 2;
+    const int chromaHeight = (frame->height + 1) / 2;
+    for (int y = 0; y < chromaHeight; y++)
+    {
+        for (int x = 0; x < chromaWidth; x++)
+        {
+            const uint8_t u = static_cast<uint8_t>(triangle(x + y + 16));
+            const uint8_t v = static_cast<uint8_t>(triangle(x - y + 300));
+            if (input.format == AV_PIX_FMT_NV12)
+            {
+                uint8_t *uv = frame->data[1] + static_cast<ptrdiff_t>(y) * frame->linesize[1] + x * 2;
+                uv[0] = u;
+                uv[1] = v;
+            }
+            else
+            {
+                frame->data[1][static_cast<ptrdiff_t>(y) * frame->linesize[1] + x] = u;
+                frame->data[2][static_cast<ptrdiff_t>(y) * frame->linesize[2] + x] = v;
+            }
+        }
+    }
+    return frame;
+}
+
+/**
+ * @brief 建立与 VideoDecoder 相同色彩空间设置的 sws 上下文（不缩放，仅颜色转换）
+ */
+SwsContext *createReference(const AVFrame *frame, int flags)
+{
+    SwsContext *ctx = sws_getContext(frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                     frame->width, frame->height, AV_PIX_FMT_RGB32, flags,
+                                     nullptr, nullptr, nullptr);
+    if (!ctx)
+    {
+        return nullptr;
+    }
+    const int colorspace = frame->colorspace == AVCOL_SPC_BT709 ? SWS_CS_ITU709 : SWS_CS_DEFAULT;
+    const int range = frame->color_range == AVCOL_RANGE_JPEG ? 1 : 0;
+    sws_setColorspaceDetails(ctx, sws_getCoefficients(colorspace), range,
+                             sws_getCoefficients(SWS_CS_DEFAULT), 1, 0, 1 << 16, 1 << 16);
+    return ctx;
+}
+
+void scaleReference(SwsContext *ctx, const AVFrame *frame, std::vector<uint8_t> *rgb)
+{
+    uint8_t *dst[4] = {rgb->data(), nullptr, nullptr, nullptr};
+    int dstStride[4] = {frame->width * 4, 0, 0, 0};
+    sws_scale(ctx, frame->data, frame->linesize, 0, frame->height, dst, dstStride);
+}
+
+struct Difference
+{
+    int maxAbs = 0;
+    double psnrDb = kPsnrCap;
+    qint64 differingBytes = 0;
+};
+
+// 只比较 B、G、R 三个通道，不比较填充字节
+Difference compare(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b)
+{
+    Difference d;
+    double squared = 0;
+    qint64 samples = 0;
+    for (size_t i = 0; i + 4 <= a.size(); i += 4)
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            const int diff = qAbs(static_cast<int>(a[i + c]) - static_cast<int>(b[i + c]));
+            d.maxAbs = qMax(d.maxAbs, diff);
+            d.differingBytes += diff ? 1 : 0;
+            squared += static_cast<double>(diff) * diff;
+            samples++;
+        }
+    }
+    if (samples && squared > 0)
+    {
+        d.psnrDb = qMin(kPsnrCap, 10.0 * std::log10(255.0 * 255.0 * samples / squared));
+    }
+    return d;
+}
+
+std::vector<YuvConverter::Kernel> availableKernels()
+{
+    std::vector<YuvConverter::Kernel> kernels;
+    const YuvConverter::Kernel all[] = {YuvConverter::KernelScalar, YuvConverter::KernelSse2,
+                                        YuvConverter::KernelAvx2, YuvConverter::KernelNeon};
+    for (YuvConverter::Kernel kernel : all)
+    {
+        if (YuvConverter::kernelAvailable(kernel))
+        {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+/**
+ * @brief 校验一种输入格式和尺寸：每个内核对比 sws_scale，向量内核另对比标量内核
+ */
+QJsonArray checkCase(const InputFormat &input, const QSize &size, bool *ok)
+{
+    QJsonArray results;
+    AVFrame *frame = makeFrame(input, size, static_cast<quint32>(size.width() * 31 + size.height()));
+    // 最近邻取色度并逐像素精确计算，与 YuvConverter 的定点运算一致
+    SwsContext *ctx = frame ? createReference(frame, SWS_POINT | SWS_ACCURATE_RND | SWS_FULL_CHR_H_INT) : nullptr;
+    if (!ctx)
+    {
+        QJsonObject result;
+        result["format"] = input.name;
+        result["width"] = size.width();
+        result["height"] = size.height();
+        result["error"] = "cannot create frame or sws context";
+        results.append(result);
+        av_frame_free(&frame);
+        *ok = false;
+        return results;
+    }
+
+    const size_t bytes = static_cast<size_t>(size.width()) * size.height() * 4;
+    std::vector<uint8_t> reference(bytes, 0);
+    scaleReference(ctx, frame, &reference);
+    sws_freeContext(ctx);
+
+    std::vector<uint8_t> scalar(bytes, 0);
+    YuvConverter converter;
+    converter.setKernel(YuvConverter::KernelScalar);
+    converter.convert(frame, scalar.data(), size.width() * 4, 0, size.height());
+
+    for (YuvConverter::Kernel kernel : availableKernels())
+    {
+        // 先填入非零字节，漏写的像素也会体现为误差
+        std::vector<uint8_t> output(bytes, 0x5A);
+        converter.setKernel(kernel);
+        converter.convert(frame, output.data(), size.width() * 4, 0, size.height());
+
+        const Difference vsSws = compare(output, reference);
+        const Difference vsScalar = compare(output, scalar);
+        const int maxAbsLimit = (size.width() % 2 || size.height() % 2) ? kMaxAbsDiff : 0;
+        const bool pass = vsSws.maxAbs <= maxAbsLimit && vsSws.psnrDb >= kMinPsnrDb && vsScalar.differingBytes == 0;
+        *ok = *ok && pass;
+
+        QJsonObject result;
+        result["format"] = input.name;
+        result["width"] = size.width();
+        result["height"] = size.height();
+        result["kernel"] = QString::fromLatin1(YuvConverter::kernelName(kernel));
+        result["max_abs_diff"] = vsSws.maxAbs;
+        result["max_abs_diff_limit"] = maxAbsLimit;
+        result["psnr_db"] = vsSws.psnrDb;
+        result["bytes_differing_from_scalar"] = vsScalar.differingBytes;
+        result["pass"] = pass;
+        results.append(result);
+        if (!pass)
+        {
+            fprintf(stderr, "convert: %s %dx%d %s FAILED (max diff %d, PSNR %.2f dB, %lld bytes differ from scalar)\n",
+                    input.name, size.width(), size.height(), YuvConverter::kernelName(kernel), vsSws.maxAbs,
+                    vsSws.psnrDb, static_cast<long long>(vsScalar.differingBytes));
+        }
+    }
+    av_frame_free(&frame);
+    return results;
+}
+
+double nsPerPixel(qint64 elapsedUs, const QSize &size, int iterations)
+{
+    return elapsedUs * 1000.0 / (static_cast<double>(size.width()) * size.height() * iterations);
+}
+
+/**
+ * @brief 单线程反复转换同一帧，给出每个内核与 sws_scale（VideoDecoder 使用的参数）的每像素耗时
+ */
+QJsonArray timeKernels(const Options &o)
+{
+    QJsonArray timings;
+    AVFrame *frame = makeFrame(kFormats[0], o.timingSize, 1);
+    if (!frame)
+    {
+        return timings;
+    }
+    const size_t bytes = static_cast<size_t>(o.timingSize.width()) * o.timingSize.height() * 4;
+    std::vector<uint8_t> output(bytes, 0);
+
+    YuvConverter converter;
+    for (YuvConverter::Kernel kernel : availableKernels())
+    {
+        converter.setKernel(kernel);
+        converter.convert(frame, output.data(), frame->width * 4, 0, frame->height);    // 预热缓存
+        const qint64 beginUs = av_gettime_relative();
+        for (int i = 0; i < o.iterations; i++)
+        {
+            converter.convert(frame, output.data(), frame->width * 4, 0, frame->height);
+        }
+        QJsonObject timing;
+        timing["kernel"] = QString::fromLatin1(YuvConverter::kernelName(kernel));
+        timing["ns_per_pixel"] = nsPerPixel(av_gettime_relative() - beginUs, o.timingSize, o.iterations);
+        timings.append(timing);
+    }
+
+    if (SwsContext *ctx = createReference(frame, SWS_FAST_BILINEAR))
+    {
+        scaleReference(ctx, frame, &output);
+        const qint64 beginUs = av_gettime_relative();
+        for (int i = 0; i < o.iterations; i++)
+        {
+            scaleReference(ctx, frame, &output);
+        }
+        QJsonObject timing;
+        timing["kernel"] = "sws_scale";
+        timing["ns_per_pixel"] = nsPerPixel(av_gettime_relative() - beginUs, o.timingSize, o.iterations);
+        timings.append(timing);
+        sws_freeContext(ctx);
+    }
+    av_frame_free(&frame);
+    return timings;
+}
+}
+
+int runConvertBench(const QStringList &args)
+{
+    Options options;
+    if (!parseOptions(args, &options))
+    {
+        fprintf(stderr, "convert: invalid arguments\n");
+        return 2;
+    }
+
+    QJsonArray kernels;
+    for (YuvConverter::Kernel kernel : availableKernels())
+    {
+        kernels.append(QString::fromLatin1(YuvConverter::kernelName(kernel)));
+    }
+
+    bool ok = true;
+    QJsonArray cases;
+    for (const InputFormat &input : kFormats)
+    {
+        for (const QSize &size : options.sizes)
+        {
+            for (const QJsonValue &result : checkCase(input, size, &ok))
+            {
+                cases.append(result);
+            }
+        }
+    }
+
+    QJsonObject report;
+    report["kernels"] = kernels;
+    report["odd_size_max_abs_diff_limit"] = kMaxAbsDiff;
+    report["min_psnr_db"] = kMinPsnrDb;
+    report["cases"] = cases;
+    report["timing_width"] = options.timingSize.width();
+    report["timing_height"] = options.timingSize.height();
+    report["timing_iterations"] = options.iterations;
+    report["timings"] = timeKernels(options);
+    report["pass"] = ok;
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#ifndef CONVERTBENCH_H
+#define CONVERTBENCH_H
+
+#include <QStringList>
+
+/**
+ * @brief 校验并测速 YuvConverter 的各个内核
+ *
+ * 对每种 4:2:0 输入（YUV420P BT.601 / BT.709、YUVJ420P、NV12）和每个尺寸（含奇数宽高），
+ * 用当前 CPU 可用的每个内核（标量、SSE2、AVX2、NEON）转换整帧，与 sws_scale 的结果比较，
+ * 给出最大绝对误差和 PSNR：偶数尺寸须完全一致，奇数尺寸超过固定阈值即判为失败；向量内核还须与标量内核逐字节一致。
+ * 之后在测速尺寸上单线程反复转换，给出每个内核和 sws_scale 的每像素耗时。
+ * 结果以 JSON 输出到标准输出，有任一用例失败时返回非零。
+ */
+int runConvertBench(const QStringList &args);
+
+#endif // CONVERTBENCH_H
@@ -0,0 +1,294 @@
+#include "decode_bench.h"
+#include "alloc_counter.h"
+#include "bench_util.h"
+#include "test_pattern.h"
+#include "trace_file.h"
+#include "video_decoder.h"
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <cstdio>
+#include <sys/resource.h>
+
+namespace
+{
+struct Options
+{
+    QString input;              // 本地文件；为空时使用合成图案
+    QString trace;              // 抓包文件，经字节环形缓冲输入（不经过网络和文件协议层）
+    QSize patternSize{1920, 1080};
+    int patternFps = 25;
+    int patternSeconds = 20;
+    bool realtime = false;
+    QSize outputSize;           // 模拟的显示尺寸，无效时按原始尺寸输出
+    QString profile;
+    int threads = 0;
+    int warmupFrames = 25;      // 不计入分配统计的起始帧数（解码器、缓冲池初始化）
+};
+
+double cpuSeconds(const rusage &usage)
+{
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec +
+           usage.ru_stime.tv_usec / 1e6;
+}
+
+bool parseOptions(const QStringList &args, Options *o)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--realtime")
+        {
+            o->realtime = true;
+        }
+        else if (arg == "--pattern" && hasValue)
+        {
+            if (!parseSize(args[++i], &o->patternSize))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--fps" && hasValue)
+        {
+            o->patternFps = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--seconds" && hasValue)
+        {
+            o->patternSeconds = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--output" && hasValue)
+        {
+            if (!parseSize(args[++i], &o->outputSize))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--trace" && hasValue)
+        {
+            o->trace = args[++i];
+        }
+        else if (arg == "--profile" && hasValue)
+        {
+            o->profile = args[++i];
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            o->threads = args[++i].toInt();
+        }
+        else if (arg.startsWith("--"))
+        {
+            return false;
+        }
+        else
+        {
+            o->input = arg;
+        }
+    }
+    return true;
+}
+
+QJsonObject summaryJson(const LatencyTracer::Summary &s)
+{
+    QJsonObject obj;
+    obj["count"] = static_cast<qint64>(s.count);
+    obj["mean_ms"] = s.mean;
+    obj["p50_ms"] = s.p50;
+    obj["p95_ms"] = s.p95;
+    obj["p99_ms"] = s.p99;
+    obj["max_ms"] = s.max;
+    return obj;
+}
+}
+
+int runDecodeBench(const QStringList &args)
+{
+    Options options;
+    if (!parseOptions(args, &options))
+    {
+        fprintf(stderr, "decode: invalid arguments\n");
+        return 2;
+    }
+
+    // 未指定文件时先生成合成图案
+    QString input = options.input;
+    QString patternCodec;
+    if (!options.trace.isEmpty())
+    {
+        input = "trace:" + options.trace;
+    }
+    else if (input.isEmpty())
+    {
+        input = QDir::temp().filePath(QString("player_bench_pattern_%1x%2_%3fps_%4s.mkv")
+                                          .arg(options.patternSize.width())
+                                          .arg(options.patternSize.height())
+                                          .arg(options.patternFps)
+                                          .arg(options.patternSeconds));
+        QString error;
+        if (!writeTestPattern(input, options.patternSize.width(), options.patternSize.height(), options.patternFps,
+                              options.patternSeconds, 2, &patternCodec, &error))
+        {
+            fprintf(stderr, "decode: cannot generate test pattern: %s\n", qPrintable(error));
+            return 1;
+        }
+    }
+
+    AppConfig config;
+    VideoDecoder decoder(config, input);
+    decoder.setReconnectEnabled(false);
+
+    // 抓包回放：回放线程按记录时间写入环形缓冲，解码器经自定义 AVIOContext 读取
+    std::unique_ptr<TraceReplayer> replayer;
+    if (!options.trace.isEmpty())
+    {
+        auto ring = std::make_shared<ByteRing>(4 * 1024 * 1024);
+        replayer = std::make_unique<TraceReplayer>(options.trace, ring, options.realtime);
+        QString error;
+        if (!replayer->open(&error))
+        {
+            fprintf(stderr, "decode: cannot open trace: %s\n", qPrintable(error));
+            return 1;
+        }
+        decoder.setInputSource(std::make_shared<RingInputSource>(ring, replayer->format()));
+    }
+    else
+    {
+        decoder.setReadPacing(options.realtime);
+    }
+    if (!options.profile.isEmpty())
+    {
+        DecoderProfile::Profile profile;
+        if (!DecoderProfile::fromName(options.profile, &profile))
+        {
+            fprintf(stderr, "decode: unknown profile %s\n", qPrintable(options.profile));
+            return 2;
+        }
+        decoder.setDecoderProfile(profile);
+    }
+    decoder.setDecoderThreads(options.threads);
+
+    QString decodeError;
+    QObject::connect(&decoder, &VideoDecoder::errorOccurred, &decoder,
+                     [&decodeError](const QString &message) { decodeError = message; }, Qt::DirectConnection);
+
+    // 本线程充当显示端：有新帧时取走并记录显示阶段
+    auto mailbox = std::make_shared<FrameMailbox>();
+    mailbox->setTargetSize(options.outputSize);
+    QMutex mutex;
+    QWaitCondition frameReady;
+    mailbox->setNotifier([&]()
+                         {
+                             QMutexLocker locker(&mutex);
+                             frameReady.wakeOne();
+                         });
+    decoder.setFrameMailbox(mailbox);
+    std::shared_ptr<LatencyTracer> tracer = decoder.latencyTracer();
+
+    rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    const qint64 startUs = LatencyTracer::nowUs();
+    quint64 displayed = 0;
+    quint64 allocStart = 0;
+    quint64 allocStartFrames = 0;
+    decoder.start();
+    if (replayer)
+    {
+        replayer->start();
+    }
+    while (!decoder.isFinished() || mailbox->hasNewFrame())
+    {
+        {
+            QMutexLocker locker(&mutex);
+            if (!mailbox->hasNewFrame())
+            {
+                frameReady.wait(&mutex, 20);
+            }
+        }
+        if (!mailbox->hasNewFrame())
+        {
+            continue;
+        }
+        mailbox->latest();
+        FrameTiming timing = mailbox->latestTiming();
+        timing.paintedUs = LatencyTracer::nowUs();
+        tracer->recordDisplayStages(timing);
+        displayed++;
+        if (!allocStartFrames && decoder.stats().framesDecoded >= static_cast<quint64>(options.warmupFrames))
+        {
+            allocStart = allocationCount();
+            allocStartFrames = decoder.stats().framesDecoded;
+        }
+    }
+    decoder.wait();
+    if (replayer)
+    {
+        replayer->stop();
+    }
+    const double wallSeconds = (LatencyTracer::nowUs() - startUs) / 1e6;
+    const quint64 allocEnd = allocationCount();
+    rusage usageAfter;
+    getrusage(RUSAGE_SELF, &usageAfter);
+
+    const VideoDecoder::Stats s = decoder.stats();
+    const PacketQueue::Stats q = decoder.packetQueueStats();
+    const quint64 steadyFrames = s.framesDecoded > allocStartFrames ? s.framesDecoded - allocStartFrames : 0;
+
+    QJsonObject result;
+    result["input"] = input;
+    if (!patternCodec.isEmpty())
+    {
+        result["pattern_codec"] = patternCodec;
+    }
+    result["realtime"] = options.realtime;
+    result["error"] = decodeError;
+    result["decoder_profile"] = QString::fromLatin1(s.decoderProfile);
+    result["decoder_threads"] = s.decoderThreads;
+    result["decoder_thread_type"] = QString::fromLatin1(s.decoderThreadType);
+    result["convert_kernel"] = QString::fromLatin1(s.simdKernel);
+    result["convert_threads"] = s.convertThreads;
+    result["output_width"] = s.outputSize.width();
+    result["output_height"] = s.outputSize.height();
+    result["wall_seconds"] = wallSeconds;
+    result["frames_decoded"] = static_cast<qint64>(s.framesDecoded);
+    result["frames_converted"] = static_cast<qint64>(s.framesConverted);
+    result["frames_displayed"] = static_cast<qint64>(displayed);
+    result["decode_fps"] = wallSeconds > 0 ? s.framesDecoded / wallSeconds : 0;
+    result["packets_dropped"] = static_cast<qint64>(q.dropped);
+    result["sws_cache_misses"] = static_cast<qint64>(s.swsRebuilds);
+    result["sws_cache_hits"] = static_cast<qint64>(s.swsCacheHits);
+    result["reconfigurations"] = static_cast<qint64>(s.reconfigurations);
+    result["max_reconfig_ms"] = s.maxReconfigMs;
+    result["time_to_first_frame_ms"] = s.timeToFirstFrameMs;
+    result["input_source"] = QString::fromLatin1(s.inputSource);
+    result["demux_us_per_packet"] = s.avgDemuxUs;
+    result["input_wait_ms"] = s.inputWaitMs;
+    if (replayer)
+    {
+        result["trace_bytes"] = static_cast<qint64>(replayer->bytesReplayed());
+        result["trace_max_late_ms"] = replayer->maxLateMs();
+    }
+    result["cpu_seconds"] = cpuSeconds(usageAfter) - cpuSeconds(usageBefore);
+    result["cpu_percent"] = wallSeconds > 0 ? 100.0 * (cpuSeconds(usageAfter) - cpuSeconds(usageBefore)) / wallSeconds : 0;
+    result["peak_rss_kb"] = static_cast<qint64>(usageAfter.ru_maxrss);
+    if (allocationCountingAvailable() && steadyFrames)
+    {
+        result["allocations_per_frame"] = static_cast<double>(allocEnd - allocStart) / steadyFrames;
+    }
+    else
+    {
+        result["allocations_per_frame"] = QJsonValue();
+    }
+
+    QJsonObject stages;
+    for (int i = 0; i < LatencyTracer::StageCount; i++)
+    {
+        const LatencyTracer::Stage stage = static_cast<LatencyTracer::Stage>(i);
+        stages[QString::fromLatin1(LatencyTracer::stageName(stage))] = summaryJson(tracer->summary(stage));
+    }
+    result["stages"] = stages;
+
+    printf("%s\n", QJsonDocument(result).toJson(QJsonDocument::Indented).constData());
+    return decodeError.isEmpty() && s.framesDecoded > 0 ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#ifndef DECODEBENCH_H
+#define DECODEBENCH_H
+
+#include <QStringList>
+
+/**
+ * @brief 用 VideoDecoder 完整的读取、解码、转换流程解码本地文件、抓包文件或合成测试图案
+ *
+ * 抓包文件经字节环形缓冲和自定义 AVIOContext 输入，可按原始到达节奏回放，
+ * 并单独统计解复用开销（不含套接字和等待数据的时间）。
+ *
+ * 由本程序充当显示端从帧信箱取帧，得到与实际运行一致的逐阶段延迟；
+ * 另外统计解码帧率、CPU 时间、峰值常驻内存和每帧堆分配次数，结果以 JSON 输出到标准输出。
+ */
+int runDecodeBench(const QStringList &args);
+
+#endif // DECODEBENCH_H
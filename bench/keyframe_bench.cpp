@@ -0,0 +1,325 @@
+#include "keyframe_bench.h"
+#include "bench_util.h"
+#include "stream_probe_cache.h"
+#include "test_pattern.h"
+#include "video_decoder.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <cstdio>
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+namespace
+{
+struct Options
+{
+    QSize patternSize{1280, 720};
+    int patternFps = 30;
+    int seconds = 30;
+    int gopSeconds = 10;        // 摄像头的固定关键帧间隔
+    int lossEverySeconds = 4;   // 每隔多久截断一个非关键帧
+    QStringList modes{"honor", "ignore"};
+};
+
+const char *const kStreamName = "keyframe-stand-in";
+
+bool parseOptions(const QStringList &args, Options *o)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--pattern" && hasValue)
+        {
+            if (!parseSize(args[++i], &o->patternSize))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--fps" && hasValue)
+        {
+            o->patternFps = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--seconds" && hasValue)
+        {
+            o->seconds = qMax(5, args[++i].toInt());
+        }
+        else if (arg == "--gop" && hasValue)
+        {
+            o->gopSeconds = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--loss-every" && hasValue)
+        {
+            o->lossEverySeconds = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--mode" && hasValue)
+        {
+            const QString mode = args[++i];
+            if (mode != "honor" && mode != "ignore")
+            {
+                return false;
+            }
+            o->modes = QStringList{mode};
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 替身摄像头：实时编码，定期截断一个非关键帧（丢掉后半部分的分片），按请求编码 IDR
+ */
+class StandInCamera
+{
+public:
+    StandInCamera(const Options &o, bool honorRequests, std::shared_ptr<ByteRing> ring)
+        : m_options(o), m_honor(honorRequests), m_ring(std::move(ring))
+    {
+    }
+
+    ~StandInCamera()
+    {
+        stop();
+    }
+
+    bool open(QString *error)
+    {
+        return m_encoder.open(m_options.patternSize.width(), m_options.patternSize.height(), m_options.patternFps,
+                              m_options.gopSeconds, error);
+    }
+
+    const char *codecName() const { return m_encoder.codecName(); }
+    const char *formatName() const { return m_encoder.rawFormatName(); }
+
+    void start()
+    {
+        m_running.store(true);
+        m_thread = std::thread(&StandInCamera::run, this);
+    }
+
+    void stop()
+    {
+        m_running.store(false);
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    /**
+     * @brief 收到关键帧请求（解码线程调用），响应模式下下一帧编码为 IDR
+     */
+    void requestKeyframe()
+    {
+        m_requests.fetch_add(1, std::memory_order_relaxed);
+        if (m_honor)
+        {
+            m_keyframePending.store(true);
+        }
+    }
+
+    quint64 requests() const { return m_requests.load(std::memory_order_relaxed); }
+    quint64 forcedKeyframes() const { return m_forcedKeyframes.load(std::memory_order_relaxed); }
+    quint64 losses() const { return m_losses.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief afterUs 之后第一次丢包的时间，没有时返回 0
+     */
+    qint64 firstLossAfter(qint64 afterUs)
+    {
+        QMutexLocker locker(&m_lossMutex);
+        for (qint64 lossUs : m_lossTimes)
+        {
+            if (lossUs > afterUs)
+            {
+                return lossUs;
+            }
+        }
+        return 0;
+    }
+
+private:
+    void run()
+    {
+        const qint64 frameUs = 1000000 / m_options.patternFps;
+        const qint64 lossEveryUs = static_cast<qint64>(m_options.lossEverySeconds) * 1000000;
+        const qint64 startUs = av_gettime_relative();
+        qint64 nextLossUs = startUs + qMin<qint64>(lossEveryUs, 2000000);
+        const int frameCount = m_options.patternFps * m_options.seconds;
+        for (int i = 0; i < frameCount && m_running.load(); i++)
+        {
+            const qint64 dueUs = startUs + i * frameUs;
+            for (qint64 waitUs = dueUs - av_gettime_relative(); waitUs > 0 && m_running.load();
+                 waitUs = dueUs - av_gettime_relative())
+            {
+                av_usleep(static_cast<unsigned>(qMin<qint64>(waitUs, 10000)));
+            }
+            const bool forceKeyframe = m_keyframePending.exchange(false);
+            if (forceKeyframe)
+            {
+                m_forcedKeyframes.fetch_add(1, std::memory_order_relaxed);
+            }
+            const bool ok = m_encoder.encode(i, forceKeyframe, [&](AVPacket *packet)
+                                             {
+                                                 size_t size = static_cast<size_t>(packet->size);
+                                                 const qint64 nowUs = av_gettime_relative();
+                                                 if (!(packet->flags & AV_PKT_FLAG_KEY) && nowUs >= nextLossUs)
+                                                 {
+                                                     // 丢掉后半帧：解码器对缺失的宏块做错误隐藏，之后的帧引用花屏画面
+                                                     size = qMax<size_t>(1, size / 2);
+                                                     nextLossUs += lossEveryUs;
+                                                     m_losses.fetch_add(1, std::memory_order_relaxed);
+                                                     QMutexLocker locker(&m_lossMutex);
+                                                     m_lossTimes.push_back(nowUs);
+                                                 }
+                                                 return write(packet->data, size);
+                                             });
+            if (!ok)
+            {
+                break;
+            }
+        }
+        m_ring->close();
+    }
+
+    bool write(const uint8_t *data, size_t size)
+    {
+        while (size > 0 && m_running.load())
+        {
+            if (!m_ring->waitForSpace(qMin(size, m_ring->stats().capacity), 100))
+            {
+                continue;
+            }
+            const size_t written = m_ring->write(data, size);
+            data += written;
+            size -= written;
+        }
+        return size == 0;
+    }
+
+    const Options m_options;
+    const bool m_honor;
+    const std::shared_ptr<ByteRing> m_ring;
+    PatternEncoder m_encoder;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_keyframePending{false};
+    std::atomic<quint64> m_requests{0};
+    std::atomic<quint64> m_forcedKeyframes{0};
+    std::atomic<quint64> m_losses{0};
+    QMutex m_lossMutex;
+    std::vector<qint64> m_lossTimes;    // 各次丢包的时间（单调时钟）
+};
+
+QJsonObject runMode(const Options &o, bool honor)
+{
+    QJsonObject result;
+    result["mode"] = honor ? "honor" : "ignore";
+
+    auto ring = std::make_shared<ByteRing>(8 * 1024 * 1024);
+    StandInCamera camera(o, honor, ring);
+    QString error;
+    if (!camera.open(&error))
+    {
+        result["error"] = error;
+        return result;
+    }
+    result["codec"] = QString::fromLatin1(camera.codecName());
+
+    StreamProbeCache::remove(kStreamName);
+    AppConfig config;
+    VideoDecoder decoder(config, kStreamName);
+    decoder.setInputSource(std::make_shared<RingInputSource>(ring, QString::fromLatin1(camera.formatName())));
+    decoder.setReconnectEnabled(false);
+    QString decodeError;
+    QObject::connect(&decoder, &VideoDecoder::errorOccurred, &decoder,
+                     [&decodeError](const QString &message) { decodeError = message; }, Qt::DirectConnection);
+    // 替身摄像头直接收到请求，代替 MQTT 往返
+    QObject::connect(&decoder, &VideoDecoder::keyframeRequested, &decoder,
+                     [&camera](const QString &) { camera.requestKeyframe(); }, Qt::DirectConnection);
+
+    decoder.start();
+    camera.start();
+
+    // 每次解码端恢复完好画面时，记录距上次恢复后第一次丢包的时间（含发现损坏的延迟；
+    // 忽略请求时一个 GOP 内可能丢包多次，从第一次算起）
+    std::vector<double> lossToClean;
+    quint64 recoveries = 0;
+    qint64 recoveredUs = 0;
+    while (!decoder.isFinished())
+    {
+        QThread::msleep(5);
+        const quint64 count = decoder.stats().recoveries;
+        if (count != recoveries)
+        {
+            recoveries = count;
+            const qint64 nowUs = av_gettime_relative();
+            const qint64 lossUs = camera.firstLossAfter(recoveredUs);
+            if (lossUs)
+            {
+                lossToClean.push_back((nowUs - lossUs) / 1000.0);
+            }
+            recoveredUs = nowUs;
+        }
+    }
+    camera.stop();
+
+    const VideoDecoder::Stats s = decoder.stats();
+    result["error"] = decodeError;
+    result["gop_seconds"] = o.gopSeconds;
+    result["losses_injected"] = static_cast<qint64>(camera.losses());
+    result["corruption_events"] = static_cast<qint64>(s.corruptionEvents);
+    result["corrupt_frames"] = static_cast<qint64>(s.corruptFrames);
+    result["decode_errors"] = static_cast<qint64>(s.decodeErrors);
+    result["keyframe_requests"] = static_cast<qint64>(s.keyframeRequests);
+    result["requests_received"] = static_cast<qint64>(camera.requests());
+    result["keyframes_forced"] = static_cast<qint64>(camera.forcedKeyframes());
+    result["recoveries"] = static_cast<qint64>(s.recoveries);
+    result["unrecovered"] = static_cast<qint64>(s.corruptionEvents - qMin(s.corruptionEvents, s.recoveries));
+    result["frozen_frames"] = static_cast<qint64>(s.frozenFrames);
+    result["detect_to_clean_avg_ms"] = s.avgRecoveryMs;
+    result["detect_to_clean_max_ms"] = s.maxRecoveryMs;
+    result["loss_to_clean_p50_ms"] = percentile(lossToClean, 0.5);
+    result["loss_to_clean_max_ms"] = lossToClean.empty() ? 0 : lossToClean.back();
+    return result;
+}
+}
+
+int runKeyframeBench(const QStringList &args)
+{
+    Options options;
+    if (!parseOptions(args, &options))
+    {
+        fprintf(stderr, "keyframe: invalid arguments\n");
+        return 2;
+    }
+
+    QJsonArray results;
+    bool ok = true;
+    for (const QString &mode : options.modes)
+    {
+        fprintf(stderr, "keyframe: %s requests\n", qPrintable(mode));
+        const QJsonObject result = runMode(options, mode == "honor");
+        ok = ok && result["error"].toString().isEmpty();
+        results.append(result);
+    }
+
+    QJsonObject report;
+    report["pattern_width"] = options.patternSize.width();
+    report["pattern_height"] = options.patternSize.height();
+    report["fps"] = options.patternFps;
+    report["seconds"] = options.seconds;
+    report["loss_every_seconds"] = options.lossEverySeconds;
+    report["results"] = results;
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return ok ? 0 : 1;
+}
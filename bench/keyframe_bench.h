@@ -0,0 +1,16 @@
+#ifndef KEYFRAMEBENCH_H
+#define KEYFRAMEBENCH_H
+
+#include <QStringList>
+
+/**
+ * @brief 测量丢包后恢复完好画面的时间：响应关键帧请求与等待下一个固定关键帧的对比
+ *
+ * 进程内的替身摄像头按实时速率逐帧编码测试图案（长 GOP），裸码流经字节环形缓冲交给 VideoDecoder，
+ * 并定期截断一个非关键帧模拟丢包。VideoDecoder 发现损坏后发出 keyframeRequested，
+ * 替身摄像头在“响应”模式下把下一帧编码为 IDR，在“忽略”模式下照常等到固定关键帧。
+ * 结果以 JSON 输出到标准输出。
+ */
+int runKeyframeBench(const QStringList &args);
+
+#endif // KEYFRAMEBENCH_H
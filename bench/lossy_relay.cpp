@@ -0,0 +1,263 @@
+#include "lossy_relay.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+namespace
+{
+constexpr size_t kSegmentBytes = 1400;      // 按以太网 MSS 折算 TCP 数据段中的报文数
+constexpr int kPollMs = 50;
+constexpr int kConnectRetryMs = 5000;       // 目标端口尚未监听时重试连接的时长
+
+sockaddr_in loopback(quint16 port)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+bool sendAll(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+}
+
+LossyRelay::LossyRelay(Protocol protocol, quint16 listenPort, quint16 targetPort, double lossPercent, int stallMs,
+                       int warmupMs, quint32 seed)
+    : m_protocol(protocol), m_listenPort(listenPort), m_targetPort(targetPort),
+      m_loss(qBound(0.0, lossPercent / 100.0, 1.0)), m_stallMs(qMax(0, stallMs)), m_warmupMs(qMax(0, warmupMs)),
+      m_seed(seed)
+{
+}
+
+LossyRelay::~LossyRelay()
+{
+    stop();
+}
+
+bool LossyRelay::start(QString *error)
+{
+    m_listenFd = socket(AF_INET, m_protocol == Tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (m_listenFd < 0)
+    {
+        *error = QString("relay socket: %1").arg(strerror(errno));
+        return false;
+    }
+    const int reuse = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    const sockaddr_in addr = loopback(m_listenPort);
+    if (bind(m_listenFd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        (m_protocol == Tcp && listen(m_listenFd, 1) < 0))
+    {
+        *error = QString("relay bind port %1: %2").arg(m_listenPort).arg(strerror(errno));
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    m_rng.seed(m_seed);
+    m_startUs = av_gettime_relative();
+    m_running.store(true);
+    m_thread = std::thread(m_protocol == Tcp ? &LossyRelay::runTcp : &LossyRelay::runUdp, this);
+    return true;
+}
+
+void LossyRelay::stop()
+{
+    m_running.store(false);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    if (m_listenFd >= 0)
+    {
+        close(m_listenFd);
+        m_listenFd = -1;
+    }
+}
+
+LossyRelay::Stats LossyRelay::stats() const
+{
+    Stats s;
+    s.packets = m_packets.load(std::memory_order_relaxed);
+    s.bytes = m_bytes.load(std::memory_order_relaxed);
+    s.dropped = m_dropped.load(std::memory_order_relaxed);
+    s.stalls = m_stalls.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool LossyRelay::shouldLose(size_t bytes)
+{
+    if (m_loss <= 0 || av_gettime_relative() - m_startUs < static_cast<qint64>(m_warmupMs) * 1000)
+    {
+        return false;
+    }
+    // 一段数据中任一报文丢失的概率
+    const double segments = static_cast<double>((bytes + kSegmentBytes - 1) / kSegmentBytes);
+    const double probability = 1.0 - std::pow(1.0 - m_loss, qMax(1.0, segments));
+    return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < probability;
+}
+
+void LossyRelay::runUdp()
+{
+    // 上游套接字连接到目标端口：发往目标的数据报经它发出，目标的回复也只从它收到
+    const int upstream = socket(AF_INET, SOCK_DGRAM, 0);
+    const sockaddr_in target = loopback(m_targetPort);
+    connect(upstream, reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+
+    sockaddr_in peer;               // 最近一个发往监听端口的对端
+    bool hasPeer = false;
+    char buffer[65536];
+    while (m_running.load())
+    {
+        pollfd fds[2] = {{m_listenFd, POLLIN, 0}, {upstream, POLLIN, 0}};
+        if (poll(fds, 2, kPollMs) <= 0)
+        {
+            continue;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            socklen_t peerLen = sizeof(peer);
+            const ssize_t n = recvfrom(m_listenFd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&peer),
+                                       &peerLen);
+            if (n > 0)
+            {
+                hasPeer = true;
+                if (shouldLose(static_cast<size_t>(n)))
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if (send(upstream, buffer, static_cast<size_t>(n), 0) == n)
+                {
+                    m_packets.fetch_add(1, std::memory_order_relaxed);
+                    m_bytes.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed);
+                }
+            }
+        }
+        if (fds[1].revents & (POLLIN | POLLERR))
+        {
+            // 目标未监听时收到的 ICMP 错误也在此读掉
+            const ssize_t n = recv(upstream, buffer, sizeof(buffer), 0);
+            if (n > 0 && hasPeer)
+            {
+                if (shouldLose(static_cast<size_t>(n)))
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                else if (sendto(m_listenFd, buffer, static_cast<size_t>(n), 0, reinterpret_cast<const sockaddr *>(&peer),
+                                sizeof(peer)) == n)
+                {
+                    m_packets.fetch_add(1, std::memory_order_relaxed);
+                    m_bytes.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+    close(upstream);
+}
+
+void LossyRelay::runTcp()
+{
+    char buffer[65536];
+    while (m_running.load())
+    {
+        pollfd listenFd = {m_listenFd, POLLIN, 0};
+        if (poll(&listenFd, 1, kPollMs) <= 0)
+        {
+            continue;
+        }
+        const int client = accept(m_listenFd, nullptr, nullptr);
+        if (client < 0)
+        {
+            continue;
+        }
+
+        // 目标可能稍后才开始监听（推流端启动较慢），连接失败时重试一段时间
+        int upstream = -1;
+        const qint64 deadlineUs = av_gettime_relative() + static_cast<qint64>(kConnectRetryMs) * 1000;
+        const sockaddr_in target = loopback(m_targetPort);
+        while (m_running.load() && av_gettime_relative() < deadlineUs)
+        {
+            upstream = socket(AF_INET, SOCK_STREAM, 0);
+            if (connect(upstream, reinterpret_cast<const sockaddr *>(&target), sizeof(target)) == 0)
+            {
+                break;
+            }
+            close(upstream);
+            upstream = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+        }
+        if (upstream < 0)
+        {
+            close(client);
+            continue;
+        }
+
+        // 双向转发直到任一端关闭
+        bool open = true;
+        while (open && m_running.load())
+        {
+            pollfd fds[2] = {{client, POLLIN, 0}, {upstream, POLLIN, 0}};
+            if (poll(fds, 2, kPollMs) <= 0)
+            {
+                continue;
+            }
+            if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                open = pumpTcp(client, upstream, buffer, sizeof(buffer));
+            }
+            if (open && fds[1].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                open = pumpTcp(upstream, client, buffer, sizeof(buffer));
+            }
+        }
+        close(upstream);
+        close(client);
+    }
+}
+
+bool LossyRelay::pumpTcp(int from, int to, char *buffer, size_t size)
+{
+    const ssize_t n = recv(from, buffer, size, 0);
+    if (n <= 0)
+    {
+        return n < 0 && errno == EINTR;
+    }
+    if (shouldLose(static_cast<size_t>(n)))
+    {
+        // 丢包后要等重传超时才能继续，这段时间内连接上的所有数据都被挡住
+        m_stalls.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_stallMs));
+    }
+    m_packets.fetch_add(1, std::memory_order_relaxed);
+    m_bytes.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed);
+    return sendAll(to, buffer, static_cast<size_t>(n));
+}
@@ -0,0 +1,79 @@
+#ifndef LOSSYRELAY_H
+#define LOSSYRELAY_H
+
+#include <QString>
+#include <atomic>
+#include <random>
+#include <thread>
+
+/**
+ * @brief 本机回环上的转发中继，模拟有丢包的链路
+ *
+ * UDP：双向转发数据报，按丢包率随机丢弃（SRT 的重传和 MPEG-TS 的丢包都由此产生）。
+ * TCP：回环上不会真正丢包，改为模拟丢包后的重传：按每 1400 字节一个报文的丢包概率，
+ * 转发一段数据前停顿 stallMs（约为最小重传超时），停顿期间后续数据一起等待（队头阻塞）。
+ * 前 warmupMs 内不丢包，保证接收端拿到第一个关键帧。
+ */
+class LossyRelay
+{
+public:
+    enum Protocol
+    {
+        Tcp,
+        Udp
+    };
+
+    /**
+     * @brief 中继统计信息
+     */
+    struct Stats
+    {
+        quint64 packets = 0;        // 转发的数据报（UDP）或数据段（TCP）数
+        quint64 bytes = 0;          // 转发的字节数
+        quint64 dropped = 0;        // 丢弃的数据报（UDP）
+        quint64 stalls = 0;         // 模拟重传停顿的次数（TCP）
+    };
+
+    /**
+     * @param listenPort 中继监听的本机端口
+     * @param targetPort 转发到的本机端口
+     * @param lossPercent 丢包率（百分比）
+     */
+    LossyRelay(Protocol protocol, quint16 listenPort, quint16 targetPort, double lossPercent, int stallMs,
+               int warmupMs = 1000, quint32 seed = 1);
+    ~LossyRelay();
+
+    LossyRelay(const LossyRelay &) = delete;
+    LossyRelay &operator=(const LossyRelay &) = delete;
+
+    bool start(QString *error);
+    void stop();
+
+    Stats stats() const;
+
+private:
+    void runUdp();
+    void runTcp();
+    bool pumpTcp(int from, int to, char *buffer, size_t size);
+    bool shouldLose(size_t bytes);
+
+    const Protocol m_protocol;
+    const quint16 m_listenPort;
+    const quint16 m_targetPort;
+    const double m_loss;
+    const int m_stallMs;
+    const int m_warmupMs;
+    const quint32 m_seed;
+    int m_listenFd = -1;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    qint64 m_startUs = 0;
+    std::mt19937 m_rng;         // 仅限转发线程，固定种子使每次运行的丢包位置一致
+
+    std::atomic<quint64> m_packets{0};
+    std::atomic<quint64> m_bytes{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_stalls{0};
+};
+
+#endif // LOSSYRELAY_H
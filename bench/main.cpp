@@ -0,0 +1,114 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include <cstdio>
+#include "convert_bench.h"
+#include "decode_bench.h"
+#include "keyframe_bench.h"
+#include "profile_bench.h"
+#include "stop_bench.h"
+#include "trace_file.h"
+#include "transport_bench.h"
+
+static void printUsage()
+{
+    fprintf(stderr,
+            "usage: player_bench <command> [options]\n"
+            "\n"
+            "commands:\n"
+            "  profiles <clip> [--realtime] [--threads N]\n"
+            "      decode the clip once per decoder threading profile and report\n"
+            "      decode fps, CPU usage and the latency each profile adds\n"
+            "  decode [<clip>] [--pattern WxH] [--fps N] [--seconds N] [--realtime]\n"
+            "         [--output WxH] [--profile NAME] [--threads N]\n"
+            "      run the full read/decode/convert pipeline on a clip, or on a generated\n"
+            "      test pattern when no clip is given, and print a JSON report with decode\n"
+            "      fps, per-stage latency percentiles, CPU time, peak RSS and allocations\n"
+            "      per frame\n"
+            "  decode --trace <file> [--realtime] ...\n"
+            "      same, reading a captured trace through the in-process byte ring;\n"
+            "      --realtime replays it at the recorded arrival times\n"
+            "  convert [--sizes WxH,WxH,...] [--timing-size WxH] [--iterations N]\n"
+            "      check every YUV->RGB kernel this CPU supports against sws_scale on\n"
+            "      4:2:0 input (including odd sizes), report max abs diff and PSNR against\n"
+            "      fixed limits and the ns/pixel of each kernel\n"
+            "  capture <url> <file> [--format NAME] [--seconds N]\n"
+            "      record the raw byte stream of a URL with arrival timestamps\n"
+            "  transport [--transports rtmp,rtsp-tcp,rtsp-udp,srt,udp] [--seconds N]\n"
+            "            [--pattern WxH] [--fps N] [--loss PCT] [--stall-ms N]\n"
+            "            [--srt-latency MS] [--base-port N] [--ffmpeg PATH]\n"
+            "      stream a test pattern from a local ffmpeg sender over each transport\n"
+            "      (through a relay that drops packets, or stalls TCP, at the given loss\n"
+            "      rate) and report startup time, steady-state latency and freezes;\n"
+            "      rtmp needs an H.264 pattern and ffmpeg built with libsrt for srt\n"
+            "  stop [--runs N] [--hold-ms N] [--frames N] [--phase open|read]\n"
+            "      point the decoder at a local TCP server that stops sending, call stop()\n"
+            "      while it is blocked opening the input and while it is blocked reading,\n"
+            "      and check that stop() returns within a fixed limit\n"
+            "  keyframe [--seconds N] [--pattern WxH] [--fps N] [--gop SECONDS]\n"
+            "           [--loss-every SECONDS] [--mode honor|ignore]\n"
+            "      decode a live long-GOP stand-in camera that periodically loses half a\n"
+            "      frame, and compare the time to a clean picture when the camera honors\n"
+            "      the decoder's keyframe requests against waiting for the next GOP\n");
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments().mid(1);
+    if (args.isEmpty())
+    {
+        printUsage();
+        return 2;
+    }
+
+    const QString command = args.takeFirst();
+    if (command == "profiles")
+    {
+        return runProfileBench(args);
+    }
+    if (command == "convert")
+    {
+        return runConvertBench(args);
+    }
+    if (command == "decode")
+    {
+        return runDecodeBench(args);
+    }
+    if (command == "keyframe")
+    {
+        return runKeyframeBench(args);
+    }
+    if (command == "stop")
+    {
+        return runStopBench(args);
+    }
+    if (command == "transport")
+    {
+        return runTransportBench(args);
+    }
+    if (command == "capture" && args.size() >= 2)
+    {
+        QString format;
+        int seconds = 30;
+        for (int i = 2; i + 1 < args.size(); i += 2)
+        {
+            if (args[i] == "--format")
+            {
+                format = args[i + 1];
+            }
+            else if (args[i] == "--seconds")
+            {
+                seconds = args[i + 1].toInt();
+            }
+        }
+        QString error;
+        if (!captureTrace(args[0], args[1], format, seconds, &error))
+        {
+            fprintf(stderr, "capture: %s\n", qPrintable(error));
+            return 1;
+        }
+        return 0;
+    }
+    printUsage();
+    return 2;
+}
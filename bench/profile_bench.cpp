@@ -0,0 +1,218 @@
+#include "profile_bench.h"
+#include "decoder_profile.h"
+#include "latency_tracer.h"
+#include <QHash>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/time.h>
+}
+
+namespace
+{
+struct ProfileResult
+{
+    int threads = 0;
+    const char *threadType = "";
+    quint64 frames = 0;
+    double seconds = 0;
+    double cpuSeconds = 0;
+    int maxDelayFrames = 0;
+    LatencyTracer::Summary decode;
+};
+
+qint64 cpuTimeUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 将整段视频的压缩包读入内存，测试时不含读文件的开销
+bool loadPackets(const QString &path, std::vector<AVPacket *> *packets, AVCodecParameters *par,
+                 AVRational *timeBase, AVRational *frameRate)
+{
+    AVFormatContext *fmt = nullptr;
+    if (avformat_open_input(&fmt, path.toUtf8().constData(), nullptr, nullptr) < 0)
+    {
+        fprintf(stderr, "cannot open %s\n", qPrintable(path));
+        return false;
+    }
+    if (avformat_find_stream_info(fmt, nullptr) < 0)
+    {
+        avformat_close_input(&fmt);
+        return false;
+    }
+    const int stream = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (stream < 0)
+    {
+        fprintf(stderr, "no video stream in %s\n", qPrintable(path));
+        avformat_close_input(&fmt);
+        return false;
+    }
+    avcodec_parameters_copy(par, fmt->streams[stream]->codecpar);
+    *timeBase = fmt->streams[stream]->time_base;
+    *frameRate = av_guess_frame_rate(fmt, fmt->streams[stream], nullptr);
+
+    AVPacket *packet = av_packet_alloc();
+    while (av_read_frame(fmt, packet) >= 0)
+    {
+        if (packet->stream_index == stream)
+        {
+            packets->push_back(av_packet_clone(packet));
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&fmt);
+    return !packets->empty();
+}
+
+bool runProfile(DecoderProfile::Profile profile, int threadCount, bool realtime,
+                const std::vector<AVPacket *> &packets, const AVCodecParameters *par,
+                AVRational timeBase, ProfileResult *result)
+{
+    const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+    AVCodecContext *ctx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!ctx)
+    {
+        return false;
+    }
+    avcodec_parameters_to_context(ctx, par);
+    DecoderProfile::apply(ctx, profile, threadCount);
+    if (avcodec_open2(ctx, codec, nullptr) < 0)
+    {
+        avcodec_free_context(&ctx);
+        return false;
+    }
+    result->threads = ctx->thread_count;
+    result->threadType = DecoderProfile::activeThreadTypeName(ctx);
+
+    LatencyTracer tracer;
+    QHash<qint64, qint64> sendTimes;   // PTS -> 送入时间
+    AVFrame *frame = av_frame_alloc();
+    int sent = 0;
+
+    auto drain = [&]()
+    {
+        while (avcodec_receive_frame(ctx, frame) >= 0)
+        {
+            result->frames++;
+            const qint64 pts = frame->pts != AV_NOPTS_VALUE ? frame->pts : frame->pkt_dts;
+            tracer.record(LatencyTracer::StageDecode, sendTimes.take(pts), LatencyTracer::nowUs());
+        }
+    };
+
+    const qint64 startUs = LatencyTracer::nowUs();
+    const qint64 startCpuUs = cpuTimeUs();
+    int64_t firstTs = AV_NOPTS_VALUE;
+    for (AVPacket *packet : packets)
+    {
+        const int64_t ts = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+        if (realtime && ts != AV_NOPTS_VALUE)
+        {
+            // 按时间戳节奏送包，模拟直播
+            if (firstTs == AV_NOPTS_VALUE)
+            {
+                firstTs = ts;
+            }
+            const qint64 dueUs = startUs + av_rescale_q(ts - firstTs, timeBase, AV_TIME_BASE_Q);
+            const qint64 waitUs = dueUs - LatencyTracer::nowUs();
+            if (waitUs > 0)
+            {
+                av_usleep(static_cast<unsigned>(waitUs));
+            }
+        }
+
+        sendTimes.insert(packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts, LatencyTracer::nowUs());
+        if (avcodec_send_packet(ctx, packet) >= 0)
+        {
+            sent++;
+        }
+        drain();
+        result->maxDelayFrames = qMax(result->maxDelayFrames, sent - static_cast<int>(result->frames));
+    }
+    avcodec_send_packet(ctx, nullptr);
+    drain();
+
+    result->seconds = (LatencyTracer::nowUs() - startUs) / 1e6;
+    result->cpuSeconds = (cpuTimeUs() - startCpuUs) / 1e6;
+    result->decode = tracer.summary(LatencyTracer::StageDecode);
+
+    av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+    return true;
+}
+}
+
+int runProfileBench(const QStringList &args)
+{
+    QString path;
+    bool realtime = false;
+    int threadCount = 0;
+    for (int i = 0; i < args.size(); i++)
+    {
+        if (args[i] == "--realtime")
+        {
+            realtime = true;
+        }
+        else if (args[i] == "--threads" && i + 1 < args.size())
+        {
+            threadCount = args[++i].toInt();
+        }
+        else
+        {
+            path = args[i];
+        }
+    }
+    if (path.isEmpty())
+    {
+        fprintf(stderr, "profiles: missing clip path\n");
+        return 2;
+    }
+
+    std::vector<AVPacket *> packets;
+    AVCodecParameters *par = avcodec_parameters_alloc();
+    AVRational timeBase{1, 1000};
+    AVRational frameRate{0, 1};
+    if (!loadPackets(path, &packets, par, &timeBase, &frameRate))
+    {
+        avcodec_parameters_free(&par);
+        return 1;
+    }
+    const double frameMs = frameRate.num > 0 ? 1000.0 / av_q2d(frameRate) : 0;
+
+    printf("clip: %s, %dx%d, %zu packets, %.2f fps%s\n", qPrintable(path), par->width, par->height,
+           packets.size(), frameMs > 0 ? 1000.0 / frameMs : 0.0, realtime ? ", real-time pacing" : "");
+    printf("%-12s %7s %6s %9s %7s %11s %11s %9s %9s\n", "profile", "threads", "type", "fps", "cpu%",
+           "delay(fr)", "added(ms)", "p50(ms)", "p95(ms)");
+
+    int status = 0;
+    for (int i = 0; i < DecoderProfile::ProfileCount; i++)
+    {
+        const DecoderProfile::Profile profile = static_cast<DecoderProfile::Profile>(i);
+        ProfileResult r;
+        if (!runProfile(profile, threadCount, realtime, packets, par, timeBase, &r))
+        {
+            fprintf(stderr, "%s: failed to open decoder\n", DecoderProfile::name(profile));
+            status = 1;
+            continue;
+        }
+        printf("%-12s %7d %6s %9.1f %7.1f %11d %11.1f %9.2f %9.2f\n", DecoderProfile::name(profile),
+               r.threads, r.threadType, r.seconds > 0 ? r.frames / r.seconds : 0.0,
+               r.seconds > 0 ? 100.0 * r.cpuSeconds / r.seconds : 0.0, r.maxDelayFrames,
+               r.maxDelayFrames * frameMs, r.decode.p50, r.decode.p95);
+    }
+
+    for (AVPacket *packet : packets)
+    {
+        av_packet_free(&packet);
+    }
+    avcodec_parameters_free(&par);
+    return status;
+}
@@ -0,0 +1,15 @@
+#ifndef PROFILEBENCH_H
+#define PROFILEBENCH_H
+
+#include <QStringList>
+
+/**
+ * @brief 按各解码多线程配置档解码同一段本地视频，输出解码帧率、CPU 占用和额外延迟
+ *
+ * 额外延迟有两种度量：解码器内滞留的帧数（送入包数与输出帧数之差的最大值）
+ * 乘以帧间隔，即直播时每帧因多线程而推迟显示的时间；以及每帧从送入到输出的耗时分布。
+ * 加 --realtime 时按时间戳节奏送包，后者即为直播时的实际解码延迟。
+ */
+int runProfileBench(const QStringList &args);
+
+#endif // PROFILEBENCH_H
@@ -0,0 +1,216 @@
+#include "stop_bench.h"
+#include "stream_probe_cache.h"
+#include "test_pattern.h"
+#include "video_decoder.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <cstdio>
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+namespace
+{
+// stop() 的耗时上限：FFmpeg 的网络协议阻塞时约每 100 ms 检查一次中断回调
+const double kMaxStopMs = 250.0;
+const int kAcceptTimeoutMs = 5000;
+const int kFirstFrameTimeoutMs = 5000;
+
+struct Options
+{
+    int runs = 5;               // 每个阶段重复次数
+    int holdMs = 500;           // 确认阻塞后再等多久调用 stop()，须小于 READ_STALL_MS
+    int frames = 50;            // "read" 阶段停止发送前发出的帧数
+    QStringList phases{"open", "read"};
+};
+
+bool parseOptions(const QStringList &args, Options *o)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--runs" && hasValue)
+        {
+            o->runs = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--hold-ms" && hasValue)
+        {
+            o->holdMs = qMax(0, args[++i].toInt());
+        }
+        else if (arg == "--frames" && hasValue)
+        {
+            o->frames = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--phase" && hasValue)
+        {
+            const QString phase = args[++i];
+            if (phase != "open" && phase != "read")
+            {
+                return false;
+            }
+            o->phases = QStringList{phase};
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 编码前若干帧测试图案，得到可被探测为裸码流的数据
+ */
+bool encodeStreamHead(int frames, QByteArray *data, QString *error)
+{
+    PatternEncoder encoder;
+    if (!encoder.open(640, 360, 25, 1, error))
+    {
+        return false;
+    }
+    for (int i = 0; i < frames; i++)
+    {
+        encoder.encode(i, false, [data](AVPacket *packet)
+                       {
+                           data->append(reinterpret_cast<const char *>(packet->data), packet->size);
+                           return true;
+                       });
+    }
+    return !data->isEmpty();
+}
+
+/**
+ * @brief 一次测量：启动解码器，等它阻塞在指定阶段后调用 stop()
+ * @param streamHead 为空时服务端不发送任何数据（阻塞在打开阶段）
+ */
+QJsonObject runOnce(const QString &phase, const QByteArray &streamHead, const Options &o)
+{
+    QJsonObject result;
+    result["phase"] = phase;
+
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost, 0))
+    {
+        result["error"] = server.errorString();
+        return result;
+    }
+    const QString url = QString("tcp://127.0.0.1:%1").arg(server.serverPort());
+
+    StreamProbeCache::remove(url);
+    AppConfig config;
+    VideoDecoder decoder(config, url);
+    decoder.setReconnectEnabled(false);
+    decoder.start();
+
+    if (!server.waitForNewConnection(kAcceptTimeoutMs))
+    {
+        decoder.stop();
+        result["error"] = "decoder did not connect";
+        return result;
+    }
+    // 持有连接直到 stop() 之后，服务端不主动关闭
+    QTcpSocket *socket = server.nextPendingConnection();
+    if (!streamHead.isEmpty())
+    {
+        socket->write(streamHead);
+        while (socket->bytesToWrite() > 0 && socket->waitForBytesWritten(1000))
+        {
+        }
+    }
+
+    // "read" 阶段：等到已出帧且解码帧数不再增长，即已解完收到的数据、阻塞在 av_read_frame 中
+    bool blocked = true;
+    if (phase == "read")
+    {
+        const qint64 deadlineUs = av_gettime_relative() + static_cast<qint64>(kFirstFrameTimeoutMs) * 1000;
+        quint64 decoded = 0;
+        qint64 settledUs = av_gettime_relative();
+        while (av_gettime_relative() < deadlineUs)
+        {
+            QThread::msleep(20);
+            const quint64 count = decoder.stats().framesDecoded;
+            if (count != decoded)
+            {
+                decoded = count;
+                settledUs = av_gettime_relative();
+            }
+            else if (decoded > 0 && av_gettime_relative() - settledUs > 200000)
+            {
+                break;
+            }
+        }
+        blocked = decoded > 0;
+        result["frames_decoded"] = static_cast<qint64>(decoded);
+    }
+    QThread::msleep(static_cast<unsigned long>(o.holdMs));
+
+    const VideoDecoder::Stats before = decoder.stats();
+    if (phase == "open")
+    {
+        // 打开尚未完成（openMs 仍为 0）才说明阻塞在 avformat_open_input 中
+        blocked = before.openMs == 0;
+    }
+    // 等待期间不应因超时自行结束，否则测到的不是阻塞中的 stop()
+    blocked = blocked && !decoder.isFinished();
+
+    decoder.stop();
+    const VideoDecoder::Stats s = decoder.stats();
+    const bool pass = blocked && s.lastStopMs <= kMaxStopMs;
+    result["blocked"] = blocked;
+    result["stop_ms"] = s.lastStopMs;
+    result["pass"] = pass;
+    socket->abort();
+    return result;
+}
+}
+
+int runStopBench(const QStringList &args)
+{
+    Options options;
+    if (!parseOptions(args, &options))
+    {
+        fprintf(stderr, "stop: invalid arguments\n");
+        return 2;
+    }
+
+    QByteArray streamHead;
+    if (options.phases.contains("read"))
+    {
+        QString error;
+        if (!encodeStreamHead(options.frames, &streamHead, &error))
+        {
+            fprintf(stderr, "stop: %s\n", qPrintable(error));
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    QJsonArray results;
+    for (const QString &phase : options.phases)
+    {
+        double maxStopMs = 0;
+        for (int run = 0; run < options.runs; run++)
+        {
+            const QJsonObject result = runOnce(phase, phase == "read" ? streamHead : QByteArray(), options);
+            ok = ok && result["pass"].toBool();
+            maxStopMs = qMax(maxStopMs, result["stop_ms"].toDouble());
+            results.append(result);
+        }
+        fprintf(stderr, "stop: blocked in %s, max stop %.1f ms\n", qPrintable(phase), maxStopMs);
+    }
+
+    QJsonObject report;
+    report["max_stop_ms_limit"] = kMaxStopMs;
+    report["hold_ms"] = options.holdMs;
+    report["results"] = results;
+    report["pass"] = ok;
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#ifndef STOPBENCH_H
+#define STOPBENCH_H
+
+#include <QStringList>
+
+/**
+ * @brief 测量 VideoDecoder::stop() 在 I/O 阻塞时的返回耗时
+ *
+ * 本机 QTcpServer 接受连接后不再发送数据，VideoDecoder 以 tcp:// 地址连接：
+ * "open" 阶段服务端一个字节也不发，解码线程阻塞在 avformat_open_input 的格式探测中；
+ * "read" 阶段服务端先发送一段测试图案裸码流后停止发送，解码线程解完已收到的帧后阻塞在 av_read_frame 中。
+ * 确认阻塞后调用 stop()，lastStopMs 超过固定上限即判为失败。
+ * 结果以 JSON 输出到标准输出，有任一次失败时返回非零。
+ */
+int runStopBench(const QStringList &args);
+
+#endif // STOPBENCH_H
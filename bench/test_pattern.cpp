@@ -0,0 +1,199 @@
+#include "test_pattern.h"
+#include "packet_muxer.h"
+#include <cstring>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/opt.h>
+}
+
+namespace
+{
+// 移动的竖向色条 + 纵向亮度渐变，保证帧间有运动、帧内有细节
+void drawPattern(AVFrame *frame, int index)
+{
+    static const uint8_t kBars[8][3] = {{235, 128, 128}, {210, 16, 146}, {170, 166, 16}, {145, 54, 34},
+                                        {106, 202, 222}, {81, 90, 240}, {41, 240, 110}, {16, 128, 128}};
+    const int barWidth = qMax(1, frame->width / 8);
+    const int shift = index * 4;
+    for (int y = 0; y < frame->height; y++)
+    {
+        uint8_t *row = frame->data[0] + y * frame->linesize[0];
+        const int gradient = (y * 64) / qMax(1, frame->height);
+        for (int x = 0; x < frame->width; x++)
+        {
+            row[x] = static_cast<uint8_t>(qMin(255, kBars[((x + shift) / barWidth) % 8][0] * 3 / 4 + gradient));
+        }
+    }
+    for (int y = 0; y < frame->height / 2; y++)
+    {
+        uint8_t *u = frame->data[1] + y * frame->linesize[1];
+        uint8_t *v = frame->data[2] + y * frame->linesize[2];
+        for (int x = 0; x < frame->width / 2; x++)
+        {
+            const int bar = ((x * 2 + shift) / barWidth) % 8;
+            u[x] = kBars[bar][1];
+            v[x] = kBars[bar][2];
+        }
+    }
+}
+
+AVCodecContext *openEncoder(int width, int height, int fps, int gopSeconds, bool globalHeader)
+{
+    const char *names[] = {"libx264", "mpeg4"};
+    for (const char *name : names)
+    {
+        const AVCodec *codec = avcodec_find_encoder_by_name(name);
+        if (!codec)
+        {
+            continue;
+        }
+        AVCodecContext *ctx = avcodec_alloc_context3(codec);
+        ctx->width = width;
+        ctx->height = height;
+        ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+        ctx->time_base = AVRational{1, fps};
+        ctx->framerate = AVRational{fps, 1};
+        ctx->gop_size = fps * qMax(1, gopSeconds);
+        ctx->max_b_frames = 0;
+        ctx->bit_rate = static_cast<int64_t>(width) * height * fps / 8;     // 约 0.125 bit/像素
+        if (globalHeader)
+        {
+            ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        if (strcmp(name, "libx264") == 0)
+        {
+            av_opt_set(ctx->priv_data, "preset", "ultrafast", 0);
+            av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+            av_opt_set(ctx->priv_data, "forced-idr", "1", 0);
+        }
+        if (avcodec_open2(ctx, codec, nullptr) >= 0)
+        {
+            return ctx;
+        }
+        avcodec_free_context(&ctx);
+    }
+    return nullptr;
+}
+}
+
+bool writeTestPattern(const QString &path, int width, int height, int fps, int seconds, int gopSeconds,
+                      QString *codecName, QString *error)
+{
+    AVCodecContext *encoder = openEncoder(width, height, fps, gopSeconds, true);
+    if (!encoder)
+    {
+        *error = "no usable encoder (libx264 or mpeg4)";
+        return false;
+    }
+    *codecName = QString::fromLatin1(encoder->codec->name);
+
+    AVCodecParameters *par = avcodec_parameters_alloc();
+    avcodec_parameters_from_context(par, encoder);
+    PacketMuxer muxer;
+    bool ok = muxer.open(path, "mkv", par, encoder->time_base, 1024 * 1024);
+    avcodec_parameters_free(&par);
+
+    AVFrame *frame = av_frame_alloc();
+    frame->width = width;
+    frame->height = height;
+    frame->format = AV_PIX_FMT_YUV420P;
+    ok = ok && av_frame_get_buffer(frame, 0) >= 0;
+    AVPacket *packet = av_packet_alloc();
+
+    const int frameCount = fps * seconds;
+    for (int i = 0; ok && i <= frameCount; i++)
+    {
+        // 最后一轮送入 nullptr 冲洗编码器
+        AVFrame *input = nullptr;
+        if (i < frameCount)
+        {
+            ok = av_frame_make_writable(frame) >= 0;
+            drawPattern(frame, i);
+            frame->pts = i;
+            input = frame;
+        }
+        if (!ok || avcodec_send_frame(encoder, input) < 0)
+        {
+            ok = false;
+            break;
+        }
+        while (ok && avcodec_receive_packet(encoder, packet) >= 0)
+        {
+            ok = muxer.write(packet);
+            av_packet_unref(packet);
+        }
+    }
+    if (!ok && error->isEmpty())
+    {
+        *error = muxer.errorString().isEmpty() ? "encoding failed" : muxer.errorString();
+    }
+    ok = muxer.close() && ok;
+
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&encoder);
+    return ok;
+}
+
+PatternEncoder::~PatternEncoder()
+{
+    av_packet_free(&m_packet);
+    av_frame_free(&m_frame);
+    avcodec_free_context(&m_encoder);
+}
+
+bool PatternEncoder::open(int width, int height, int fps, int gopSeconds, QString *error)
+{
+    // 参数集随关键帧在码流中重复，接收端从任一关键帧都能开始解码
+    m_encoder = openEncoder(width, height, fps, gopSeconds, false);
+    if (!m_encoder)
+    {
+        *error = "no usable encoder (libx264 or mpeg4)";
+        return false;
+    }
+    m_frame = av_frame_alloc();
+    m_frame->width = width;
+    m_frame->height = height;
+    m_frame->format = AV_PIX_FMT_YUV420P;
+    m_packet = av_packet_alloc();
+    if (av_frame_get_buffer(m_frame, 0) < 0)
+    {
+        *error = "out of memory";
+        return false;
+    }
+    return true;
+}
+
+const char *PatternEncoder::codecName() const
+{
+    return m_encoder ? m_encoder->codec->name : "";
+}
+
+const char *PatternEncoder::rawFormatName() const
+{
+    return m_encoder && m_encoder->codec_id == AV_CODEC_ID_H264 ? "h264" : "m4v";
+}
+
+bool PatternEncoder::encode(int index, bool forceKeyframe, const std::function<bool(AVPacket *)> &sink)
+{
+    if (av_frame_make_writable(m_frame) < 0)
+    {
+        return false;
+    }
+    drawPattern(m_frame, index);
+    m_frame->pts = index;
+    m_frame->pict_type = forceKeyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    if (avcodec_send_frame(m_encoder, m_frame) < 0)
+    {
+        return false;
+    }
+    bool ok = true;
+    while (ok && avcodec_receive_packet(m_encoder, m_packet) >= 0)
+    {
+        ok = sink(m_packet);
+        av_packet_unref(m_packet);
+    }
+    return ok;
+}
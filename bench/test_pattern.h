@@ -0,0 +1,56 @@
+#ifndef TESTPATTERN_H
+#define TESTPATTERN_H
+
+#include <QString>
+#include <functional>
+
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+
+/**
+ * @brief 生成合成测试图案视频文件（移动色条加渐变，每帧内容不同）
+ *
+ * 优先使用 libx264（ultrafast + zerolatency，与摄像头推流接近），
+ * 不可用时退回 FFmpeg 内置的 mpeg4 编码器。输出为 mkv，封装经由 PacketMuxer。
+ * @param gopSeconds 关键帧间隔
+ */
+bool writeTestPattern(const QString &path, int width, int height, int fps, int seconds, int gopSeconds,
+                      QString *codecName, QString *error);
+
+/**
+ * @brief 逐帧实时编码测试图案，用于模拟推流的摄像头（可按请求立即编码关键帧）
+ *
+ * 编码器选择同 writeTestPattern()，参数集随每个关键帧写在码流中，输出可直接拼接为裸码流。
+ */
+class PatternEncoder
+{
+public:
+    PatternEncoder() = default;
+    ~PatternEncoder();
+
+    PatternEncoder(const PatternEncoder &) = delete;
+    PatternEncoder &operator=(const PatternEncoder &) = delete;
+
+    bool open(int width, int height, int fps, int gopSeconds, QString *error);
+
+    const char *codecName() const;
+
+    /**
+     * @brief 裸码流对应的输入格式名（h264 / m4v）
+     */
+    const char *rawFormatName() const;
+
+    /**
+     * @brief 编码第 index 帧，输出的包依次交给 sink（sink 返回 false 时停止）
+     * @param forceKeyframe 编码为关键帧（libx264 下为 IDR）
+     */
+    bool encode(int index, bool forceKeyframe, const std::function<bool(AVPacket *)> &sink);
+
+private:
+    AVCodecContext *m_encoder = nullptr;
+    AVFrame *m_frame = nullptr;
+    AVPacket *m_packet = nullptr;
+};
+
+#endif // TESTPATTERN_H
@@ -0,0 +1,196 @@
+#include "trace_file.h"
+#include <QtEndian>
+#include <cstdio>
+#include <vector>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavutil/time.h>
+}
+
+namespace
+{
+const char kMagic[8] = {'P', 'B', 'T', 'R', 'A', 'C', 'E', '1'};
+const int kFormatNameSize = 16;
+const int kRecordHeaderSize = 12;
+
+struct CaptureDeadline
+{
+    qint64 deadlineUs = 0;
+};
+
+int captureInterrupt(void *opaque)
+{
+    return av_gettime_relative() > static_cast<CaptureDeadline *>(opaque)->deadlineUs;
+}
+
+// 写满 size 字节，环形缓冲已满时等待读端取走数据
+bool writeAll(ByteRing &ring, const uint8_t *data, size_t size, const std::atomic<bool> &running)
+{
+    while (size > 0 && running.load())
+    {
+        const size_t written = ring.write(data, size);
+        data += written;
+        size -= written;
+        if (size > 0)
+        {
+            ring.waitForSpace(qMin(size, ring.capacity() / 2), 10);
+        }
+    }
+    return size == 0;
+}
+}
+
+bool captureTrace(const QString &url, const QString &path, QString format, int seconds, QString *error)
+{
+    if (format.isEmpty())
+    {
+        if (url.startsWith("rtmp"))
+        {
+            format = "flv";
+        }
+        else if (url.startsWith("udp:") || url.startsWith("srt:"))
+        {
+            format = "mpegts";
+        }
+        else
+        {
+            *error = "cannot infer stream format, use --format";
+            return false;
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        *error = file.errorString();
+        return false;
+    }
+    QByteArray header(kMagic, sizeof(kMagic));
+    header.append(format.toLatin1().left(kFormatNameSize - 1).leftJustified(kFormatNameSize, '\0'));
+    file.write(header);
+
+    avformat_network_init();
+    CaptureDeadline deadline;
+    const qint64 startUs = av_gettime_relative();
+    deadline.deadlineUs = startUs + static_cast<qint64>(seconds) * 1000000;
+    AVIOInterruptCB interrupt{&captureInterrupt, &deadline};
+    AVIOContext *io = nullptr;
+    if (avio_open2(&io, url.toUtf8().constData(), AVIO_FLAG_READ, &interrupt, nullptr) < 0)
+    {
+        *error = "cannot open " + url;
+        avformat_network_deinit();
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(64 * 1024);
+    quint64 total = 0;
+    for (;;)
+    {
+        // 每次读取网络实际到达的数据，保留原始的分块与时间
+        const int count = avio_read_partial(io, buffer.data(), static_cast<int>(buffer.size()));
+        if (count <= 0)
+        {
+            break;
+        }
+        uchar recordHeader[kRecordHeaderSize];
+        qToLittleEndian<qint64>(av_gettime_relative() - startUs, recordHeader);
+        qToLittleEndian<qint32>(count, recordHeader + 8);
+        file.write(reinterpret_cast<const char *>(recordHeader), kRecordHeaderSize);
+        file.write(reinterpret_cast<const char *>(buffer.data()), count);
+        total += static_cast<quint64>(count);
+    }
+    avio_closep(&io);
+    avformat_network_deinit();
+    fprintf(stderr, "captured %llu bytes (%s) to %s\n", static_cast<unsigned long long>(total), qPrintable(format),
+            qPrintable(path));
+    return total > 0 && file.error() == QFileDevice::NoError;
+}
+
+TraceReplayer::TraceReplayer(const QString &path, std::shared_ptr<ByteRing> ring, bool realtime)
+    : m_file(path), m_ring(std::move(ring)), m_realtime(realtime)
+{
+}
+
+TraceReplayer::~TraceReplayer()
+{
+    stop();
+}
+
+bool TraceReplayer::open(QString *error)
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        *error = m_file.errorString();
+        return false;
+    }
+    const QByteArray header = m_file.read(sizeof(kMagic) + kFormatNameSize);
+    if (header.size() != static_cast<int>(sizeof(kMagic)) + kFormatNameSize ||
+        !header.startsWith(QByteArray(kMagic, sizeof(kMagic))))
+    {
+        *error = "not a trace file";
+        return false;
+    }
+    m_format = QString::fromLatin1(header.mid(sizeof(kMagic)).constData());
+    return true;
+}
+
+void TraceReplayer::start()
+{
+    m_running.store(true);
+    m_thread = std::thread(&TraceReplayer::replayLoop, this);
+}
+
+void TraceReplayer::stop()
+{
+    m_running.store(false);
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void TraceReplayer::replayLoop()
+{
+    const qint64 startUs = av_gettime_relative();
+    QByteArray data;
+    while (m_running.load())
+    {
+        uchar recordHeader[kRecordHeaderSize];
+        if (m_file.read(reinterpret_cast<char *>(recordHeader), kRecordHeaderSize) != kRecordHeaderSize)
+        {
+            break;
+        }
+        const qint64 offsetUs = qFromLittleEndian<qint64>(recordHeader);
+        const qint32 size = qFromLittleEndian<qint32>(recordHeader + 8);
+        data = m_file.read(size);
+        if (data.size() != size)
+        {
+            break;
+        }
+
+        if (m_realtime)
+        {
+            // 按记录的到达时间写入，分段休眠以便及时停止
+            const qint64 dueUs = startUs + offsetUs;
+            for (qint64 waitUs = dueUs - av_gettime_relative(); waitUs > 0 && m_running.load();
+                 waitUs = dueUs - av_gettime_relative())
+            {
+                av_usleep(static_cast<unsigned>(qMin<qint64>(waitUs, 10000)));
+            }
+            const qint64 lateUs = av_gettime_relative() - dueUs;
+            if (lateUs > m_maxLateUs.load(std::memory_order_relaxed))
+            {
+                m_maxLateUs.store(lateUs, std::memory_order_relaxed);
+            }
+        }
+        if (!writeAll(*m_ring, reinterpret_cast<const uint8_t *>(data.constData()), static_cast<size_t>(size),
+                      m_running))
+        {
+            break;
+        }
+        m_bytes.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+    }
+    m_ring->close();
+}
@@ -0,0 +1,55 @@
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "byte_ring.h"
+
+/**
+ * 抓包文件格式：
+ *   文件头：8 字节 "PBTRACE1" + 16 字节输入格式名（如 flv、mpegts，不足补 0）
+ *   记录：  int64 相对抓包开始的时间（微秒）+ int32 长度 + 数据，小端
+ * 每条记录是一次网络读取实际返回的数据，回放时按记录时间写入即可重现到达节奏。
+ */
+
+/**
+ * @brief 从流地址读取原始字节流（不解复用）并记录到达时间
+ * @param format 字节流的格式，为空时按地址协议推断（rtmp -> flv，udp/srt -> mpegts）
+ */
+bool captureTrace(const QString &url, const QString &path, QString format, int seconds, QString *error);
+
+/**
+ * @brief 将抓包文件写入字节环形缓冲，按记录时间（或尽快）回放，结束后关闭环形缓冲
+ */
+class TraceReplayer
+{
+public:
+    TraceReplayer(const QString &path, std::shared_ptr<ByteRing> ring, bool realtime);
+    ~TraceReplayer();
+
+    bool open(QString *error);
+    QString format() const { return m_format; }
+
+    void start();
+    void stop();
+
+    quint64 bytesReplayed() const { return m_bytes.load(std::memory_order_relaxed); }
+    double maxLateMs() const { return m_maxLateUs.load(std::memory_order_relaxed) / 1000.0; }   // 写入晚于记录时间的最大值
+
+private:
+    void replayLoop();
+
+    QFile m_file;
+    const std::shared_ptr<ByteRing> m_ring;
+    const bool m_realtime;
+    QString m_format;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<quint64> m_bytes{0};
+    std::atomic<qint64> m_maxLateUs{0};
+};
+
+#endif // TRACEFILE_H
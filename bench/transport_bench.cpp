@@ -0,0 +1,413 @@
+#include "transport_bench.h"
+#include "bench_util.h"
+#include "lossy_relay.h"
+#include "stream_probe_cache.h"
+#include "test_pattern.h"
+#include "video_decoder.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QThread>
+#include <cstdio>
+
+namespace
+{
+struct Options
+{
+    QStringList transports{"rtmp", "rtsp-tcp", "rtsp-udp", "srt", "udp"};
+    QSize patternSize{1280, 720};
+    int patternFps = 30;
+    int seconds = 20;
+    double lossPercent = 0;     // 中继模拟的丢包率
+    int stallMs = 200;          // TCP 丢包后的重传停顿，约为 Linux 的最小重传超时
+    int srtLatencyMs = 120;
+    int basePort = 23450;       // 每种传输占用 basePort + 10 * 序号 起的 3 个端口
+    QString ffmpeg = "ffmpeg";
+};
+
+/**
+ * @brief 一种传输方式的推流端、中继和接收端配置
+ */
+struct Setup
+{
+    QStringList senderArgs;     // 输出部分的 ffmpeg 参数
+    QString receiverUrl;
+    bool receiverListens = false;       // 接收端先启动并等待推流端连接
+    std::unique_ptr<LossyRelay> relay;
+};
+
+struct FrameSample
+{
+    qint64 handoffUs = 0;
+    qint64 ptsUs = 0;
+};
+
+bool parseOptions(const QStringList &args, Options *o)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        const QString &arg = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (arg == "--transports" && hasValue)
+        {
+            o->transports = args[++i].split(',', Qt::SkipEmptyParts);
+        }
+        else if (arg == "--pattern" && hasValue)
+        {
+            if (!parseSize(args[++i], &o->patternSize))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--fps" && hasValue)
+        {
+            o->patternFps = qMax(1, args[++i].toInt());
+        }
+        else if (arg == "--seconds" && hasValue)
+        {
+            o->seconds = qMax(3, args[++i].toInt());
+        }
+        else if (arg == "--loss" && hasValue)
+        {
+            o->lossPercent = qBound(0.0, args[++i].toDouble(), 50.0);
+        }
+        else if (arg == "--stall-ms" && hasValue)
+        {
+            o->stallMs = qMax(0, args[++i].toInt());
+        }
+        else if (arg == "--srt-latency" && hasValue)
+        {
+            o->srtLatencyMs = qMax(20, args[++i].toInt());
+        }
+        else if (arg == "--base-port" && hasValue)
+        {
+            o->basePort = qBound(1024, args[++i].toInt(), 65000);
+        }
+        else if (arg == "--ffmpeg" && hasValue)
+        {
+            o->ffmpeg = args[++i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return !o->transports.isEmpty();
+}
+
+/**
+ * @brief 按传输方式确定端口和连接方向：推流端口 port，中继端口 port + 1，接收端口 port + 2
+ */
+Setup makeSetup(StreamTransport::Type type, const Options &o, int port)
+{
+    const quint16 senderPort = static_cast<quint16>(port);
+    const quint16 relayPort = static_cast<quint16>(port + 1);
+    const quint16 receiverPort = static_cast<quint16>(port + 2);
+    Setup setup;
+    switch (type)
+    {
+    case StreamTransport::Rtmp:
+        // ffmpeg 作为 RTMP 服务端等待拉流，接收端经中继连接
+        setup.senderArgs = {"-f", "flv", "-listen", "1", QString("rtmp://127.0.0.1:%1/live/bench").arg(senderPort)};
+        setup.receiverUrl = QString("rtmp://127.0.0.1:%1/live/bench").arg(relayPort);
+        setup.relay = std::make_unique<LossyRelay>(LossyRelay::Tcp, relayPort, senderPort, o.lossPercent, o.stallMs);
+        break;
+    case StreamTransport::RtspTcp:
+    case StreamTransport::RtspUdp:
+    {
+        // ffmpeg 不能作为 RTSP 服务端供拉流，改为接收端监听、ffmpeg 推流（ANNOUNCE/RECORD），
+        // 媒体数据的走向与拉流相同
+        const bool tcp = type == StreamTransport::RtspTcp;
+        setup.receiverUrl = QString("rtsp://127.0.0.1:%1/live").arg(receiverPort);
+        setup.receiverListens = true;
+        setup.senderArgs = {"-rtsp_transport", tcp ? "tcp" : "udp", "-f", "rtsp",
+                            QString("rtsp://127.0.0.1:%1/live").arg(tcp ? relayPort : receiverPort)};
+        if (tcp)
+        {
+            setup.relay = std::make_unique<LossyRelay>(LossyRelay::Tcp, relayPort, receiverPort, o.lossPercent,
+                                                       o.stallMs);
+        }
+        break;
+    }
+    case StreamTransport::Srt:
+        setup.senderArgs = {"-f", "mpegts", "-muxdelay", "0", "-muxpreload", "0",
+                            QString("srt://127.0.0.1:%1?mode=listener&transtype=live&latency=%2")
+                                .arg(senderPort)
+                                .arg(static_cast<qint64>(o.srtLatencyMs) * 1000)};
+        setup.receiverUrl = QString("srt://127.0.0.1:%1").arg(relayPort);
+        setup.relay = std::make_unique<LossyRelay>(LossyRelay::Udp, relayPort, senderPort, o.lossPercent, 0);
+        break;
+    case StreamTransport::MpegTsUdp:
+    default:
+        setup.senderArgs = {"-f", "mpegts", "-muxdelay", "0", "-muxpreload", "0",
+                            QString("udp://127.0.0.1:%1?pkt_size=1316").arg(relayPort)};
+        setup.receiverUrl = QString("udp://127.0.0.1:%1").arg(receiverPort);
+        setup.receiverListens = true;
+        setup.relay = std::make_unique<LossyRelay>(LossyRelay::Udp, relayPort, receiverPort, o.lossPercent, 0);
+        break;
+    }
+    return setup;
+}
+
+QJsonObject runTransport(StreamTransport::Type type, const Options &o, const QString &pattern, int port)
+{
+    QJsonObject result;
+    result["transport"] = QString::fromLatin1(StreamTransport::name(type));
+
+    Setup setup = makeSetup(type, o, port);
+    if (setup.relay)
+    {
+        QString error;
+        if (!setup.relay->start(&error))
+        {
+            result["error"] = error;
+            return result;
+        }
+    }
+
+    // 接收端：冷启动（不使用上次缓存的流参数），断开即结束
+    StreamProbeCache::remove(setup.receiverUrl);
+    AppConfig config;
+    VideoDecoder decoder(config, setup.receiverUrl);
+    StreamTransport::Settings settings;
+    settings.type = type;
+    settings.srtLatencyMs = o.srtLatencyMs;
+    settings.listen = setup.receiverListens;
+    decoder.setTransport(settings);
+    decoder.setReconnectEnabled(false);
+    QString decodeError;
+    QObject::connect(&decoder, &VideoDecoder::errorOccurred, &decoder,
+                     [&decodeError](const QString &message) { decodeError = message; }, Qt::DirectConnection);
+    auto mailbox = std::make_shared<FrameMailbox>();
+    decoder.setFrameMailbox(mailbox);
+
+    // 推流端：按实时速率发送，每 100 ms 输出一次进度
+    QProcess sender;
+    sender.setProgram(o.ffmpeg);
+    sender.setArguments(QStringList{"-hide_banner", "-loglevel", "error", "-nostdin", "-re", "-i", pattern, "-c",
+                                    "copy", "-progress", "pipe:1", "-stats_period", "0.1"} +
+                        setup.senderArgs);
+
+    qint64 senderStartUs = 0;
+    qint64 receiverStartUs = 0;
+    auto startSender = [&]()
+    {
+        senderStartUs = LatencyTracer::nowUs();
+        sender.start();
+        return sender.waitForStarted(3000);
+    };
+    auto startReceiver = [&]()
+    {
+        receiverStartUs = LatencyTracer::nowUs();
+        decoder.start();
+    };
+    // 先启动等待连接的一端，留出监听的时间
+    bool started = true;
+    if (setup.receiverListens)
+    {
+        startReceiver();
+        QThread::msleep(300);
+        started = startSender();
+    }
+    else
+    {
+        started = startSender();
+        QThread::msleep(300);
+        startReceiver();
+    }
+    if (!started)
+    {
+        decoder.stop();
+        result["error"] = QString("cannot start %1").arg(o.ffmpeg);
+        return result;
+    }
+
+    // 推流时间戳 out_time 在本机时钟上的起点：取各次进度中“到达时间 - out_time”的最小值
+    // （进度在写出数据之后才输出，最小值最接近真实对应关系；跳过 -re 开头的突发）
+    qint64 senderOffsetUs = INT64_MAX;
+    std::vector<FrameSample> frames;
+    frames.reserve(static_cast<size_t>(o.patternFps) * o.seconds + 64);
+    const qint64 limitUs = LatencyTracer::nowUs() + static_cast<qint64>(o.seconds + 15) * 1000000;
+    qint64 senderDoneUs = 0;
+    while (!decoder.isFinished() && LatencyTracer::nowUs() < limitUs)
+    {
+        if (sender.state() != QProcess::NotRunning)
+        {
+            sender.waitForReadyRead(5);
+        }
+        else
+        {
+            if (!senderDoneUs)
+            {
+                senderDoneUs = LatencyTracer::nowUs();
+            }
+            if (LatencyTracer::nowUs() - senderDoneUs > 1500000)
+            {
+                break;      // 推流结束后再等待在途数据
+            }
+            QThread::msleep(5);
+        }
+        while (sender.canReadLine())
+        {
+            const QByteArray line = sender.readLine().trimmed();
+            if (line.startsWith("out_time_us="))
+            {
+                bool ok = false;
+                const qint64 outUs = line.mid(12).toLongLong(&ok);
+                if (ok && outUs >= 1000000)
+                {
+                    senderOffsetUs = qMin(senderOffsetUs, LatencyTracer::nowUs() - outUs);
+                }
+            }
+        }
+        if (mailbox->hasNewFrame())
+        {
+            mailbox->latest();
+            const FrameTiming &timing = mailbox->latestTiming();
+            if (timing.ptsUs != AV_NOPTS_VALUE)
+            {
+                frames.push_back(FrameSample{timing.handoffUs, timing.ptsUs});
+            }
+        }
+    }
+    decoder.stop();
+    if (sender.state() != QProcess::NotRunning)
+    {
+        sender.kill();
+        sender.waitForFinished(3000);
+    }
+    const QString senderError = QString::fromLocal8Bit(sender.readAllStandardError()).trimmed();
+    if (setup.relay)
+    {
+        setup.relay->stop();
+    }
+
+    const VideoDecoder::Stats s = decoder.stats();
+    const PacketQueue::Stats q = decoder.packetQueueStats();
+    const qint64 expectedFrames = static_cast<qint64>(o.patternFps) * o.seconds;
+    result["url"] = setup.receiverUrl;
+    result["error"] = decodeError.isEmpty() ? senderError : decodeError;
+    result["frames_expected"] = expectedFrames;
+    result["frames_decoded"] = static_cast<qint64>(s.framesDecoded);
+    result["frames_displayed"] = static_cast<qint64>(frames.size());
+    result["frames_missing"] = qMax<qint64>(0, expectedFrames - static_cast<qint64>(s.framesDecoded));
+    result["packets_dropped"] = static_cast<qint64>(q.dropped);
+    result["open_ms"] = s.openMs;
+    result["probe_ms"] = s.probeMs;
+    result["read_stalls"] = static_cast<qint64>(s.readStalls);
+    if (frames.empty())
+    {
+        return result;
+    }
+
+    // 启动时间：从两端都已启动到第一帧写入信箱
+    result["startup_ms"] = (frames.front().handoffUs - qMax(senderStartUs, receiverStartUs)) / 1000.0;
+
+    // 稳态延迟：接收端第一帧即图案的第一帧（PTS 起点），跳过第一秒
+    if (senderOffsetUs != INT64_MAX)
+    {
+        const qint64 originUs = frames.front().ptsUs;
+        std::vector<double> latencies;
+        for (const FrameSample &f : frames)
+        {
+            if (f.ptsUs - originUs >= 1000000)
+            {
+                latencies.push_back((f.handoffUs - (senderOffsetUs + f.ptsUs - originUs)) / 1000.0);
+            }
+        }
+        result["latency_samples"] = static_cast<qint64>(latencies.size());
+        result["latency_p50_ms"] = percentile(latencies, 0.5);
+        result["latency_p95_ms"] = percentile(latencies, 0.95);
+        result["latency_max_ms"] = latencies.empty() ? 0 : latencies.back();
+    }
+
+    // 丢包恢复：相邻两帧间隔超过 3 个帧间隔记为一次卡顿
+    const qint64 freezeUs = 3 * 1000000 / o.patternFps;
+    qint64 freezes = 0;
+    qint64 maxGapUs = 0;
+    qint64 frozenUs = 0;
+    for (size_t i = 1; i < frames.size(); i++)
+    {
+        const qint64 gap = frames[i].handoffUs - frames[i - 1].handoffUs;
+        maxGapUs = qMax(maxGapUs, gap);
+        if (gap > freezeUs)
+        {
+            freezes++;
+            frozenUs += gap;
+        }
+    }
+    result["freezes"] = freezes;
+    result["max_freeze_ms"] = maxGapUs / 1000.0;
+    result["frozen_ms"] = frozenUs / 1000.0;
+
+    result["loss_emulated"] = setup.relay && o.lossPercent > 0;
+    if (setup.relay)
+    {
+        const LossyRelay::Stats r = setup.relay->stats();
+        result["relay_dropped"] = static_cast<qint64>(r.dropped);
+        result["relay_stalls"] = static_cast<qint64>(r.stalls);
+    }
+    return result;
+}
+}
+
+int runTransportBench(const QStringList &args)
+{
+    Options options;
+    if (!parseOptions(args, &options))
+    {
+        fprintf(stderr, "transport: invalid arguments\n");
+        return 2;
+    }
+    std::vector<StreamTransport::Type> types;
+    for (const QString &name : options.transports)
+    {
+        StreamTransport::Type type;
+        if (!StreamTransport::fromName(name, &type) || type == StreamTransport::Auto)
+        {
+            fprintf(stderr, "transport: unknown transport %s\n", qPrintable(name));
+            return 2;
+        }
+        types.push_back(type);
+    }
+
+    // 关键帧间隔 1 秒，丢包后最多 1 秒即可从下一个关键帧恢复
+    const QString pattern = QDir::temp().filePath(QString("player_bench_transport_%1x%2_%3fps_%4s.mkv")
+                                                      .arg(options.patternSize.width())
+                                                      .arg(options.patternSize.height())
+                                                      .arg(options.patternFps)
+                                                      .arg(options.seconds));
+    QString patternCodec;
+    QString error;
+    if (!writeTestPattern(pattern, options.patternSize.width(), options.patternSize.height(), options.patternFps,
+                          options.seconds, 1, &patternCodec, &error))
+    {
+        fprintf(stderr, "transport: cannot generate test pattern: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    QJsonArray results;
+    bool ok = true;
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        fprintf(stderr, "transport: %s\n", StreamTransport::name(types[i]));
+        const QJsonObject result = runTransport(types[i], options, pattern, options.basePort + 10 * static_cast<int>(i));
+        ok = ok && result["frames_displayed"].toInt() > 0;
+        results.append(result);
+    }
+
+    QJsonObject report;
+    report["pattern_codec"] = patternCodec;
+    report["pattern_width"] = options.patternSize.width();
+    report["pattern_height"] = options.patternSize.height();
+    report["fps"] = options.patternFps;
+    report["seconds"] = options.seconds;
+    report["loss_percent"] = options.lossPercent;
+    report["tcp_stall_ms"] = options.stallMs;
+    report["srt_latency_ms"] = options.srtLatencyMs;
+    report["results"] = results;
+    printf("%s\n", QJsonDocument(report).toJson(QJsonDocument::Indented).constData());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#ifndef TRANSPORTBENCH_H
+#define TRANSPORTBENCH_H
+
+#include <QStringList>
+
+/**
+ * @brief 比较各传输方式（RTMP、RTSP/TCP、RTSP/UDP、SRT、MPEG-TS/UDP）的启动时间、稳态延迟和丢包恢复
+ *
+ * 由本机的 ffmpeg 进程按实时速率推送合成测试图案，VideoDecoder 按对应传输方式接收并解码。
+ * 推流端的 -progress 输出给出“推流时间戳 -> 本机时钟”的对应关系，与解码帧的 PTS
+ * 和写入帧信箱的时间相减得到逐帧延迟（不含显示端）。
+ * 链路丢包由 LossyRelay 在回环上模拟：UDP 类传输真实丢包，TCP 类传输模拟重传停顿；
+ * RTSP/UDP 的 RTP 端口在协商时动态分配，无法经中继转发，不模拟丢包。
+ * 结果以 JSON 输出到标准输出。
+ */
+int runTransportBench(const QStringList &args);
+
+#endif // TRANSPORTBENCH_H
@@ -0,0 +1,163 @@
+#include "byte_ring.h"
+#include <QDeadlineTimer>
+#include <cstring>
+
+namespace
+{
+size_t roundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+ByteRing::ByteRing(size_t capacity)
+    : m_buffer(roundUpToPowerOfTwo(capacity > 0 ? capacity : 1)), m_mask(m_buffer.size() - 1)
+{
+}
+
+size_t ByteRing::available() const
+{
+    return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire);
+}
+
+size_t ByteRing::write(const uint8_t *data, size_t size)
+{
+    const size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    const size_t readPos = m_readPos.load(std::memory_order_acquire);
+    const size_t free = m_buffer.size() - (writePos - readPos);
+    const size_t count = size < free ? size : free;
+    if (count < size)
+    {
+        m_fullWrites.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // 最多分两段拷贝（绕回处）
+    const size_t offset = writePos & m_mask;
+    const size_t first = count < m_buffer.size() - offset ? count : m_buffer.size() - offset;
+    memcpy(m_buffer.data() + offset, data, first);
+    memcpy(m_buffer.data(), data + first, count - first);
+    m_writePos.store(writePos + count, std::memory_order_seq_cst);
+
+    const size_t fill = writePos + count - readPos;
+    if (fill > m_maxFill.load(std::memory_order_relaxed))
+    {
+        m_maxFill.store(fill, std::memory_order_relaxed);
+    }
+    wakeWaiters();
+    return count;
+}
+
+size_t ByteRing::peek(const uint8_t **data) const
+{
+    const size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    const size_t count = m_writePos.load(std::memory_order_acquire) - readPos;
+    const size_t offset = readPos & m_mask;
+    *data = m_buffer.data() + offset;
+    return count < m_buffer.size() - offset ? count : m_buffer.size() - offset;
+}
+
+void ByteRing::consume(size_t size)
+{
+    m_readPos.store(m_readPos.load(std::memory_order_relaxed) + size, std::memory_order_seq_cst);
+    wakeWaiters();
+}
+
+size_t ByteRing::read(uint8_t *data, size_t size)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        const uint8_t *chunk = nullptr;
+        size_t count = peek(&chunk);
+        if (count == 0)
+        {
+            break;
+        }
+        count = count < size - total ? count : size - total;
+        memcpy(data + total, chunk, count);
+        m_readPos.store(m_readPos.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+        total += count;
+    }
+    if (total)
+    {
+        wakeWaiters();
+    }
+    return total;
+}
+
+void ByteRing::wakeWaiters()
+{
+    // 位置更新与此处读取均为顺序一致，等待方登记后必能看到更新或收到唤醒
+    if (m_waiters.load(std::memory_order_seq_cst) > 0)
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_changed.wakeAll();
+    }
+}
+
+bool ByteRing::waitForData(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    QMutexLocker locker(&m_waitMutex);
+    bool ready = available() > 0 || isClosed();
+    while (!ready && !deadline.hasExpired())
+    {
+        m_changed.wait(&m_waitMutex, deadline);
+        ready = available() > 0 || isClosed();
+    }
+    m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return ready;
+}
+
+bool ByteRing::waitForSpace(size_t size, int timeoutMs)
+{
+    if (size > m_buffer.size())
+    {
+        size = m_buffer.size();
+    }
+    QDeadlineTimer deadline(timeoutMs);
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    QMutexLocker locker(&m_waitMutex);
+    bool ready = m_buffer.size() - available() >= size;
+    while (!ready && !deadline.hasExpired())
+    {
+        m_changed.wait(&m_waitMutex, deadline);
+        ready = m_buffer.size() - available() >= size;
+    }
+    m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return ready;
+}
+
+void ByteRing::close()
+{
+    m_closed.store(true, std::memory_order_seq_cst);
+    wakeWaiters();
+}
+
+void ByteRing::reset()
+{
+    m_readPos.store(m_writePos.load(std::memory_order_acquire), std::memory_order_seq_cst);
+    m_closed.store(false, std::memory_order_seq_cst);
+}
+
+ByteRing::Stats ByteRing::stats() const
+{
+    Stats s;
+    s.capacity = m_buffer.size();
+    s.fill = available();
+    s.maxFill = m_maxFill.load(std::memory_order_relaxed);
+    s.bytesWritten = m_writePos.load(std::memory_order_relaxed);
+    s.bytesRead = m_readPos.load(std::memory_order_relaxed);
+    s.fullWrites = m_fullWrites.load(std::memory_order_relaxed);
+    return s;
+}
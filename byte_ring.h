@@ -0,0 +1,109 @@
+#ifndef BYTERING_H
+#define BYTERING_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 单生产者单消费者的无锁字节环形缓冲
+ *
+ * 读写位置为单调递增的原子计数，容量取 2 的幂，读写各自只修改自己的位置，
+ * 数据路径不加锁。peek()/consume() 可直接访问缓冲区中连续的可读数据，
+ * 省去一次拷贝。只有在一端需要等待（缓冲为空或已满）时才用条件变量休眠，
+ * 另一端仅在确有等待者时才加锁唤醒。
+ */
+class ByteRing
+{
+public:
+    /**
+     * @brief 环形缓冲统计信息
+     */
+    struct Stats
+    {
+        size_t capacity = 0;        // 容量（字节）
+        size_t fill = 0;            // 当前可读字节数
+        size_t maxFill = 0;         // 历史最大可读字节数
+        quint64 bytesWritten = 0;   // 写入的总字节数
+        quint64 bytesRead = 0;      // 读出的总字节数
+        quint64 fullWrites = 0;     // 因缓冲已满而未能全部写入的次数
+    };
+
+    /**
+     * @param capacity 容量，向上取整为 2 的幂
+     */
+    explicit ByteRing(size_t capacity);
+
+    ByteRing(const ByteRing &) = delete;
+    ByteRing &operator=(const ByteRing &) = delete;
+
+    /**
+     * @brief 写入（仅限生产者），不阻塞
+     * @return 实际写入的字节数，缓冲剩余空间不足时小于 size
+     */
+    size_t write(const uint8_t *data, size_t size);
+
+    /**
+     * @brief 读出（仅限消费者），不阻塞
+     * @return 实际读出的字节数
+     */
+    size_t read(uint8_t *data, size_t size);
+
+    /**
+     * @brief 取得连续的可读数据（仅限消费者），数据在 consume() 之前有效
+     * @return 连续可读的字节数（绕回处之后的数据需再次 peek）
+     */
+    size_t peek(const uint8_t **data) const;
+    void consume(size_t size);
+
+    /**
+     * @brief 等待有数据可读或已关闭（仅限消费者）
+     * @return 有数据或已关闭时返回 true，超时返回 false
+     */
+    bool waitForData(int timeoutMs);
+
+    /**
+     * @brief 等待至少 size 字节空闲空间（仅限生产者）
+     */
+    bool waitForSpace(size_t size, int timeoutMs);
+
+    /**
+     * @brief 标记输入结束（仅限生产者），读完剩余数据后即为流结束
+     */
+    void close();
+
+    /**
+     * @brief 清空数据并重新打开（两端都空闲时调用）
+     */
+    void reset();
+
+    bool isClosed() const { return m_closed.load(std::memory_order_acquire); }
+    size_t available() const;
+    size_t capacity() const { return m_buffer.size(); }
+
+    Stats stats() const;
+
+private:
+    void wakeWaiters();
+
+    std::vector<uint8_t> m_buffer;
+    const size_t m_mask;
+
+    // 读写位置分处不同缓存行，避免两端互相失效
+    alignas(64) std::atomic<size_t> m_writePos{0};
+    alignas(64) std::atomic<size_t> m_readPos{0};
+    std::atomic<bool> m_closed{false};
+
+    // 仅用于休眠等待
+    std::atomic<int> m_waiters{0};
+    QMutex m_waitMutex;
+    QWaitCondition m_changed;
+
+    std::atomic<size_t> m_maxFill{0};
+    std::atomic<quint64> m_fullWrites{0};
+};
+
+#endif // BYTERING_H
@@ -0,0 +1,179 @@
+#include "catch_up_controller.h"
+
+extern "C"
+{
+#include <libavutil/avutil.h>
+}
+
+CatchUpController::CatchUpController(int budgetMs)
+    : m_budgetUs(static_cast<qint64>(budgetMs) * 1000)
+{
+}
+
+void CatchUpController::reset()
+{
+    if (m_sentWhileSkipping > 0)
+    {
+        m_nonRefDiscarded.fetch_add(static_cast<quint64>(m_sentWhileSkipping), std::memory_order_relaxed);
+    }
+    m_sentWhileSkipping = 0;
+    m_hasReference = false;
+    m_level = LevelNormal;
+    m_lastFlushUs = 0;
+    m_lastConvertUs = 0;
+    m_statLevel.store(LevelNormal, std::memory_order_relaxed);
+    m_lagUs.store(0, std::memory_order_relaxed);
+}
+
+CatchUpController::Level CatchUpController::update(qint64 ptsUs, qint64 nowUs)
+{
+    if (m_budgetUs <= 0 || ptsUs == AV_NOPTS_VALUE)
+    {
+        return m_level == LevelFlush ? LevelSkipConvert : m_level;
+    }
+
+    const qint64 offset = nowUs - ptsUs;
+    if (!m_hasReference || qAbs(offset - m_lastOffset) > kDiscontinuityUs)
+    {
+        // 首个包或时间戳跳变（推流端重启等）：以当前包重新建立参考
+        m_hasReference = true;
+        m_windowStartUs = nowUs;
+        m_windowMinOffset = offset;
+        m_prevWindowMinOffset = offset;
+    }
+    m_lastOffset = offset;
+
+    // 参考取近两个窗口内的最小偏移，旧窗口过期后参考可以缓慢上移以跟随时钟漂移
+    if (nowUs - m_windowStartUs >= kWindowUs)
+    {
+        m_prevWindowMinOffset = m_windowMinOffset;
+        m_windowMinOffset = offset;
+        m_windowStartUs = nowUs;
+    }
+    m_windowMinOffset = qMin(m_windowMinOffset, offset);
+    const qint64 lagUs = offset - qMin(m_windowMinOffset, m_prevWindowMinOffset);
+
+    m_lagUs.store(lagUs, std::memory_order_relaxed);
+    if (lagUs > m_maxLagUs.load(std::memory_order_relaxed))
+    {
+        m_maxLagUs.store(lagUs, std::memory_order_relaxed);
+    }
+
+    Level target = LevelNormal;
+    if (lagUs > kFlushMultiple * m_budgetUs)
+    {
+        target = LevelFlush;
+    }
+    else if (lagUs > kSkipConvertMultiple * m_budgetUs)
+    {
+        target = LevelSkipConvert;
+    }
+    else if (lagUs > m_budgetUs)
+    {
+        target = LevelSkipNonRef;
+    }
+
+    // 清空后新的关键帧到达前落后时间不会立刻下降，冷却期内不重复清空
+    if (target == LevelFlush && m_lastFlushUs && nowUs - m_lastFlushUs < kFlushMultiple * m_budgetUs)
+    {
+        target = LevelSkipConvert;
+    }
+
+    Level level = m_level;
+    if (target > level)
+    {
+        level = target;
+        m_escalations.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (lagUs < m_budgetUs / 2)
+    {
+        // 回落到预算一半以下才恢复，避免在阈值附近来回切换
+        level = LevelNormal;
+    }
+
+    if (level == LevelNormal && m_level != LevelNormal && m_sentWhileSkipping > 0)
+    {
+        m_nonRefDiscarded.fetch_add(static_cast<quint64>(m_sentWhileSkipping), std::memory_order_relaxed);
+    }
+    if (level == LevelNormal)
+    {
+        m_sentWhileSkipping = 0;
+    }
+
+    if (level == LevelFlush)
+    {
+        m_lastFlushUs = nowUs;
+        m_level = LevelSkipConvert;
+    }
+    else
+    {
+        m_level = level;
+    }
+    m_statLevel.store(level, std::memory_order_relaxed);
+    return level;
+}
+
+bool CatchUpController::shouldConvert(bool newerPending, qint64 nowUs)
+{
+    // 没有更新的帧在排队，或距上次显示已太久时仍然转换，保证画面不会停住
+    if (m_level < LevelSkipConvert || !newerPending || nowUs - m_lastConvertUs >= kMinShowIntervalUs)
+    {
+        m_lastConvertUs = nowUs;
+        return true;
+    }
+    m_conversionsSkipped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CatchUpController::countPacketSent()
+{
+    if (m_level >= LevelSkipNonRef)
+    {
+        m_sentWhileSkipping++;
+    }
+}
+
+void CatchUpController::countFrameDecoded()
+{
+    if (m_level >= LevelSkipNonRef)
+    {
+        m_sentWhileSkipping--;
+    }
+}
+
+void CatchUpController::countFlush(int packetsDropped)
+{
+    m_flushes.fetch_add(1, std::memory_order_relaxed);
+    m_packetsFlushed.fetch_add(static_cast<quint64>(qMax(0, packetsDropped)), std::memory_order_relaxed);
+}
+
+CatchUpController::Stats CatchUpController::stats() const
+{
+    Stats s;
+    s.level = static_cast<Level>(m_statLevel.load(std::memory_order_relaxed));
+    s.lagMs = m_lagUs.load(std::memory_order_relaxed) / 1000.0;
+    s.maxLagMs = m_maxLagUs.load(std::memory_order_relaxed) / 1000.0;
+    s.escalations = m_escalations.load(std::memory_order_relaxed);
+    s.nonRefDiscarded = m_nonRefDiscarded.load(std::memory_order_relaxed);
+    s.conversionsSkipped = m_conversionsSkipped.load(std::memory_order_relaxed);
+    s.flushes = m_flushes.load(std::memory_order_relaxed);
+    s.packetsFlushed = m_packetsFlushed.load(std::memory_order_relaxed);
+    return s;
+}
+
+const char *CatchUpController::levelName(Level level)
+{
+    switch (level)
+    {
+    case LevelNormal:
+        return "normal";
+    case LevelSkipNonRef:
+        return "skip-nonref";
+    case LevelSkipConvert:
+        return "skip-convert";
+    case LevelFlush:
+        return "flush";
+    default:
+        return "unknown";
+    }
+}
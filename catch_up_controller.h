@@ -0,0 +1,120 @@
+#ifndef CATCHUPCONTROLLER_H
+#define CATCHUPCONTROLLER_H
+
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief 直播追帧控制器：落后于直播端时逐级减少解码工作
+ *
+ * 以“本地单调时钟 - 包的时间戳”作为偏移，取近两个窗口内的最小偏移作为参考
+ * （即包到达最及时的情况，同时可跟随两端时钟的缓慢漂移），
+ * 当前偏移与参考之差即为落后于直播端的时间。超过预算后按倍数逐级升级：
+ *   1 倍：解码器丢弃非参考帧（skip_frame = AVDISCARD_NONREF）；
+ *   2 倍：后面还有包排队时跳过颜色转换（这些帧不会被显示）；
+ *   4 倍：清空到最新的关键帧。
+ * 落后时间回落到预算一半以下时恢复正常。仅限解码线程调用，统计信息可在任意线程读取。
+ * 包队列按时长丢弃的上限由 VideoDecoder 取为不低于清空阈值，在以上各级之后才生效。
+ */
+class CatchUpController
+{
+public:
+    static constexpr int kSkipConvertMultiple = 2;  // 落后超过预算的该倍数时跳过转换
+    static constexpr int kFlushMultiple = 4;        // 落后超过预算的该倍数时清空到关键帧
+
+    enum Level
+    {
+        LevelNormal,        // 正常解码
+        LevelSkipNonRef,    // 丢弃非参考帧
+        LevelSkipConvert,   // 另外跳过不会被显示的帧的颜色转换
+        LevelFlush          // 清空到关键帧
+    };
+
+    /**
+     * @brief 追帧统计信息
+     */
+    struct Stats
+    {
+        Level level = LevelNormal;      // 当前级别
+        double lagMs = 0;               // 最近一次测得的落后时间
+        double maxLagMs = 0;            // 最大落后时间
+        quint64 escalations = 0;        // 级别升高的次数
+        quint64 nonRefDiscarded = 0;    // 丢弃非参考帧期间解码器少输出的帧数（估计值）
+        quint64 conversionsSkipped = 0; // 跳过颜色转换的帧数
+        quint64 flushes = 0;            // 清空到关键帧的次数
+        quint64 packetsFlushed = 0;     // 因清空而丢弃的包数
+    };
+
+    /**
+     * @param budgetMs 允许的落后时间，<= 0 表示关闭追帧
+     */
+    explicit CatchUpController(int budgetMs);
+
+    CatchUpController(const CatchUpController &) = delete;
+    CatchUpController &operator=(const CatchUpController &) = delete;
+
+    /**
+     * @brief 新的流开始前调用，清除时钟参考（统计信息保留）
+     */
+    void reset();
+
+    /**
+     * @brief 每个包送入解码器前调用，返回应采用的级别
+     * @param ptsUs 包的解码时间戳（微秒），AV_NOPTS_VALUE 时沿用上一次的判断
+     * @param nowUs 当前单调时钟（微秒）
+     * @return LevelFlush 只返回一次，调用方清空后在冷却期内不会再次要求清空
+     */
+    Level update(qint64 ptsUs, qint64 nowUs);
+
+    /**
+     * @brief 解码出一帧后调用，判断是否需要转换并显示
+     * @param newerPending 是否已有更新的包在排队
+     */
+    bool shouldConvert(bool newerPending, qint64 nowUs);
+
+    /**
+     * @brief 记录送入解码器的包数和解码输出的帧数，用于估计丢弃的非参考帧
+     */
+    void countPacketSent();
+    void countFrameDecoded();
+
+    /**
+     * @brief 记录一次清空及丢弃的包数
+     */
+    void countFlush(int packetsDropped);
+
+    Level level() const { return m_level; }
+    Stats stats() const;
+
+    static const char *levelName(Level level);
+
+private:
+    static constexpr qint64 kWindowUs = 10 * 1000000;       // 参考偏移的窗口长度
+    static constexpr qint64 kDiscontinuityUs = 10 * 1000000; // 偏移跳变超过该值视为时间戳不连续
+    static constexpr qint64 kMinShowIntervalUs = 200000;     // 跳过转换时至少每隔该时间显示一帧
+
+    const qint64 m_budgetUs;
+
+    // 时钟参考（解码线程独占）
+    bool m_hasReference = false;
+    qint64 m_windowStartUs = 0;
+    qint64 m_windowMinOffset = 0;       // 当前窗口内的最小偏移
+    qint64 m_prevWindowMinOffset = 0;   // 上一窗口内的最小偏移
+    qint64 m_lastOffset = 0;
+    Level m_level = LevelNormal;
+    qint64 m_lastFlushUs = 0;
+    qint64 m_lastConvertUs = 0;
+    qint64 m_sentWhileSkipping = 0;     // 丢弃非参考帧期间送入的包数减去输出的帧数
+
+    // 统计信息
+    std::atomic<int> m_statLevel{LevelNormal};
+    std::atomic<qint64> m_lagUs{0};
+    std::atomic<qint64> m_maxLagUs{0};
+    std::atomic<quint64> m_escalations{0};
+    std::atomic<quint64> m_nonRefDiscarded{0};
+    std::atomic<quint64> m_conversionsSkipped{0};
+    std::atomic<quint64> m_flushes{0};
+    std::atomic<quint64> m_packetsFlushed{0};
+};
+
+#endif // CATCHUPCONTROLLER_H
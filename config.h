@@ -2,6 +2,7 @@
 #define CONFIG_H
 
 #include <QString>
+#include <QStringList>
 
 #define  CLOSE_MQTT_ID      "000"
 #define  CAN_POS_ID         "001"
@@ -18,6 +19,68 @@ struct AppConfig
 {
     // 编码参数
     const QString RTMP_URL = "rtmp://111.231.8.200:9090/live/test";
+    // 多路摄像头地址，第一路为主摄像头；增加毛刷、后置摄像头时在此追加
+    const QStringList CAMERA_URLS = {RTMP_URL};
+    // 传输方式：auto（按地址前缀）/ rtmp / rtsp-tcp / rtsp-udp / srt / udp（MPEG-TS）
+    // 有丢包的链路上 RTMP（TCP）重传会阻塞后续数据，可改用 srt 或 rtsp-udp
+    const QString STREAM_TRANSPORT = "auto";
+    const int SRT_LATENCY_MS = 120;             // SRT 等待重传的时间，约为链路 RTT 的 3~4 倍
+    const int UDP_BUFFER_KB = 2048;             // UDP 套接字接收缓冲（RTSP/UDP、MPEG-TS/UDP）
+    const int RTSP_REORDER_DELAY_MS = 100;      // RTSP/UDP 等待乱序包的最长时间
+    const QString MOSAIC_UNFOCUSED_RATE = "keyframes";  // 非焦点画面的解码帧率：full / nonref / keyframes
+    const int MOSAIC_UNFOCUSED_THREADS = 1;             // 非焦点画面的解码线程数
+
+    // 解码参数
+    const int FRAME_POOL_SIZE = 6;      // 输出帧缓冲池容量（解码中 + 队列中 + 显示中）
+    const int PACKET_QUEUE_SIZE = 120;  // 读取线程与解码线程之间最多排队的压缩包数
+    // 积压的处理顺序：落后超过 CATCHUP_BUDGET_MS 的 1/2/4 倍时依次丢非参考帧、跳过转换、清空到关键帧；
+    // 包队列的时长上限实际取 max(LATENCY_BUDGET_MS, 4 × CATCHUP_BUDGET_MS)，只在追帧之后兜底
+    const int LATENCY_BUDGET_MS = 500;  // 排队内容超过该时长时丢弃到下一个关键帧（追帧关闭时按此值）
+    const int CATCHUP_BUDGET_MS = 300;  // 落后直播端超过该时长时开始追帧，0 表示关闭
+    const bool STREAM_PROBE_CACHE = true;  // 缓存流参数，启动时跳过 avformat_find_stream_info
+    const int RECONNECT_MIN_MS = 250;   // 断线重连的初始等待时间，之后每次翻倍
+    const int RECONNECT_MAX_MS = 8000;  // 断线重连的最长等待时间
+    const int OPEN_TIMEOUT_MS = 5000;   // 打开输入（连接、握手）的超时时间
+    const int PROBE_TIMEOUT_MS = 5000;  // 获取流参数的超时时间
+    const int READ_STALL_MS = 3000;     // 超过该时间读不到数据视为断流
+    const int CONVERT_THREADS = 0;      // 颜色转换工作线程数，0 表示按 CPU 核数自动确定
+    const int CONVERT_BAND_MIN_PIXELS = 1920 * 1080;  // 输入像素数达到该值才分段并行转换
+    const int SWS_CACHE_SIZE = 4;       // 保留最近使用的几种转换配置（分辨率、格式、显示尺寸）的 sws 上下文
+    const QString DECODER_PROFILE = "low-latency";  // 解码多线程配置档：low-latency / balanced / throughput
+    const int DECODER_THREADS = 0;      // 解码线程数，0 表示按配置档和 CPU 核数自动确定
+    const int LAZY_IDLE_SECONDS = 30;   // 画面不可见超过该时长后只解码关键帧，0 表示一直全部解码
+    const bool JITTER_BUFFER_ENABLED = true;    // 按时间戳定时显示，吸收网络到达抖动
+    const int JITTER_MIN_DELAY_MS = 20;         // 抖动缓冲的最小目标延迟
+    const int JITTER_MAX_DELAY_MS = 200;        // 抖动缓冲的延迟上限，抖动再大也不超过该值
+    const bool AUDIO_ENABLED = true;            // 播放主摄像头的声音（电机、毛刷声音）
+    const int AUDIO_DEVICE_BUFFER_MS = 40;      // 声卡缓冲时长，越小延迟越低但越容易欠载
+    const int AUDIO_RING_MS = 250;              // 解码端与声卡之间环形缓冲的容量
+    const bool KEYFRAME_REQUEST_ENABLED = true;     // 解码损坏（丢包）时经 MQTT 请求摄像头立即发送关键帧
+    const int KEYFRAME_REQUEST_INTERVAL_MS = 1000;  // 请求的最小间隔，仍未恢复时按该间隔重发
+    const int KEYFRAME_PUBLISH_MAX = 4;             // 关键帧请求独立限速：每个 MQTT 限速窗口最多发布的条数，不占用操作命令的额度
+    const bool CORRUPTION_FREEZE = true;            // 损坏期间停在最后一帧完好画面，不显示花屏
+    const int CORRUPTION_FREEZE_MAX_MS = 3000;      // 超过该时长仍无关键帧（摄像头未响应）时恢复显示
+
+    // 录像参数（直接封装压缩流，不转码）
+    const bool RECORD_ENABLED = false;
+    const QString RECORD_DIR = "recordings";    // 相对路径时相对于程序工作目录
+    const QString RECORD_FORMAT = "mp4";        // 容器格式：mp4 / mkv / ts
+    const int RECORD_SEGMENT_SECONDS = 300;     // 分段时长，在该时长后的第一个关键帧处切换文件
+    const int RECORD_QUEUE_MB = 32;             // 写盘队列上限，超过时丢包直到下一个关键帧
+    const int RECORD_IO_BUFFER_KB = 1024;       // 写缓冲区大小，每次写盘为整块数据
+
+    // 预录缓冲（保留最近一段压缩流，按 Ctrl+E 导出为片段）
+    const bool PREROLL_ENABLED = true;
+    const int PREROLL_SECONDS = 60;             // 缓冲时长上限
+    const int PREROLL_BUFFER_MB = 32;           // 每路缓冲内存上限，码率突增时按整个 GOP 淘汰
+    const QString CLIP_DIR = "clips";           // 导出片段的目录，格式同 RECORD_FORMAT
+
+    // 截图（Ctrl+S 单张，Ctrl+Shift+S 连拍，取焦点画面）
+    const QString SNAPSHOT_DIR = "snapshots";
+    const QString SNAPSHOT_FORMAT = "jpg";      // jpg / png
+    const int SNAPSHOT_QUALITY = 90;            // JPEG 质量
+    const int SNAPSHOT_BURST_COUNT = 5;         // 连拍张数
+    const int SNAPSHOT_BURST_INTERVAL_MS = 200; // 连拍间隔
 
     // MQTT 服务器的相关配置
     const QString SERVER_ADDRESS = "tcp://iot-06z00c19vf5ynvs.mqtt.iothub.aliyuncs.com:1883";
@@ -0,0 +1,106 @@
+#include "convert_worker_pool.h"
+#include <QThread>
+
+ConvertWorkerPool::ConvertWorkerPool(int threadCount)
+{
+    if (threadCount <= 0)
+    {
+        // 解码本身也占用若干核，转换只取一半
+        threadCount = qMax(1, QThread::idealThreadCount() / 2);
+    }
+    for (int i = 0; i < threadCount; i++)
+    {
+        m_threads.emplace_back(&ConvertWorkerPool::workerLoop, this);
+    }
+}
+
+ConvertWorkerPool::~ConvertWorkerPool()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_hasWork.wakeAll();
+    }
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ConvertWorkerPool::run(int count, const std::function<void(int)> &task)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (count == 1 || m_threads.empty())
+    {
+        for (int i = 0; i < count; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->task = &task;
+    batch->count = count;
+    batch->remaining.store(count);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_batches.push_back(batch);
+        m_hasWork.wakeAll();
+    }
+
+    // 只等待完成计数器归零
+    QMutexLocker locker(&batch->doneMutex);
+    while (batch->remaining.load(std::memory_order_acquire) > 0)
+    {
+        batch->done.wait(&batch->doneMutex);
+    }
+}
+
+void ConvertWorkerPool::workerLoop()
+{
+    for (;;)
+    {
+        std::shared_ptr<Batch> batch;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stopping && m_batches.empty())
+            {
+                m_hasWork.wait(&m_mutex);
+            }
+            if (m_stopping)
+            {
+                return;
+            }
+            batch = m_batches.front();
+            // 该批次的任务已全部被领取时移出队列，其余线程转向下一批
+            if (batch->next.load(std::memory_order_relaxed) >= batch->count)
+            {
+                m_batches.pop_front();
+                continue;
+            }
+        }
+        execute(batch.get());
+    }
+}
+
+void ConvertWorkerPool::execute(Batch *batch)
+{
+    for (;;)
+    {
+        const int index = batch->next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= batch->count)
+        {
+            return;
+        }
+        (*batch->task)(index);
+        if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            QMutexLocker locker(&batch->doneMutex);
+            batch->done.wakeAll();
+        }
+    }
+}
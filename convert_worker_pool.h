@@ -0,0 +1,60 @@
+#ifndef CONVERTWORKERPOOL_H
+#define CONVERTWORKERPOOL_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 颜色转换用的常驻工作线程池
+ *
+ * 调用方把一帧拆成若干行段，run() 把各段分发给工作线程并行执行，
+ * 调用线程只在完成计数器（latch）上等待。多个解码器可共享同一个线程池，
+ * 各自提交的批次按到达顺序处理。
+ */
+class ConvertWorkerPool
+{
+public:
+    /**
+     * @param threadCount 工作线程数，<= 0 时按 CPU 核数自动确定
+     */
+    explicit ConvertWorkerPool(int threadCount = 0);
+    ~ConvertWorkerPool();
+
+    ConvertWorkerPool(const ConvertWorkerPool &) = delete;
+    ConvertWorkerPool &operator=(const ConvertWorkerPool &) = delete;
+
+    int threadCount() const { return static_cast<int>(m_threads.size()); }
+
+    /**
+     * @brief 并行执行 task(0) ... task(count - 1)，全部完成后返回
+     */
+    void run(int count, const std::function<void(int)> &task);
+
+private:
+    struct Batch
+    {
+        const std::function<void(int)> *task = nullptr;
+        int count = 0;
+        std::atomic<int> next{0};       // 下一个待领取的任务下标
+        std::atomic<int> remaining{0};  // 未完成的任务数（完成计数器）
+        QMutex doneMutex;
+        QWaitCondition done;
+    };
+
+    void workerLoop();
+    static void execute(Batch *batch);
+
+    std::vector<std::thread> m_threads;
+    QMutex m_mutex;
+    QWaitCondition m_hasWork;
+    std::deque<std::shared_ptr<Batch>> m_batches;
+    bool m_stopping = false;
+};
+
+#endif // CONVERTWORKERPOOL_H
@@ -0,0 +1,69 @@
+#include "decoder_profile.h"
+#include <QThread>
+
+void DecoderProfile::apply(AVCodecContext *ctx, Profile profile, int threadCount)
+{
+    const int cores = threadCount > 0 ? threadCount : QThread::idealThreadCount();
+    switch (profile)
+    {
+    case LowLatency:
+        ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+        ctx->thread_type = FF_THREAD_SLICE;
+        ctx->thread_count = cores;
+        break;
+    case Balanced:
+        ctx->flags &= ~AV_CODEC_FLAG_LOW_DELAY;
+        ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+        ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        ctx->thread_count = threadCount > 0 ? threadCount : 2;
+        break;
+    case Throughput:
+    default:
+        ctx->flags &= ~AV_CODEC_FLAG_LOW_DELAY;
+        ctx->thread_type = FF_THREAD_FRAME;
+        ctx->thread_count = cores;
+        break;
+    }
+}
+
+const char *DecoderProfile::name(Profile profile)
+{
+    switch (profile)
+    {
+    case LowLatency:
+        return "low-latency";
+    case Balanced:
+        return "balanced";
+    case Throughput:
+        return "throughput";
+    default:
+        return "unknown";
+    }
+}
+
+bool DecoderProfile::fromName(const QString &name, Profile *profile)
+{
+    for (int i = 0; i < ProfileCount; i++)
+    {
+        if (name == QLatin1String(DecoderProfile::name(static_cast<Profile>(i))))
+        {
+            *profile = static_cast<Profile>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *DecoderProfile::activeThreadTypeName(const AVCodecContext *ctx)
+{
+    if (ctx->active_thread_type & FF_THREAD_FRAME)
+    {
+        return "frame";
+    }
+    if (ctx->active_thread_type & FF_THREAD_SLICE)
+    {
+        return "slice";
+    }
+    return "none";
+}
@@ -0,0 +1,48 @@
+#ifndef DECODERPROFILE_H
+#define DECODERPROFILE_H
+
+#include <QString>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 解码器多线程配置档
+ *
+ * 帧级多线程每增加一个线程约增加一帧解码延迟，适合录像回放等看重吞吐的场景；
+ * 遥控操作需要最低延迟，使用片级多线程（对单 slice 码流退化为单线程）。
+ * 注意 AV_CODEC_FLAG_LOW_DELAY 会令 FFmpeg 关闭帧级多线程，因此只有低延迟档设置该标志。
+ */
+class DecoderProfile
+{
+public:
+    enum Profile
+    {
+        LowLatency,     // 片级多线程 + LOW_DELAY，不引入额外帧延迟
+        Balanced,       // 2 线程帧级多线程，约增加一帧延迟
+        Throughput,     // 按 CPU 核数的帧级多线程，吞吐最高、延迟最大
+        ProfileCount
+    };
+
+    /**
+     * @brief 在 avcodec_open2 之前按配置档设置解码上下文
+     * @param threadCount 线程数，<= 0 时按 CPU 核数自动确定（平衡档固定为 2）
+     */
+    static void apply(AVCodecContext *ctx, Profile profile, int threadCount = 0);
+
+    static const char *name(Profile profile);
+
+    /**
+     * @brief 按名称（low-latency / balanced / throughput）解析配置档
+     */
+    static bool fromName(const QString &name, Profile *profile);
+
+    /**
+     * @brief 解码器打开后实际生效的多线程方式（frame / slice / none）
+     */
+    static const char *activeThreadTypeName(const AVCodecContext *ctx);
+};
+
+#endif // DECODERPROFILE_H
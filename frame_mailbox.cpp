@@ -0,0 +1,76 @@
+#include "frame_mailbox.h"
+
+qint64 FrameMailbox::publish(const QImage &frame, const FrameTiming &timing)
+{
+    m_slots[m_back] = frame;
+    m_timings[m_back] = timing;
+    // 交换之后槽归读端所有，交接时刻须在交换之前写入
+    const qint64 handoffUs = LatencyTracer::nowUs();
+    m_timings[m_back].handoffUs = handoffUs;
+    unsigned old = m_middle.exchange(m_back | kDirty, std::memory_order_acq_rel);
+    m_back = old & kIndexMask;
+    // 交换回来的槽里仍持有旧帧的引用，立即释放以便缓冲区尽早归还缓冲池
+    m_slots[m_back] = QImage();
+
+    m_published.fetch_add(1, std::memory_order_relaxed);
+    if (old & kDirty)
+    {
+        m_superseded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!m_notifyPending.exchange(true, std::memory_order_acq_rel))
+    {
+        QMutexLocker locker(&m_notifierMutex);
+        if (m_notifier)
+        {
+            m_notifier();
+        }
+    }
+    return handoffUs;
+}
+
+void FrameMailbox::setNotifier(std::function<void()> notifier)
+{
+    QMutexLocker locker(&m_notifierMutex);
+    m_notifier = std::move(notifier);
+}
+
+const QImage &FrameMailbox::latest()
+{
+    // 先清除通知标记，之后到达的帧会再次触发通知，不会漏掉
+    m_notifyPending.store(false, std::memory_order_release);
+    if (m_middle.load(std::memory_order_acquire) & kDirty)
+    {
+        unsigned old = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = old & kIndexMask;
+        m_consumed.fetch_add(1, std::memory_order_relaxed);
+    }
+    return m_slots[m_front];
+}
+
+void FrameMailbox::setTargetSize(const QSize &size)
+{
+    const quint64 packed = size.isValid()
+                               ? (quint64(quint32(size.width())) << 32) | quint32(size.height())
+                               : 0;
+    m_targetSize.store(packed, std::memory_order_relaxed);
+}
+
+QSize FrameMailbox::targetSize() const
+{
+    const quint64 packed = m_targetSize.load(std::memory_order_relaxed);
+    if (!packed)
+    {
+        return QSize();
+    }
+    return QSize(int(packed >> 32), int(packed & 0xFFFFFFFFu));
+}
+
+FrameMailbox::Stats FrameMailbox::stats() const
+{
+    Stats s;
+    s.published = m_published.load(std::memory_order_relaxed);
+    s.superseded = m_superseded.load(std::memory_order_relaxed);
+    s.consumed = m_consumed.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,109 @@
+#ifndef FRAMEMAILBOX_H
+#define FRAMEMAILBOX_H
+
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <atomic>
+#include <functional>
+#include "latency_tracer.h"
+
+/**
+ * @brief 解码线程与显示控件之间的单槽“最新帧优先”信箱
+ *
+ * 内部为三缓冲：写端（解码线程）与读端（界面线程）各自独占一个槽，
+ * 第三个槽用于交换，两端通过一次原子交换完成交接，全程无锁。
+ * 读端来不及取走的旧帧会被新帧直接覆盖，因此显示延迟最多一帧，
+ * 不会因界面线程阻塞而在事件队列中堆积帧。
+ */
+class FrameMailbox
+{
+public:
+    /**
+     * @brief 信箱统计信息
+     */
+    struct Stats
+    {
+        quint64 published = 0;      // 写入的帧数
+        quint64 superseded = 0;     // 未被读取即被新帧覆盖的帧数
+        quint64 consumed = 0;       // 被读端取走的帧数
+    };
+
+    FrameMailbox() = default;
+    FrameMailbox(const FrameMailbox &) = delete;
+    FrameMailbox &operator=(const FrameMailbox &) = delete;
+
+    /**
+     * @brief 设置新帧到达时的通知回调（例如请求重绘）
+     *
+     * 回调只在读端取走上一帧之后才会再次触发，多次写入会合并为一次通知。
+     * 回调在写线程中持锁调用，可在任意线程设置或清除：返回后旧回调既不在执行中、也不会再被调用，
+     * 因此回调的接收者析构前传入空回调即可。
+     */
+    void setNotifier(std::function<void()> notifier);
+
+    /**
+     * @brief 写入最新帧（仅限单一写线程调用）
+     * @param timing 该帧在解码端各阶段的时间戳，随帧一起交给读端
+     * @return 交接时刻（帧对读端可见之前的最后一刻），同时写入交给读端的 timing.handoffUs
+     */
+    qint64 publish(const QImage &frame, const FrameTiming &timing = FrameTiming());
+
+    /**
+     * @brief 取得最新帧（仅限单一读线程调用）
+     * @return 若有新帧则切换到新帧，否则返回上一次取得的帧
+     */
+    const QImage &latest();
+
+    /**
+     * @brief latest() 所返回帧的时间戳（仅限读线程调用）
+     */
+    const FrameTiming &latestTiming() const { return m_timings[m_front]; }
+
+    /**
+     * @brief 自上次 latest() 以来是否有新帧写入
+     */
+    bool hasNewFrame() const { return m_middle.load(std::memory_order_acquire) & kDirty; }
+
+    /**
+     * @brief 设置显示端期望的帧尺寸（设备像素），写端据此直接缩放到该尺寸
+     */
+    void setTargetSize(const QSize &size);
+
+    /**
+     * @brief 显示端期望的帧尺寸，未设置时为无效尺寸
+     */
+    QSize targetSize() const;
+
+    /**
+     * @brief 设置显示端当前是否可见（任意线程调用）
+     *
+     * 不可见时写端只解码不转换，也不写入信箱。
+     */
+    void setVisible(bool visible) { m_visible.store(visible, std::memory_order_relaxed); }
+    bool isVisible() const { return m_visible.load(std::memory_order_relaxed); }
+
+    Stats stats() const;
+
+private:
+    static constexpr unsigned kDirty = 0x4;     // 交换槽中存放的是未读的新帧
+    static constexpr unsigned kIndexMask = 0x3;
+
+    QImage m_slots[3];
+    FrameTiming m_timings[3];
+    unsigned m_back = 0;                        // 写端独占
+    unsigned m_front = 1;                       // 读端独占
+    std::atomic<unsigned> m_middle{2};          // 交换槽下标 | kDirty
+
+    QMutex m_notifierMutex;                     // 保护 m_notifier 的设置与调用
+    std::function<void()> m_notifier;
+    std::atomic<bool> m_notifyPending{false};
+    std::atomic<quint64> m_targetSize{0};       // 宽 << 32 | 高
+    std::atomic<bool> m_visible{true};
+
+    std::atomic<quint64> m_published{0};
+    std::atomic<quint64> m_superseded{0};
+    std::atomic<quint64> m_consumed{0};
+};
+
+#endif // FRAMEMAILBOX_H
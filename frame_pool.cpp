@@ -0,0 +1,145 @@
+#include "frame_pool.h"
+#include <QDebug>
+
+extern "C"
+{
+#include <libavutil/mem.h>
+}
+
+std::shared_ptr<FramePool> FramePool::create(int capacity, int bufferSize)
+{
+    // 构造函数私有，不能使用 make_shared
+    return std::shared_ptr<FramePool>(new FramePool(capacity, bufferSize));
+}
+
+FramePool::FramePool(int capacity, int bufferSize)
+    : m_slots(static_cast<size_t>(capacity)), m_bufferSize(bufferSize)
+{
+    for (uint32_t i = 0; i < m_slots.size(); i++)
+    {
+        // av_malloc 按 CPU 的 SIMD 宽度对齐，满足 sws_scale 的对齐要求
+        m_slots[i].data = static_cast<uint8_t *>(av_malloc(static_cast<size_t>(bufferSize)));
+        m_slots[i].pool = this;
+        if (!m_slots[i].data)
+        {
+            qWarning() << "[FRAMEPOOL] Failed to allocate buffer" << i;
+            continue;
+        }
+        push(i);
+    }
+}
+
+FramePool::~FramePool()
+{
+    // 能走到析构说明所有借出的缓冲区都已归还（每个借出的缓冲区都持有 keepAlive）
+    for (Slot &slot : m_slots)
+    {
+        av_free(slot.data);
+    }
+}
+
+uint32_t FramePool::pop()
+{
+    uint64_t head = m_freeHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+        uint32_t index = static_cast<uint32_t>(head);
+        if (index == kNil)
+        {
+            return kNil;
+        }
+        uint32_t next = m_slots[index].next.load(std::memory_order_relaxed);
+        uint64_t newHead = ((head >> 32) + 1) << 32 | next;
+        if (m_freeHead.compare_exchange_weak(head, newHead,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire))
+        {
+            return index;
+        }
+    }
+}
+
+void FramePool::push(uint32_t index)
+{
+    uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        m_slots[index].next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        uint64_t newHead = ((head >> 32) + 1) << 32 | index;
+        if (m_freeHead.compare_exchange_weak(head, newHead,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+QImage FramePool::acquireImage(int width, int height, int bytesPerLine, QImage::Format format)
+{
+    const int required = bytesPerLine * height;
+    uint32_t index = kNil;
+    if (required <= m_bufferSize)
+    {
+        index = pop();
+        if (index == kNil)
+        {
+            m_exhaustions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (index == kNil)
+    {
+        // 退化为一次性分配，由 QImage 析构时释放
+        uint8_t *data = static_cast<uint8_t *>(av_malloc(static_cast<size_t>(required)));
+        if (!data)
+        {
+            return QImage();
+        }
+        return QImage(data, width, height, bytesPerLine, format, &FramePool::releaseHeap, data);
+    }
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    int inUse = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+    int peak = m_peakInUse.load(std::memory_order_relaxed);
+    while (inUse > peak && !m_peakInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+    {
+    }
+
+    Slot &slot = m_slots[index];
+    slot.keepAlive = shared_from_this();
+    return QImage(slot.data, width, height, bytesPerLine, format, &FramePool::releaseSlot, &slot);
+}
+
+void FramePool::releaseSlot(void *info)
+{
+    Slot *slot = static_cast<Slot *>(info);
+    FramePool *pool = slot->pool;
+    // 先取出 keepAlive 再归还：归还后该槽可能立即被解码线程重新借出
+    std::shared_ptr<FramePool> keepAlive = std::move(slot->keepAlive);
+    pool->m_inUse.fetch_sub(1, std::memory_order_relaxed);
+    pool->push(static_cast<uint32_t>(slot - pool->m_slots.data()));
+    // keepAlive 离开作用域时若为最后一个引用，缓冲池随之析构
+}
+
+void FramePool::releaseHeap(void *info)
+{
+    av_free(info);
+}
+
+FramePool::Stats FramePool::stats() const
+{
+    Stats s;
+    s.capacity = capacity();
+    s.bufferSize = m_bufferSize;
+    s.inUse = m_inUse.load(std::memory_order_relaxed);
+    s.peakInUse = m_peakInUse.load(std::memory_order_relaxed);
+    s.hits = m_hits.load(std::memory_order_relaxed);
+    s.misses = m_misses.load(std::memory_order_relaxed);
+    s.exhaustions = m_exhaustions.load(std::memory_order_relaxed);
+    return s;
+}
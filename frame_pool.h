@@ -0,0 +1,89 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QImage>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief 固定容量的帧缓冲池
+ *
+ * 预先分配 N 个对齐的缓冲区，通过无锁空闲链表循环使用。
+ * acquireImage() 返回的 QImage 直接引用池中的缓冲区，
+ * 最后一个 QImage 副本析构时由清理回调将缓冲区归还到池中，
+ * 因此解码线程与界面线程之间传递帧无需逐帧分配和拷贝。
+ */
+class FramePool : public std::enable_shared_from_this<FramePool>
+{
+public:
+    /**
+     * @brief 缓冲池统计信息
+     */
+    struct Stats
+    {
+        int capacity = 0;           // 缓冲区总数
+        int bufferSize = 0;         // 单个缓冲区字节数
+        int inUse = 0;              // 当前被占用的缓冲区数
+        int peakInUse = 0;          // 历史最大占用数
+        quint64 hits = 0;           // 直接从池中取得缓冲区的次数
+        quint64 misses = 0;         // 请求尺寸超过缓冲区大小而临时分配的次数
+        quint64 exhaustions = 0;    // 池已耗尽而临时分配的次数
+    };
+
+    /**
+     * @brief 创建缓冲池（缓冲区需在 QImage 存活期间保持有效，因此只能以 shared_ptr 持有）
+     * @param capacity 缓冲区数量
+     * @param bufferSize 单个缓冲区字节数
+     */
+    static std::shared_ptr<FramePool> create(int capacity, int bufferSize);
+    ~FramePool();
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    /**
+     * @brief 取得一个缓冲区并包装为 QImage
+     *
+     * 池耗尽或尺寸不足时退化为一次性分配，保证调用方总能拿到可写的图像。
+     * @param bytesPerLine 每行字节数，需为 4 的倍数
+     */
+    QImage acquireImage(int width, int height, int bytesPerLine, QImage::Format format);
+
+    int capacity() const { return static_cast<int>(m_slots.size()); }
+    int bufferSize() const { return m_bufferSize; }
+    Stats stats() const;
+
+private:
+    FramePool(int capacity, int bufferSize);
+
+    struct Slot
+    {
+        uint8_t *data = nullptr;
+        FramePool *pool = nullptr;
+        std::shared_ptr<FramePool> keepAlive;   // 缓冲区借出期间保持缓冲池存活
+        std::atomic<uint32_t> next{0};
+    };
+
+    static constexpr uint32_t kNil = 0xFFFFFFFFu;
+
+    uint32_t pop();
+    void push(uint32_t index);
+    static void releaseSlot(void *info);
+    static void releaseHeap(void *info);
+
+    std::vector<Slot> m_slots;
+    int m_bufferSize;
+
+    // 高 32 位为版本号（避免 ABA），低 32 位为栈顶下标
+    std::atomic<uint64_t> m_freeHead{kNil};
+
+    std::atomic<int> m_inUse{0};
+    std::atomic<int> m_peakInUse{0};
+    std::atomic<quint64> m_hits{0};
+    std::atomic<quint64> m_misses{0};
+    std::atomic<quint64> m_exhaustions{0};
+};
+
+#endif // FRAMEPOOL_H
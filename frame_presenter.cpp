@@ -0,0 +1,181 @@
+#include "frame_presenter.h"
+#include <QMutexLocker>
+
+extern "C"
+{
+#include <libavutil/avutil.h>
+}
+
+FramePresenter::FramePresenter(int minDelayMs, int maxDelayMs)
+    : m_minDelayUs(static_cast<qint64>(minDelayMs) * 1000),
+      m_maxDelayUs(static_cast<qint64>(qMax(minDelayMs, maxDelayMs)) * 1000),
+      m_targetDelayUs(static_cast<double>(minDelayMs) * 1000)
+{
+}
+
+void FramePresenter::setMaxDelayMs(int maxDelayMs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxDelayUs = qMax(m_minDelayUs, static_cast<qint64>(maxDelayMs) * 1000);
+}
+
+int FramePresenter::maxDelayMs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_maxDelayUs / 1000);
+}
+
+void FramePresenter::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_hasClock = false;
+    m_jitterUs = 0;
+    m_targetDelayUs = static_cast<double>(m_minDelayUs);
+    m_frameIntervalUs = 0;
+    m_lastDueUs = 0;
+    m_lastPresentedDueUs = 0;
+    m_starved = false;
+}
+
+void FramePresenter::updateClock(qint64 ptsUs, qint64 arrivalUs)
+{
+    const qint64 offset = arrivalUs - ptsUs;
+    if (!m_hasClock || qAbs(offset - static_cast<qint64>(m_offsetUs)) > kDiscontinuityUs)
+    {
+        // 首帧或时间戳跳变（推流端重启等）：以当前帧重新建立参考
+        if (m_hasClock)
+        {
+            m_stats.clockResets++;
+        }
+        m_hasClock = true;
+        m_windowStartUs = arrivalUs;
+        m_windowMinOffset = offset;
+        m_prevWindowMinOffset = offset;
+        m_offsetUs = static_cast<double>(offset);
+        m_jitterUs = 0;
+        m_lastPtsUs = ptsUs;
+        m_lastDueUs = 0;
+    }
+
+    // 参考取近两个窗口内的最小偏移；窗口滚动时两窗口最小值之差即为时钟漂移
+    if (arrivalUs - m_windowStartUs >= kWindowUs)
+    {
+        m_driftPpm = static_cast<double>(m_windowMinOffset - m_prevWindowMinOffset) * 1e6 /
+                     static_cast<double>(arrivalUs - m_windowStartUs);
+        m_prevWindowMinOffset = m_windowMinOffset;
+        m_windowMinOffset = offset;
+        m_windowStartUs = arrivalUs;
+    }
+    m_windowMinOffset = qMin(m_windowMinOffset, offset);
+    const qint64 reference = qMin(m_windowMinOffset, m_prevWindowMinOffset);
+    m_offsetUs += qBound(-static_cast<double>(kSlewUs), reference - m_offsetUs, static_cast<double>(kSlewUs));
+
+    // 抖动：本帧比参考晚到的时间，取峰值后逐帧衰减
+    const double lateness = qMax(0.0, offset - m_offsetUs);
+    m_jitterUs = qMax(lateness, m_jitterUs * kJitterDecay);
+
+    // 目标延迟：抖动变大时很快跟上，变小后缓慢回落，避免画面节奏来回变化
+    const double desired = qBound(static_cast<double>(m_minDelayUs), m_jitterUs + kMarginUs,
+                                  static_cast<double>(m_maxDelayUs));
+    m_targetDelayUs += qBound(-static_cast<double>(kShrinkUs), desired - m_targetDelayUs,
+                              static_cast<double>(kGrowUs));
+
+    if (ptsUs > m_lastPtsUs)
+    {
+        const double interval = static_cast<double>(ptsUs - m_lastPtsUs);
+        m_frameIntervalUs = m_frameIntervalUs > 0 ? m_frameIntervalUs * 0.9 + interval * 0.1 : interval;
+    }
+    m_lastPtsUs = ptsUs;
+}
+
+void FramePresenter::push(const QImage &image, const FrameTiming &timing, qint64 ptsUs, qint64 arrivalUs)
+{
+    const qint64 nowUs = LatencyTracer::nowUs();
+    QMutexLocker locker(&m_mutex);
+    m_stats.pushed++;
+
+    qint64 dueUs = nowUs;
+    if (ptsUs != AV_NOPTS_VALUE && arrivalUs > 0)
+    {
+        updateClock(ptsUs, arrivalUs);
+        dueUs = ptsUs + static_cast<qint64>(m_offsetUs + m_targetDelayUs);
+        if (dueUs < nowUs)
+        {
+            // 解码或转换太慢，写入时已经过期：尽快显示
+            m_stats.late++;
+            dueUs = nowUs;
+        }
+        // 无论时钟估计如何，帧在缓冲中停留的时间不超过延迟上限
+        dueUs = qMin(dueUs, nowUs + m_maxDelayUs);
+    }
+    dueUs = qMax(dueUs, m_lastDueUs);
+    m_lastDueUs = dueUs;
+
+    if (static_cast<int>(m_entries.size()) >= kCapacity)
+    {
+        m_entries.pop_front();
+        m_stats.overflows++;
+    }
+    Entry entry;
+    entry.image = image;
+    entry.timing = timing;
+    entry.dueUs = dueUs;
+    m_entries.push_back(std::move(entry));
+    m_stats.maxDepth = qMax(m_stats.maxDepth, static_cast<int>(m_entries.size()));
+}
+
+bool FramePresenter::take(qint64 nowUs, QImage *image, FrameTiming *timing)
+{
+    QMutexLocker locker(&m_mutex);
+    int due = 0;
+    while (due < static_cast<int>(m_entries.size()) && m_entries[due].dueUs <= nowUs)
+    {
+        due++;
+    }
+    if (due == 0)
+    {
+        // 缓冲已空且超过 1.5 个帧间隔没有新帧可显示，记一次取空（同一次停顿只记一次）
+        const qint64 intervalUs = m_frameIntervalUs > 0 ? static_cast<qint64>(m_frameIntervalUs * 1.5) : 100000;
+        if (m_entries.empty() && !m_starved && m_lastPresentedDueUs &&
+            nowUs - m_lastPresentedDueUs > intervalUs)
+        {
+            m_starved = true;
+            m_stats.underruns++;
+        }
+        return false;
+    }
+
+    m_stats.dropped += static_cast<quint64>(due - 1);
+    Entry &entry = m_entries[due - 1];
+    *image = std::move(entry.image);
+    *timing = entry.timing;
+    m_lastPresentedDueUs = entry.dueUs;
+    m_entries.erase(m_entries.begin(), m_entries.begin() + due);
+    m_stats.presented++;
+    m_starved = false;
+    return true;
+}
+
+bool FramePresenter::presentationTimeUs(qint64 ptsUs, qint64 *localUs) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_hasClock)
+    {
+        return false;
+    }
+    *localUs = ptsUs + static_cast<qint64>(m_offsetUs + m_targetDelayUs);
+    return true;
+}
+
+FramePresenter::Stats FramePresenter::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats s = m_stats;
+    s.depth = static_cast<int>(m_entries.size());
+    s.targetDelayMs = m_targetDelayUs / 1000.0;
+    s.jitterMs = m_jitterUs / 1000.0;
+    s.driftPpm = m_driftPpm;
+    s.frameIntervalMs = m_frameIntervalUs / 1000.0;
+    return s;
+}
@@ -0,0 +1,136 @@
+#ifndef FRAMEPRESENTER_H
+#define FRAMEPRESENTER_H
+
+#include <QImage>
+#include <QMutex>
+#include <deque>
+#include "latency_tracer.h"
+
+/**
+ * @brief 按时间戳定时显示的自适应抖动缓冲
+ *
+ * 解码线程写入转换好的帧及其 PTS，界面线程按显示刷新节奏取出到期的帧。
+ * 发送端时钟以“到达时间 - PTS”估计：取近两个窗口内的最小偏移作为参考
+ * （即到达最及时的情况），参考随窗口滚动缓慢跟随两端时钟的漂移，
+ * 每帧最多调整 kSlewUs，避免播放节奏突变。
+ * 每帧的到期时间 = PTS + 参考偏移 + 目标延迟，目标延迟跟随测得的到达抖动
+ * （峰值保持后缓慢衰减）加余量，在最小延迟与延迟上限之间调整：
+ * 抖动变大时很快增大，抖动减小后逐渐缩小。
+ * 网络突发到达的帧因此按原有节奏显示而不是快进，短暂断续也不会立即卡顿。
+ */
+class FramePresenter
+{
+public:
+    /**
+     * @brief 抖动缓冲统计信息
+     */
+    struct Stats
+    {
+        int depth = 0;              // 当前缓冲的帧数
+        int maxDepth = 0;           // 历史最大缓冲帧数
+        double targetDelayMs = 0;   // 当前目标延迟
+        double jitterMs = 0;        // 当前测得的到达抖动
+        double driftPpm = 0;        // 发送端相对本地时钟的漂移估计
+        double frameIntervalMs = 0; // 平均帧间隔（按 PTS）
+        quint64 pushed = 0;         // 写入的帧数
+        quint64 presented = 0;      // 显示的帧数
+        quint64 dropped = 0;        // 到期后未及显示即被更新的帧取代的帧数
+        quint64 late = 0;           // 写入时已超过到期时间的帧数
+        quint64 underruns = 0;      // 缓冲取空、画面停顿的次数
+        quint64 overflows = 0;      // 缓冲已满丢弃最旧帧的次数
+        quint64 clockResets = 0;    // 时间戳跳变导致时钟参考重建的次数
+    };
+
+    /**
+     * @param minDelayMs 目标延迟下限
+     * @param maxDelayMs 目标延迟上限（延迟上限，运行中可调整）
+     */
+    FramePresenter(int minDelayMs, int maxDelayMs);
+
+    FramePresenter(const FramePresenter &) = delete;
+    FramePresenter &operator=(const FramePresenter &) = delete;
+
+    /**
+     * @brief 设置延迟上限，可在任意线程调用，下一帧起生效
+     */
+    void setMaxDelayMs(int maxDelayMs);
+    int maxDelayMs() const;
+
+    /**
+     * @brief 最多缓冲的帧数，输出帧缓冲池需额外预留这么多缓冲区
+     */
+    int capacity() const { return kCapacity; }
+
+    /**
+     * @brief 写入一帧（解码线程调用）
+     * @param ptsUs 帧的显示时间戳（微秒），AV_NOPTS_VALUE 表示立即显示
+     * @param arrivalUs 对应压缩包的到达时间（单调时钟，微秒）
+     */
+    void push(const QImage &image, const FrameTiming &timing, qint64 ptsUs, qint64 arrivalUs);
+
+    /**
+     * @brief 取出到期的最新一帧（界面线程在每次显示刷新时调用）
+     *
+     * 同时到期的多帧只显示最新的一帧，其余计为 dropped。
+     * @return 没有到期的帧时返回 false
+     */
+    bool take(qint64 nowUs, QImage *image, FrameTiming *timing);
+
+    /**
+     * @brief 按当前时钟估计，时间戳为 ptsUs 的内容应在何时（本地单调时钟）呈现
+     *
+     * 与视频帧的到期时间使用同一换算（PTS + 参考偏移 + 目标延迟），供音频同步使用。
+     * @return 尚未建立时钟参考时返回 false
+     */
+    bool presentationTimeUs(qint64 ptsUs, qint64 *localUs) const;
+
+    /**
+     * @brief 新的流开始前调用：清空缓冲并重建时钟参考（统计信息保留）
+     */
+    void reset();
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        QImage image;
+        FrameTiming timing;
+        qint64 dueUs = 0;
+    };
+
+    void updateClock(qint64 ptsUs, qint64 arrivalUs);
+
+    static constexpr int kCapacity = 8;                 // 最多缓冲的帧数
+    static constexpr qint64 kWindowUs = 4000000;        // 时钟参考的窗口长度
+    static constexpr qint64 kDiscontinuityUs = 1000000; // 偏移变化超过该值视为时间戳跳变
+    static constexpr qint64 kSlewUs = 500;              // 参考偏移每帧最多调整量
+    static constexpr qint64 kGrowUs = 20000;            // 目标延迟每帧最多增大量
+    static constexpr qint64 kShrinkUs = 1000;           // 目标延迟每帧最多减小量
+    static constexpr qint64 kMarginUs = 5000;           // 目标延迟在抖动之外的余量
+    static constexpr double kJitterDecay = 0.995;       // 抖动峰值每帧的衰减系数
+
+    mutable QMutex m_mutex;
+    std::deque<Entry> m_entries;
+    qint64 m_minDelayUs;
+    qint64 m_maxDelayUs;
+
+    // 时钟模型（受 m_mutex 保护）
+    bool m_hasClock = false;
+    qint64 m_windowStartUs = 0;
+    qint64 m_windowMinOffset = 0;
+    qint64 m_prevWindowMinOffset = 0;
+    double m_offsetUs = 0;              // 平滑后的参考偏移（到达时间 - PTS）
+    double m_jitterUs = 0;
+    double m_targetDelayUs = 0;
+    double m_driftPpm = 0;
+    double m_frameIntervalUs = 0;
+    qint64 m_lastPtsUs = 0;
+    qint64 m_lastDueUs = 0;             // 最近写入帧的到期时间，保证到期时间单调
+    qint64 m_lastPresentedDueUs = 0;    // 最近显示帧的到期时间
+    bool m_starved = false;             // 当前是否处于缓冲取空状态
+
+    Stats m_stats;
+};
+
+#endif // FRAMEPRESENTER_H
@@ -0,0 +1,96 @@
+#include "input_source.h"
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+bool UrlInputSource::prepare(AVFormatContext *ctx, QString *url, const AVInputFormat **format, QString *error)
+{
+    Q_UNUSED(ctx);
+    Q_UNUSED(error);
+    *url = m_url;
+    *format = nullptr;
+    return true;
+}
+
+RingInputSource::RingInputSource(std::shared_ptr<ByteRing> ring, const QString &formatName, int ioBufferSize)
+    : m_ring(std::move(ring)), m_formatName(formatName), m_ioBufferSize(ioBufferSize)
+{
+}
+
+RingInputSource::~RingInputSource()
+{
+    close();
+}
+
+bool RingInputSource::prepare(AVFormatContext *ctx, QString *url, const AVInputFormat **format, QString *error)
+{
+    close();
+    if (m_ring->isClosed() && m_ring->available() == 0)
+    {
+        *error = "Input ring closed";
+        return false;
+    }
+    *format = nullptr;
+    if (!m_formatName.isEmpty())
+    {
+        *format = av_find_input_format(m_formatName.toUtf8().constData());
+        if (!*format)
+        {
+            *error = "Unknown input format " + m_formatName;
+            return false;
+        }
+    }
+
+    unsigned char *buffer = static_cast<unsigned char *>(av_malloc(m_ioBufferSize));
+    m_ioCtx = buffer ? avio_alloc_context(buffer, m_ioBufferSize, 0, this, &RingInputSource::readCallback,
+                                          nullptr, nullptr)
+                     : nullptr;
+    if (!m_ioCtx)
+    {
+        av_free(buffer);
+        *error = "Out of memory";
+        return false;
+    }
+    m_interrupt = ctx->interrupt_callback;
+    ctx->pb = m_ioCtx;
+    ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    *url = QString();
+    return true;
+}
+
+void RingInputSource::close()
+{
+    // 自定义 I/O 不随 avformat_close_input 释放
+    if (m_ioCtx)
+    {
+        av_freep(&m_ioCtx->buffer);
+        avio_context_free(&m_ioCtx);
+    }
+}
+
+int RingInputSource::readCallback(void *opaque, uint8_t *buf, int size)
+{
+    RingInputSource *self = static_cast<RingInputSource *>(opaque);
+    for (;;)
+    {
+        const size_t count = self->m_ring->read(buf, static_cast<size_t>(size));
+        if (count > 0)
+        {
+            return static_cast<int>(count);
+        }
+        // 关闭标志在数据之后写入，看到关闭后需再确认没有剩余数据
+        if (self->m_ring->isClosed() && self->m_ring->available() == 0)
+        {
+            return AVERROR_EOF;
+        }
+        if (self->m_interrupt.callback && self->m_interrupt.callback(self->m_interrupt.opaque))
+        {
+            return AVERROR_EXIT;
+        }
+        const qint64 beginUs = av_gettime_relative();
+        self->m_ring->waitForData(10);
+        self->m_readWaitUs.fetch_add(av_gettime_relative() - beginUs, std::memory_order_relaxed);
+    }
+}
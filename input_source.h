@@ -0,0 +1,103 @@
+#ifndef INPUTSOURCE_H
+#define INPUTSOURCE_H
+
+#include <QString>
+#include <atomic>
+#include <memory>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+#include "byte_ring.h"
+
+/**
+ * @brief VideoDecoder 的输入来源
+ *
+ * 每次连接（含重连）前调用 prepare()，由来源决定传给 avformat_open_input 的地址、
+ * 输入格式以及是否使用自定义 AVIOContext；连接结束（avformat_close_input 之后）调用 close()。
+ * 两者都在解码线程中调用。
+ */
+class InputSource
+{
+public:
+    virtual ~InputSource() = default;
+
+    /**
+     * @param ctx 已设置中断回调的格式上下文，自定义 I/O 时由来源设置 ctx->pb
+     * @param url 输出传给 avformat_open_input 的地址
+     * @param format 输出指定的输入格式，为空时由 FFmpeg 探测
+     */
+    virtual bool prepare(AVFormatContext *ctx, QString *url, const AVInputFormat **format, QString *error) = 0;
+
+    /**
+     * @brief 释放本次连接的资源
+     */
+    virtual void close() {}
+
+    /**
+     * @brief 是否为网络地址（决定是否设置网络相关的打开参数）
+     */
+    virtual bool isNetwork() const { return false; }
+
+    /**
+     * @brief 读取时等待数据到达的累计时间（微秒），用于从读包耗时中扣除，得到纯解复用开销
+     */
+    virtual qint64 readWaitUs() const { return 0; }
+
+    virtual const char *name() const = 0;
+};
+
+/**
+ * @brief 按地址打开（RTMP 等网络流或本地文件），由 FFmpeg 协议层负责读取
+ */
+class UrlInputSource : public InputSource
+{
+public:
+    explicit UrlInputSource(const QString &url) : m_url(url) {}
+
+    bool prepare(AVFormatContext *ctx, QString *url, const AVInputFormat **format, QString *error) override;
+    bool isNetwork() const override { return m_url.contains("://"); }
+    const char *name() const override { return "url"; }
+
+private:
+    const QString m_url;
+};
+
+/**
+ * @brief 从进程内字节环形缓冲读取（回放抓包、转发等）
+ *
+ * 通过自定义 AVIOContext 的读回调直接从环形缓冲拷入 FFmpeg 的读缓冲区，
+ * 中间不经过其他缓冲。无数据时短暂等待，并检查格式上下文的中断回调，
+ * 因此停止和超时处理与网络输入一致。生产者 close() 环形缓冲后即为流结束。
+ */
+class RingInputSource : public InputSource
+{
+public:
+    /**
+     * @param formatName 输入格式（如 flv、mpegts），为空时由 FFmpeg 探测
+     * @param ioBufferSize AVIOContext 读缓冲区大小
+     */
+    RingInputSource(std::shared_ptr<ByteRing> ring, const QString &formatName, int ioBufferSize = 32 * 1024);
+    ~RingInputSource() override;
+
+    bool prepare(AVFormatContext *ctx, QString *url, const AVInputFormat **format, QString *error) override;
+    void close() override;
+    qint64 readWaitUs() const override { return m_readWaitUs.load(std::memory_order_relaxed); }
+    const char *name() const override { return "ring"; }
+
+    std::shared_ptr<ByteRing> ring() const { return m_ring; }
+
+private:
+    static int readCallback(void *opaque, uint8_t *buf, int size);
+
+    const std::shared_ptr<ByteRing> m_ring;
+    const QString m_formatName;
+    const int m_ioBufferSize;
+    AVIOContext *m_ioCtx = nullptr;
+    AVIOInterruptCB m_interrupt{nullptr, nullptr};
+    std::atomic<qint64> m_readWaitUs{0};
+};
+
+#endif // INPUTSOURCE_H
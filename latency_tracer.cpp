@@ -0,0 +1,175 @@
+#include "latency_tracer.h"
+#include <cmath>
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+LatencyTracer::LatencyTracer()
+{
+    reset();
+}
+
+qint64 LatencyTracer::nowUs()
+{
+    return av_gettime_relative();
+}
+
+int LatencyTracer::bucketFor(qint64 us)
+{
+    if (us <= 1)
+    {
+        return 0;
+    }
+    const int bucket = static_cast<int>(std::log2(static_cast<double>(us)) * kBucketsPerOctave);
+    return bucket < kBucketCount ? bucket : kBucketCount - 1;
+}
+
+double LatencyTracer::bucketUpperMs(int bucket)
+{
+    return std::exp2(static_cast<double>(bucket + 1) / kBucketsPerOctave) / 1000.0;
+}
+
+void LatencyTracer::record(Stage stage, qint64 beginUs, qint64 endUs)
+{
+    if (!beginUs || !endUs || endUs < beginUs)
+    {
+        return;
+    }
+    const qint64 us = endUs - beginUs;
+    Histogram &h = m_histograms[stage];
+    h.buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(static_cast<quint64>(us), std::memory_order_relaxed);
+    h.lastUs.store(us, std::memory_order_relaxed);
+    qint64 max = h.maxUs.load(std::memory_order_relaxed);
+    while (us > max && !h.maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyTracer::recordDecoderStages(const FrameTiming &timing)
+{
+    record(StageQueue, timing.readUs, timing.sendUs);
+    record(StageDecode, timing.sendUs, timing.receiveUs);
+    record(StageConvert, timing.receiveUs, timing.convertedUs);
+    record(StageHandoff, timing.convertedUs, timing.handoffUs);
+}
+
+void LatencyTracer::recordDisplayStages(const FrameTiming &timing)
+{
+    record(StageDisplay, timing.handoffUs, timing.paintedUs);
+    record(StageTotal, timing.readUs, timing.paintedUs);
+}
+
+LatencyTracer::Summary LatencyTracer::summary(Stage stage) const
+{
+    const Histogram &h = m_histograms[stage];
+    Summary s;
+    s.count = h.count.load(std::memory_order_relaxed);
+    s.last = h.lastUs.load(std::memory_order_relaxed) / 1000.0;
+    s.max = h.maxUs.load(std::memory_order_relaxed) / 1000.0;
+    if (!s.count)
+    {
+        return s;
+    }
+    s.mean = h.sumUs.load(std::memory_order_relaxed) / 1000.0 / s.count;
+
+    // 按桶累计求分位数，取桶上界（误差不超过约 19%）
+    quint64 counts[kBucketCount];
+    quint64 total = 0;
+    for (int i = 0; i < kBucketCount; i++)
+    {
+        counts[i] = h.buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    const double targets[3] = {0.50, 0.95, 0.99};
+    double *outputs[3] = {&s.p50, &s.p95, &s.p99};
+    for (int t = 0; t < 3; t++)
+    {
+        const quint64 rank = static_cast<quint64>(std::ceil(targets[t] * total));
+        quint64 cumulative = 0;
+        for (int i = 0; i < kBucketCount; i++)
+        {
+            cumulative += counts[i];
+            if (cumulative >= rank)
+            {
+                *outputs[t] = qMin(bucketUpperMs(i), s.max);
+                break;
+            }
+        }
+    }
+    return s;
+}
+
+QVector<LatencyTracer::Summary> LatencyTracer::summaries() const
+{
+    QVector<Summary> result;
+    for (int i = 0; i < StageCount; i++)
+    {
+        result.append(summary(static_cast<Stage>(i)));
+    }
+    return result;
+}
+
+void LatencyTracer::reset()
+{
+    for (Histogram &h : m_histograms)
+    {
+        for (std::atomic<quint64> &bucket : h.buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        h.count.store(0, std::memory_order_relaxed);
+        h.sumUs.store(0, std::memory_order_relaxed);
+        h.maxUs.store(0, std::memory_order_relaxed);
+        h.lastUs.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char *LatencyTracer::stageName(Stage stage)
+{
+    switch (stage)
+    {
+    case StageQueue:
+        return "queue";
+    case StageDecode:
+        return "decode";
+    case StageConvert:
+        return "convert";
+    case StageHandoff:
+        return "handoff";
+    case StageDisplay:
+        return "display";
+    case StageTotal:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
+
+QString LatencyTracer::report() const
+{
+    QString text = QString("%1 %2 %3 %4 %5 %6 %7\n")
+                       .arg(QString::fromLatin1("stage"), -8)
+                       .arg(QString::fromLatin1("count"), 8)
+                       .arg(QString::fromLatin1("mean"), 8)
+                       .arg(QString::fromLatin1("p50"), 8)
+                       .arg(QString::fromLatin1("p95"), 8)
+                       .arg(QString::fromLatin1("p99"), 8)
+                       .arg(QString::fromLatin1("max"), 8);
+    for (int i = 0; i < StageCount; i++)
+    {
+        const Summary s = summary(static_cast<Stage>(i));
+        text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                    .arg(QString::fromLatin1(stageName(static_cast<Stage>(i))), -8)
+                    .arg(s.count, 8)
+                    .arg(s.mean, 8, 'f', 2)
+                    .arg(s.p50, 8, 'f', 2)
+                    .arg(s.p95, 8, 'f', 2)
+                    .arg(s.p99, 8, 'f', 2)
+                    .arg(s.max, 8, 'f', 2);
+    }
+    return text;
+}
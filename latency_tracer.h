@@ -0,0 +1,112 @@
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 单帧在各阶段的时间戳（单调时钟，微秒），0 表示未记录
+ */
+struct FrameTiming
+{
+    qint64 readUs = 0;          // av_read_frame 返回（包入队）
+    qint64 sendUs = 0;          // avcodec_send_packet
+    qint64 receiveUs = 0;       // avcodec_receive_frame 返回
+    qint64 convertedUs = 0;     // 颜色转换完成
+    qint64 handoffUs = 0;       // 写入帧信箱
+    qint64 paintedUs = 0;       // 在界面上绘制完成
+    qint64 ptsUs = INT64_MIN;   // 显示时间戳（流时间，微秒），INT64_MIN 即 AV_NOPTS_VALUE，表示未知
+};
+
+/**
+ * @brief 按阶段统计帧延迟分布
+ *
+ * 每个阶段一个对数分桶直方图（每倍程 4 个桶），记录操作全部为原子操作，
+ * 解码线程与界面线程可同时写入，运行中可随时读取 p50/p95/p99。
+ */
+class LatencyTracer
+{
+public:
+    enum Stage
+    {
+        StageQueue,     // 读取 -> 送入解码器（包队列中等待）
+        StageDecode,    // 送入解码器 -> 取得解码帧（含帧级多线程带来的延迟）
+        StageConvert,   // 取得解码帧 -> 颜色转换完成
+        StageHandoff,   // 颜色转换完成 -> 写入帧信箱
+        StageDisplay,   // 写入帧信箱 -> 绘制完成
+        StageTotal,     // 读取 -> 绘制完成
+        StageCount
+    };
+
+    /**
+     * @brief 某阶段的统计摘要，单位毫秒
+     */
+    struct Summary
+    {
+        quint64 count = 0;
+        double last = 0;
+        double mean = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    LatencyTracer();
+
+    LatencyTracer(const LatencyTracer &) = delete;
+    LatencyTracer &operator=(const LatencyTracer &) = delete;
+
+    /**
+     * @brief 与解码器使用的时间戳相同的单调时钟（微秒）
+     */
+    static qint64 nowUs();
+
+    /**
+     * @brief 记录一个阶段的耗时（起止任一为 0 时忽略）
+     */
+    void record(Stage stage, qint64 beginUs, qint64 endUs);
+
+    /**
+     * @brief 记录解码端能够得到的各阶段（读取 -> 写入信箱）
+     */
+    void recordDecoderStages(const FrameTiming &timing);
+
+    /**
+     * @brief 记录显示端阶段（写入信箱 -> 绘制）及总延迟
+     */
+    void recordDisplayStages(const FrameTiming &timing);
+
+    Summary summary(Stage stage) const;
+    QVector<Summary> summaries() const;
+    void reset();
+
+    static const char *stageName(Stage stage);
+
+    /**
+     * @brief 生成多行文本报告，用于退出时输出到日志
+     */
+    QString report() const;
+
+private:
+    static constexpr int kBucketsPerOctave = 4;
+    static constexpr int kBucketCount = 26 * kBucketsPerOctave;   // 覆盖 1us ~ 约 67s
+
+    static int bucketFor(qint64 us);
+    static double bucketUpperMs(int bucket);
+
+    struct Histogram
+    {
+        std::atomic<quint64> buckets[kBucketCount];
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> sumUs{0};
+        std::atomic<qint64> maxUs{0};
+        std::atomic<qint64> lastUs{0};
+    };
+
+    Histogram m_histograms[StageCount];
+};
+
+#endif // LATENCYTRACER_H
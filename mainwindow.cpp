@@ -2,6 +2,11 @@
 #include "ui_mainwindow.h"
 #include <QMessageBox>
 #include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QGuiApplication>
+#include <QShortcut>
+#include <QStatusBar>
 #include <nlohmann/json.hpp>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -25,15 +30,110 @@ MainWindow::MainWindow(QWidget *parent)
     m_mqttClient = std::make_unique<MQTTClient>(config);
     m_mqttClient->subscribe(config.subTOPIC, 1);
 
-    m_decoder = std::make_unique<VideoDecoder>(config);
-
-    // 获取 UI 中的视频显示控件
+    // 获取 UI 中的视频显示控件，作为拼接显示的第一路画面
     m_videoWidget = ui->videoArea;
+    m_mosaic = new MosaicView(ui->centralwidget);
+    m_mosaic->setGeometry(m_videoWidget->geometry());
+    m_mosaic->lower();
+    m_mosaic->addTile(m_videoWidget);
 
     setWindowTitle("RTMP Player");
 
-    connect(m_decoder.get(), &VideoDecoder::frameReady, this, &MainWindow::updateVideoFrame);
-    connect(m_decoder.get(), &VideoDecoder::errorOccurred, this, &MainWindow::handleError);
+    // 每路摄像头一个解码器（各自读取和解码），共享颜色转换线程池
+    m_convertPool = std::make_shared<ConvertWorkerPool>(config.CONVERT_THREADS);
+    for (int i = 0; i < config.CAMERA_URLS.size(); i++)
+    {
+        VideoWidget *tile = m_videoWidget;
+        if (i > 0)
+        {
+            tile = new VideoWidget;
+            m_mosaic->addTile(tile);
+        }
+        auto decoder = std::make_unique<VideoDecoder>(config, config.CAMERA_URLS[i], m_convertPool);
+
+        // 解码帧经信箱直接送达显示控件，不经过界面线程的事件队列
+        decoder->setFrameMailbox(tile->frameMailbox());
+        tile->setLatencyTracer(decoder->latencyTracer());
+        if (config.JITTER_BUFFER_ENABLED)
+        {
+            // 按时间戳定时显示，网络抖动和突发到达不再直接表现为卡顿和快进
+            auto presenter = std::make_shared<FramePresenter>(config.JITTER_MIN_DELAY_MS, config.JITTER_MAX_DELAY_MS);
+            decoder->setFramePresenter(presenter);
+            tile->setFramePresenter(presenter);
+            m_presenters.push_back(presenter);
+        }
+        connect(decoder.get(), &VideoDecoder::errorOccurred, this, &MainWindow::handleError);
+        // 丢包导致花屏时请求摄像头立即发送关键帧，不必等到下一个固定间隔的关键帧
+        connect(decoder.get(), &VideoDecoder::keyframeRequested, this,
+                [this, i](const QString &reason) { requestKeyframe(i, reason); });
+
+        // 声音只取主摄像头，同一连接中的音频流在独立线程解码
+        if (i == 0 && config.AUDIO_ENABLED)
+        {
+            auto output = std::make_shared<AudioOutput>(config.AUDIO_DEVICE_BUFFER_MS, config.AUDIO_RING_MS);
+            QString error;
+            if (output->start(&error))
+            {
+                decoder->setAudioOutput(output);
+                m_audioOutput = output;
+            }
+            else
+            {
+                qWarning() << "Audio disabled:" << error;
+            }
+        }
+
+        // 录像直接取读取线程的压缩包，不另开连接
+        if (config.RECORD_ENABLED)
+        {
+            auto recorder = std::make_shared<StreamRecorder>(config.RECORD_DIR, QString("cam%1").arg(i),
+                                                             config.RECORD_FORMAT, config.RECORD_SEGMENT_SECONDS,
+                                                             config.RECORD_QUEUE_MB * 1024 * 1024,
+                                                             config.RECORD_IO_BUFFER_KB * 1024);
+            decoder->addPacketSink(recorder);
+            m_recorders.push_back(recorder);
+        }
+        auto snapshot = std::make_shared<SnapshotCapture>(config.SNAPSHOT_QUALITY);
+        connect(snapshot.get(), &SnapshotCapture::snapshotSaved, this,
+                [this](const QString &path, bool ok, double encodeMs, int queueLength)
+                {
+                    qInfo().noquote() << QString("[Snapshot] %1 %2: encode %3 ms, queued behind %4")
+                                             .arg(ok ? "saved" : "failed", path)
+                                             .arg(encodeMs, 0, 'f', 1)
+                                             .arg(queueLength);
+                    statusBar()->showMessage(ok ? "Snapshot saved: " + path : "Snapshot failed: " + path, 3000);
+                });
+        decoder->setSnapshotCapture(snapshot);
+        m_snapshots.push_back(snapshot);
+
+        if (config.PREROLL_ENABLED)
+        {
+            auto preRoll = std::make_shared<PreRollBuffer>(
+                static_cast<qint64>(config.PREROLL_BUFFER_MB) * 1024 * 1024, config.PREROLL_SECONDS);
+            connect(preRoll.get(), &PreRollBuffer::clipExported, this,
+                    [this](const QString &path, bool ok, const QString &error)
+                    {
+                        const QString text = ok ? "Clip saved: " + path : "Clip export failed: " + error;
+                        qInfo().noquote() << "[Clip]" << text;
+                        statusBar()->showMessage(text, 5000);
+                    });
+            decoder->addPacketSink(preRoll);
+            m_preRolls.push_back(preRoll);
+        }
+        m_decoders.push_back(std::move(decoder));
+    }
+    connect(new QShortcut(QKeySequence("Ctrl+S"), this), &QShortcut::activated, this,
+            [this]() { captureSnapshot(1, 0); });
+    connect(new QShortcut(QKeySequence("Ctrl+Shift+S"), this), &QShortcut::activated, this,
+            [this]() { captureSnapshot(config.SNAPSHOT_BURST_COUNT, config.SNAPSHOT_BURST_INTERVAL_MS); });
+    if (!m_preRolls.empty())
+    {
+        connect(new QShortcut(QKeySequence("Ctrl+E"), this), &QShortcut::activated, this, &MainWindow::exportClips);
+    }
+    // 最小化、切到调试面板或应用转入后台时画面不可见，解码器据此只解码不转换
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, &MainWindow::updateVideoVisibility);
+    connect(m_mosaic, &MosaicView::focusChanged, this, &MainWindow::applyCameraFocus);
+    applyCameraFocus(m_mosaic->focusedIndex());
     connect(m_mqttClient.get(), &MQTTClient::errorOccurred, this, [this](const QString &msg, bool maxPublishFlag)
             {
                 if(maxPublishFlag)
@@ -57,22 +157,150 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    if (m_decoder)
+    for (const std::unique_ptr<VideoDecoder> &decoder : m_decoders)
+    {
+        decoder->stop();
+        const VideoDecoder::Stats s = decoder->stats();
+        qInfo().noquote() << "[Latency] " + decoder->url() + " (" + QString::fromLatin1(s.transport) + ")\n" +
+                                 decoder->latencyTracer()->report();
+        qInfo().noquote() << QString("[Keyframe] %1 corruptions, %2 requests, %3 recoveries (avg %4 ms, max %5 ms), "
+                                     "%6 corrupt frames, %7 frozen, %8 decode errors")
+                                 .arg(s.corruptionEvents)
+                                 .arg(s.keyframeRequests)
+                                 .arg(s.recoveries)
+                                 .arg(s.avgRecoveryMs, 0, 'f', 1)
+                                 .arg(s.maxRecoveryMs, 0, 'f', 1)
+                                 .arg(s.corruptFrames)
+                                 .arg(s.frozenFrames)
+                                 .arg(s.decodeErrors);
+    }
+    for (const std::shared_ptr<FramePresenter> &presenter : m_presenters)
     {
-        m_decoder->stop();
+        const FramePresenter::Stats s = presenter->stats();
+        qInfo().noquote() << QString("[Jitter] delay %1 ms (jitter %2 ms, drift %3 ppm), max depth %4, "
+                                     "presented %5, dropped %6, late %7, underruns %8")
+                                 .arg(s.targetDelayMs, 0, 'f', 1)
+                                 .arg(s.jitterMs, 0, 'f', 1)
+                                 .arg(s.driftPpm, 0, 'f', 0)
+                                 .arg(s.maxDepth)
+                                 .arg(s.presented)
+                                 .arg(s.dropped)
+                                 .arg(s.late)
+                                 .arg(s.underruns);
+    }
+    if (m_audioOutput)
+    {
+        const AudioOutput::Stats out = m_audioOutput->stats();
+        const AudioDecoder::Stats dec = m_decoders.front()->audioStats();
+        qInfo().noquote() << QString("[Audio] %1 %2 Hz/%3 ch -> %4 Hz/%5 ch, latency %6 ms (max ring %7 ms), "
+                                     "underruns %8 (%9 ms silence), sync error %10 ms, correction %11%, "
+                                     "alignments %12")
+                                 .arg(QString::fromLatin1(dec.codec))
+                                 .arg(dec.inputRate)
+                                 .arg(dec.inputChannels)
+                                 .arg(out.sampleRate)
+                                 .arg(out.channels)
+                                 .arg(out.latencyMs, 0, 'f', 1)
+                                 .arg(out.maxBufferedMs, 0, 'f', 1)
+                                 .arg(out.underruns)
+                                 .arg(out.silenceMs, 0, 'f', 0)
+                                 .arg(dec.syncErrorMs, 0, 'f', 1)
+                                 .arg(dec.correctionPct, 0, 'f', 2)
+                                 .arg(dec.alignments);
+    }
+    for (const std::shared_ptr<StreamRecorder> &recorder : m_recorders)
+    {
+        const StreamRecorder::Stats s = recorder->stats();
+        qInfo().noquote() << QString("[Record] %1 segments, %2 packets, %3 MB at %4 MB/s, dropped %5, max queue %6")
+                                 .arg(s.segments)
+                                 .arg(s.packetsWritten)
+                                 .arg(s.writtenMB, 0, 'f', 1)
+                                 .arg(s.writeMBps, 0, 'f', 1)
+                                 .arg(s.packetsDropped)
+                                 .arg(s.maxQueueDepth);
     }
     delete ui;
 }
 
-void MainWindow::updateVideoFrame(const QImage &frame)
+void MainWindow::handleError(const QString &message)
 {
-    m_videoWidget->setFrame(frame);
+    QMessageBox::critical(this, "Playback Error", message);
+    // 只停止出错的那一路
+    if (VideoDecoder *decoder = qobject_cast<VideoDecoder *>(sender()))
+    {
+        decoder->stop();
+    }
 }
 
-void MainWindow::handleError(const QString &message)
+void MainWindow::exportClips()
 {
-    QMessageBox::critical(this, "Playback Error", message);
-    m_decoder->stop();
+    // 导出各路预录缓冲的全部内容，封装写盘在后台线程完成
+    QDir().mkpath(config.CLIP_DIR);
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    const QString ext = PacketMuxer::extensionFor(config.RECORD_FORMAT);
+    for (int i = 0; i < static_cast<int>(m_preRolls.size()); i++)
+    {
+        const QString path = QDir(config.CLIP_DIR).filePath(QString("clip_cam%1_%2.%3").arg(i).arg(stamp, ext));
+        if (!m_preRolls[i]->exportClip(path, config.RECORD_FORMAT))
+        {
+            qInfo() << "[Clip] nothing buffered for camera" << i;
+        }
+    }
+}
+
+void MainWindow::captureSnapshot(int count, int intervalMs)
+{
+    // 截取焦点画面，从下一帧解码输出开始
+    const int index = m_mosaic->focusedIndex();
+    if (index < 0 || index >= static_cast<int>(m_snapshots.size()))
+    {
+        return;
+    }
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz");
+    const QString basePath = QDir(config.SNAPSHOT_DIR).filePath(QString("snap_cam%1_%2").arg(index).arg(stamp));
+    m_snapshots[index]->request(basePath, config.SNAPSHOT_FORMAT, count, intervalMs);
+}
+
+void MainWindow::requestKeyframe(int camera, const QString &reason)
+{
+    // 与摄像头开关同属 CAMERA_ID 命令，摄像头收到 Camera_idr 后立即编码一个 IDR 帧；
+    // 解码器已按 KEYFRAME_REQUEST_INTERVAL_MS 限速，发布端另有独立限速，不占用操作命令的额度
+    qInfo().noquote() << QString("[Keyframe] camera %1: %2, requesting IDR").arg(camera).arg(reason);
+    m_mqttClient->publishKeyframeRequest(camera, CAMERA_ID);
+}
+
+void MainWindow::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange)
+    {
+        updateVideoVisibility();
+    }
+}
+
+void MainWindow::updateVideoVisibility()
+{
+    const Qt::ApplicationState state = QGuiApplication::applicationState();
+    const bool visible = !show_dev && !isMinimized() && state != Qt::ApplicationHidden &&
+                         state != Qt::ApplicationSuspended;
+    for (int i = 0; i < m_mosaic->tileCount(); i++)
+    {
+        m_mosaic->tile(i)->frameMailbox()->setVisible(visible);
+    }
+}
+
+void MainWindow::applyCameraFocus(int focused)
+{
+    // 焦点画面全帧率解码；其余画面降低帧率并只用少量解码线程，
+    // 其输出尺寸随小画面缩小，总开销不随路数线性增长
+    VideoDecoder::DecodeRate unfocusedRate = VideoDecoder::RateKeyframesOnly;
+    VideoDecoder::decodeRateFromName(config.MOSAIC_UNFOCUSED_RATE, &unfocusedRate);
+    for (int i = 0; i < static_cast<int>(m_decoders.size()); i++)
+    {
+        const bool isFocused = i == focused;
+        m_decoders[i]->setDecodeRate(isFocused ? VideoDecoder::RateFull : unfocusedRate);
+        m_decoders[i]->setDecoderThreads(isFocused ? 0 : config.MOSAIC_UNFOCUSED_THREADS);
+    }
 }
 
 void MainWindow::handleInputsAccepted(const QStringList &inputs, dialog_type_e type)
@@ -180,6 +408,11 @@ void MainWindow::handleMessageReceived(const QString &topic, const QByteArray &p
 
             if (id == CAMERA_ID)
             {
+                if (data["params"].contains("Camera_idr"))
+                {
+                    // 关键帧请求的应答，与摄像头开关状态无关
+                    return;
+                }
                 bool isPlaying_r = false;
                 if (data["params"]["Camera_state"]["value"] == 1)
                 {
@@ -303,8 +536,11 @@ void MainWindow::onPlay8StopClicked()
 
     m_mqttClient->publishMqttMessage(fields, CAMERA_ID);
 
-    // 启动视频解码线程
-    m_decoder->start();
+    // 启动各路视频解码线程
+    for (const std::unique_ptr<VideoDecoder> &decoder : m_decoders)
+    {
+        decoder->start();
+    }
 }
 
 void MainWindow::onUp8DownClicked()
@@ -575,4 +811,5 @@ void MainWindow::on_devBtn_clicked()
         ui->operatingFlickArea->show();
         show_dev = true;
     }
+    updateVideoVisibility();
 }
@@ -5,8 +5,12 @@
 #include <QPushButton>
 #include "video_decoder.h"
 #include "videowidget.h"
+#include "mosaicview.h"
+#include "stream_recorder.h"
+#include "pre_roll_buffer.h"
 #include "mqtt_client.h"
 #include <memory>
+#include <vector>
 #include "numberpaddialog.h"
 
 QT_BEGIN_NAMESPACE
@@ -21,9 +25,16 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void changeEvent(QEvent *event) override;
+
 private slots:
-    void updateVideoFrame(const QImage &frame);
     void handleError(const QString &message);
+    void updateVideoVisibility();
+    void applyCameraFocus(int focused);
+    void exportClips();
+    void captureSnapshot(int count, int intervalMs);
+    void requestKeyframe(int camera, const QString &reason);
     void handleMessageReceived(const QString &topic, const QByteArray &payload);
     void toggleButtonState(bool &state, QPushButton *btn, const QString &textOn, const QString &textOff, const QString &styleOn, const QString &styleOff);
     void connectButtons();
@@ -60,8 +71,15 @@ private:
     bool isFanOpen;             // 推进器开关状态
     uint8_t lh08;
     uint8_t lh08_buffer;
-    std::unique_ptr<VideoDecoder> m_decoder;  // 视频解码器
-    VideoWidget *m_videoWidget;               // 视频显示控件
+    std::vector<std::unique_ptr<VideoDecoder>> m_decoders;  // 各路摄像头的视频解码器
+    std::shared_ptr<ConvertWorkerPool> m_convertPool;       // 各路共享的颜色转换线程池
+    std::vector<std::shared_ptr<StreamRecorder>> m_recorders;   // 各路录像（未启用时为空）
+    std::vector<std::shared_ptr<PreRollBuffer>> m_preRolls;     // 各路预录缓冲（未启用时为空）
+    std::vector<std::shared_ptr<SnapshotCapture>> m_snapshots;  // 各路截图器
+    std::vector<std::shared_ptr<FramePresenter>> m_presenters;  // 各路抖动缓冲（未启用时为空）
+    std::shared_ptr<AudioOutput> m_audioOutput;                 // 主摄像头的声音输出（未启用或无声卡时为空）
+    VideoWidget *m_videoWidget;               // 第一路视频显示控件
+    MosaicView *m_mosaic;                     // 多路拼接显示
     std::unique_ptr<MQTTClient> m_mqttClient;   // MQTT 通信客户端
 
     float m_canMotorspeedbuffer;
@@ -0,0 +1,82 @@
+#include "mosaicview.h"
+#include <QMouseEvent>
+
+MosaicView::MosaicView(QWidget *parent): QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+int MosaicView::addTile(VideoWidget *tile)
+{
+    tile->setParent(this);
+    tile->setMinimumSize(0, 0);
+    tile->installEventFilter(this);
+    tile->show();
+    m_tiles.append(tile);
+    relayout();
+    return m_tiles.size() - 1;
+}
+
+void MosaicView::setFocusedIndex(int index)
+{
+    if (index < 0 || index >= m_tiles.size() || index == m_focused)
+    {
+        return;
+    }
+    m_focused = index;
+    relayout();
+    emit focusChanged(index);
+}
+
+void MosaicView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    relayout();
+}
+
+bool MosaicView::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::MouseButtonPress)
+    {
+        const int index = m_tiles.indexOf(static_cast<VideoWidget *>(watched));
+        if (index >= 0 && index != m_focused)
+        {
+            setFocusedIndex(index);
+            return true;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void MosaicView::relayout()
+{
+    if (m_tiles.isEmpty())
+    {
+        return;
+    }
+    if (m_tiles.size() == 1)
+    {
+        m_tiles[0]->setGeometry(rect());
+        return;
+    }
+
+    // 焦点画面占左侧 3/4，其余画面在右侧等分高度
+    const int others = m_tiles.size() - 1;
+    const int sideWidth = width() / 4;
+    const QRect mainRect(0, 0, width() - sideWidth, height());
+    m_tiles[m_focused]->setGeometry(mainRect);
+
+    int slot = 0;
+    for (int i = 0; i < m_tiles.size(); i++)
+    {
+        if (i == m_focused)
+        {
+            continue;
+        }
+        const int top = height() * slot / others;
+        const int bottom = height() * (slot + 1) / others;
+        m_tiles[i]->setGeometry(mainRect.width(), top, sideWidth, bottom - top);
+        slot++;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef MOSAICVIEW_H
+#define MOSAICVIEW_H
+
+#include <QWidget>
+#include <QVector>
+#include "videowidget.h"
+
+/**
+ * @brief 多路摄像头的拼接显示
+ *
+ * 焦点画面占据左侧主区域，其余画面在右侧纵向排列；单击任一画面将其设为焦点。
+ * 只有一路时该路铺满整个区域。各画面仍是独立的 VideoWidget，
+ * 解码器按画面实际尺寸输出，小画面的颜色转换开销随之降低。
+ */
+class MosaicView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit MosaicView(QWidget *parent = nullptr);
+
+    /**
+     * @brief 添加一个画面，控件被重新设为本控件的子控件
+     * @return 画面序号
+     */
+    int addTile(VideoWidget *tile);
+
+    int tileCount() const { return m_tiles.size(); }
+    VideoWidget *tile(int index) const { return m_tiles.value(index); }
+
+    int focusedIndex() const { return m_focused; }
+    void setFocusedIndex(int index);
+
+signals:
+    /**
+     * @brief 焦点画面改变
+     */
+    void focusChanged(int index);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void relayout();
+
+    QVector<VideoWidget *> m_tiles;
+    int m_focused = 0;
+};
+
+#endif // MOSAICVIEW_H
@@ -56,23 +56,11 @@ void MQTTClient::connectToBroker()
 void MQTTClient::publish(const QString &topic, const nlohmann::json &params, const QString &method, const QString &id, const QString &version)
 {
     // 速率限制检查
-        {
-            QMutexLocker locker(&m_publishMutex);
-            QDateTime currentTime = QDateTime::currentDateTime();
-            // 移除时间窗口之外的时间戳
-            while (!m_publishTimestamps.isEmpty() &&
-                   m_publishTimestamps.head().msecsTo(currentTime) > timeWindowMs)
-            {
-                m_publishTimestamps.dequeue();
-            }
-            if (m_publishTimestamps.size() >= maxPublishPerSecond)
-            {
-                emit errorOccurred("[MQTT] 发布调用过于频繁，已达到速率限制。本次消息不予发布。", true);
-                return;
-            }
-            // 将当前调用时间记录到队列中
-            m_publishTimestamps.enqueue(currentTime);
-        }
+    if (!acquirePublishSlot(m_publishTimestamps, maxPublishPerSecond))
+    {
+        emit errorOccurred("[MQTT] 发布调用过于频繁，已达到速率限制。本次消息不予发布。", true);
+        return;
+    }
 
     try
     {
@@ -107,6 +95,59 @@ void MQTTClient::publish(const QString &topic, const nlohmann::json &params, con
     }
 }
 
+bool MQTTClient::acquirePublishSlot(QQueue<QDateTime> &timestamps, int maxCount)
+{
+    QMutexLocker locker(&m_publishMutex);
+    QDateTime currentTime = QDateTime::currentDateTime();
+    // 移除时间窗口之外的时间戳
+    while (!timestamps.isEmpty() && timestamps.head().msecsTo(currentTime) > timeWindowMs)
+    {
+        timestamps.dequeue();
+    }
+    if (timestamps.size() >= maxCount)
+    {
+        return false;
+    }
+    // 将当前调用时间记录到队列中
+    timestamps.enqueue(currentTime);
+    return true;
+}
+
+void MQTTClient::publishKeyframeRequest(int camera, const QString &id)
+{
+    if (!acquirePublishSlot(m_keyframeTimestamps, m_config.KEYFRAME_PUBLISH_MAX))
+    {
+        qWarning() << "[MQTT] keyframe request for camera" << camera << "dropped by rate limit";
+        return;
+    }
+    // 未连接时不在界面线程里同步重连，由自动重连恢复，解码器仍损坏时会再次请求
+    if (!m_client->is_connected())
+    {
+        qWarning() << "[MQTT] not connected, keyframe request for camera" << camera << "dropped";
+        return;
+    }
+
+    try
+    {
+        nlohmann::json params;
+        params["Camera_idr"]["value"] = camera;
+        nlohmann::json payload;
+        payload["id"] = id.toStdString();
+        payload["version"] = "1.0";
+        payload["params"] = params;
+        payload["method"] = "thing.event.property.post";
+
+        auto pubmsg = mqtt::make_message(m_config.TOPIC.toStdString(), payload.dump());
+        pubmsg->set_qos(1);
+        // 不等待确认：请求只关心尽快发出，丢失时按 KEYFRAME_REQUEST_INTERVAL_MS 重发
+        m_client->publish(pubmsg);
+    }
+    catch (const mqtt::exception &e)
+    {
+        qWarning() << "[MQTT] Keyframe request error:" << e.what();
+    }
+}
+
 void MQTTClient::publishMovementParams(const QString &topic, const QString &method, const QString &id, int angle, float speed, int current, int mode, const QString &version)
 {
     nlohmann::json params;
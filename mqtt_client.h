@@ -33,6 +33,14 @@ public:
     void publishMovementParams(const QString &topic, const QString &method, const QString &id, int angle, float speed, int current, int mode, const QString &version = "1.0");
     void publishMqttMessage(const std::map<QString, nlohmann::json>& fieldValues, const QString &id);
 
+    /**
+     * @brief 请求摄像头立即编码关键帧（解码损坏时自动发出）
+     *
+     * 与操作命令分开限速，不等待发布完成，超限或未连接时只记日志、不发 errorOccurred，
+     * 丢包期间既不会挤掉操作员的命令，也不会阻塞界面线程或弹出对话框。
+     */
+    void publishKeyframeRequest(int camera, const QString &id);
+
     void subscribe(const QString &topic, int qos = 1);
     void unsubscribe(const QString &topic);
 
@@ -46,6 +54,7 @@ private slots:
 
 private:
     void connectToBroker();
+    bool acquirePublishSlot(QQueue<QDateTime> &timestamps, int maxCount);
     void handleMessageArrived(mqtt::const_message_ptr msg);
 
     // 内部回调类
@@ -69,6 +78,7 @@ private:
     QQueue<QDateTime> m_publishTimestamps;  // 存储每次 publish 的时间戳
     int maxPublishPerSecond;         // 时间窗口内允许的最大发布数
     int timeWindowMs;                // 时间窗口，单位为毫秒，例如 1000 表示 1 秒
+    QQueue<QDateTime> m_keyframeTimestamps; // 关键帧请求的发布时间戳，与操作命令分开计数
 };
 
 #endif // MQTTCLIENT_H
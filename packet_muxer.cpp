@@ -0,0 +1,207 @@
+#include "packet_muxer.h"
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+PacketMuxer::~PacketMuxer()
+{
+    close();
+}
+
+QString PacketMuxer::extensionFor(const QString &format)
+{
+    if (format == "mkv" || format == "ts")
+    {
+        return format;
+    }
+    return "mp4";
+}
+
+bool PacketMuxer::open(const QString &path, const QString &format, const AVCodecParameters *par,
+                       AVRational timeBase, int ioBufferSize)
+{
+    close();
+    m_error.clear();
+    m_startTs = AV_NOPTS_VALUE;
+    m_lastDts = AV_NOPTS_VALUE;
+    m_bytesWritten = 0;
+    m_ioTimeUs = 0;
+    m_inputTimeBase = timeBase;
+
+    const char *muxer = format == "mkv" ? "matroska" : format == "ts" ? "mpegts" : "mp4";
+    m_file.setFileName(path);
+    // 自身已有大块缓冲，文件不再做二次缓冲
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    {
+        m_error = m_file.errorString();
+        return false;
+    }
+    if (avformat_alloc_output_context2(&m_formatCtx, nullptr, muxer, nullptr) < 0)
+    {
+        m_error = "Unsupported container format";
+        release();
+        return false;
+    }
+
+    AVStream *stream = avformat_new_stream(m_formatCtx, nullptr);
+    m_packet = av_packet_alloc();
+    unsigned char *buffer = static_cast<unsigned char *>(av_malloc(ioBufferSize));
+    if (!stream || !m_packet || !buffer)
+    {
+        av_free(buffer);
+        m_error = "Out of memory";
+        release();
+        return false;
+    }
+    avcodec_parameters_copy(stream->codecpar, par);
+    stream->codecpar->codec_tag = 0;    // 由目标容器选择合适的 tag
+    stream->time_base = timeBase;
+
+    m_ioCtx = avio_alloc_context(buffer, ioBufferSize, 1, this, nullptr, &PacketMuxer::writeCallback,
+                                 &PacketMuxer::seekCallback);
+    if (!m_ioCtx)
+    {
+        av_free(buffer);
+        m_error = "Out of memory";
+        release();
+        return false;
+    }
+    m_formatCtx->pb = m_ioCtx;
+    m_formatCtx->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    AVDictionary *options = nullptr;
+    if (format != "mkv" && format != "ts")
+    {
+        // 分片 MP4：不依赖结束时回写 moov，异常退出也能播放已写入的部分
+        av_dict_set(&options, "movflags", "+frag_keyframe+empty_moov+default_base_moof", 0);
+    }
+    const int ret = avformat_write_header(m_formatCtx, &options);
+    av_dict_free(&options);
+    if (ret < 0)
+    {
+        m_error = "Failed to write container header";
+        release();
+        return false;
+    }
+    return true;
+}
+
+bool PacketMuxer::write(const AVPacket *packet)
+{
+    if (!m_formatCtx || av_packet_ref(m_packet, packet) < 0)
+    {
+        return false;
+    }
+
+    // 以第一个包为零点
+    const int64_t ts = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+    if (m_startTs == AV_NOPTS_VALUE)
+    {
+        m_startTs = ts;
+    }
+    if (m_startTs != AV_NOPTS_VALUE)
+    {
+        if (m_packet->pts != AV_NOPTS_VALUE)
+        {
+            m_packet->pts -= m_startTs;
+        }
+        if (m_packet->dts != AV_NOPTS_VALUE)
+        {
+            m_packet->dts -= m_startTs;
+        }
+    }
+    m_packet->stream_index = 0;
+    m_packet->pos = -1;
+    av_packet_rescale_ts(m_packet, m_inputTimeBase, m_formatCtx->streams[0]->time_base);
+
+    // 容器要求 DTS 严格递增，推流端偶发的时间戳回退在此修正
+    if (m_packet->dts != AV_NOPTS_VALUE)
+    {
+        if (m_lastDts != AV_NOPTS_VALUE && m_packet->dts <= m_lastDts)
+        {
+            m_packet->dts = m_lastDts + 1;
+        }
+        if (m_packet->pts != AV_NOPTS_VALUE && m_packet->pts < m_packet->dts)
+        {
+            m_packet->pts = m_packet->dts;
+        }
+        m_lastDts = m_packet->dts;
+    }
+
+    const int ret = av_write_frame(m_formatCtx, m_packet);
+    av_packet_unref(m_packet);
+    return ret >= 0;
+}
+
+bool PacketMuxer::close()
+{
+    if (!m_formatCtx)
+    {
+        return true;
+    }
+    bool ok = av_write_trailer(m_formatCtx) >= 0;
+    avio_flush(m_ioCtx);
+    ok = ok && m_file.error() == QFileDevice::NoError;
+    release();
+    return ok;
+}
+
+void PacketMuxer::release()
+{
+    if (m_ioCtx)
+    {
+        av_freep(&m_ioCtx->buffer);
+        avio_context_free(&m_ioCtx);
+    }
+    if (m_formatCtx)
+    {
+        m_formatCtx->pb = nullptr;
+        avformat_free_context(m_formatCtx);
+        m_formatCtx = nullptr;
+    }
+    av_packet_free(&m_packet);
+    m_file.close();
+}
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+int PacketMuxer::writeCallback(void *opaque, const uint8_t *buf, int size)
+#else
+int PacketMuxer::writeCallback(void *opaque, uint8_t *buf, int size)
+#endif
+{
+    PacketMuxer *self = static_cast<PacketMuxer *>(opaque);
+    const qint64 beginUs = av_gettime_relative();
+    const qint64 written = self->m_file.write(reinterpret_cast<const char *>(buf), size);
+    self->m_ioTimeUs += av_gettime_relative() - beginUs;
+    if (written != size)
+    {
+        self->m_error = self->m_file.errorString();
+        return AVERROR(EIO);
+    }
+    self->m_bytesWritten += written;
+    return size;
+}
+
+int64_t PacketMuxer::seekCallback(void *opaque, int64_t offset, int whence)
+{
+    PacketMuxer *self = static_cast<PacketMuxer *>(opaque);
+    qint64 position = offset;
+    switch (whence & ~AVSEEK_FORCE)
+    {
+    case AVSEEK_SIZE:
+        return self->m_file.size();
+    case SEEK_SET:
+        break;
+    case SEEK_CUR:
+        position = self->m_file.pos() + offset;
+        break;
+    case SEEK_END:
+        position = self->m_file.size() + offset;
+        break;
+    default:
+        return -1;
+    }
+    return self->m_file.seek(position) ? position : -1;
+}
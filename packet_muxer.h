@@ -0,0 +1,78 @@
+#ifndef PACKETMUXER_H
+#define PACKETMUXER_H
+
+#include <QFile>
+#include <QString>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief 将压缩包直接封装写入文件（不转码）
+ *
+ * 输出经由自定义 AVIOContext 和大块缓冲区顺序写入，每次写盘为整块数据。
+ * 时间戳以第一个包为零点重新计算，每个文件都从 0 开始。
+ * 支持 mp4（分片写入，异常退出时只丢失最后一个分片）、mkv、ts。
+ */
+class PacketMuxer
+{
+public:
+    PacketMuxer() = default;
+    ~PacketMuxer();
+
+    PacketMuxer(const PacketMuxer &) = delete;
+    PacketMuxer &operator=(const PacketMuxer &) = delete;
+
+    /**
+     * @param format 容器格式：mp4 / mkv / ts
+     * @param ioBufferSize 写缓冲区字节数
+     */
+    bool open(const QString &path, const QString &format, const AVCodecParameters *par,
+              AVRational timeBase, int ioBufferSize);
+
+    /**
+     * @brief 写入一个包（不改变 packet 本身）
+     */
+    bool write(const AVPacket *packet);
+
+    /**
+     * @brief 写入文件尾并关闭文件
+     */
+    bool close();
+
+    bool isOpen() const { return m_formatCtx != nullptr; }
+    QString path() const { return m_file.fileName(); }
+    QString errorString() const { return m_error; }
+
+    qint64 bytesWritten() const { return m_bytesWritten; }
+    qint64 ioTimeUs() const { return m_ioTimeUs; }      // 实际写盘累计耗时
+
+    /**
+     * @brief 容器格式对应的文件扩展名
+     */
+    static QString extensionFor(const QString &format);
+
+private:
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+    static int writeCallback(void *opaque, const uint8_t *buf, int size);
+#else
+    static int writeCallback(void *opaque, uint8_t *buf, int size);
+#endif
+    static int64_t seekCallback(void *opaque, int64_t offset, int whence);
+    void release();
+
+    QFile m_file;
+    AVFormatContext *m_formatCtx = nullptr;
+    AVIOContext *m_ioCtx = nullptr;
+    AVPacket *m_packet = nullptr;       // 改写时间戳用的临时包（只增加引用）
+    AVRational m_inputTimeBase{1, 1000};
+    int64_t m_startTs = AV_NOPTS_VALUE;
+    int64_t m_lastDts = AV_NOPTS_VALUE;
+    qint64 m_bytesWritten = 0;
+    qint64 m_ioTimeUs = 0;
+    QString m_error;
+};
+
+#endif // PACKETMUXER_H
@@ -0,0 +1,224 @@
+#include "packet_queue.h"
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+PacketQueue::PacketQueue(int maxPackets, int latencyBudgetMs)
+    : m_maxPackets(maxPackets), m_latencyBudgetMs(latencyBudgetMs)
+{
+}
+
+PacketQueue::~PacketQueue()
+{
+    QMutexLocker locker(&m_mutex);
+    clearLocked();
+}
+
+void PacketQueue::reset(AVRational timeBase)
+{
+    QMutexLocker locker(&m_mutex);
+    clearLocked();
+    m_timeBase = timeBase;
+    m_waitKeyframe = true;
+    m_finished = false;
+    m_aborted = false;
+}
+
+bool PacketQueue::push(AVPacket *packet)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_aborted || m_finished)
+    {
+        return false;
+    }
+
+    const bool isKey = packet->flags & AV_PKT_FLAG_KEY;
+    if (m_waitKeyframe)
+    {
+        if (!isKey)
+        {
+            m_stats.dropped++;
+            return false;
+        }
+        m_waitKeyframe = false;
+    }
+
+    // 超过包数或时长上限：丢弃积压，等待下一个关键帧
+    bool overflow = static_cast<int>(m_entries.size()) >= m_maxPackets;
+    if (!overflow && m_latencyBudgetMs > 0 && !m_entries.empty())
+    {
+        overflow = bufferedMsLocked() > m_latencyBudgetMs;
+    }
+    if (overflow)
+    {
+        m_stats.overflows++;
+        m_stats.dropped += m_entries.size();
+        clearLocked();
+        if (!isKey)
+        {
+            m_waitKeyframe = true;
+            m_stats.dropped++;
+            return false;
+        }
+    }
+
+    AVPacket *entry = av_packet_alloc();
+    if (!entry)
+    {
+        m_stats.dropped++;
+        return false;
+    }
+    av_packet_move_ref(entry, packet);
+    m_entries.push_back({entry, av_gettime_relative()});
+
+    m_stats.pushed++;
+    const int depth = static_cast<int>(m_entries.size());
+    if (depth > m_stats.maxDepth)
+    {
+        m_stats.maxDepth = depth;
+    }
+    m_notEmpty.wakeOne();
+    return true;
+}
+
+int PacketQueue::pop(AVPacket *packet, int timeoutMs, qint64 *enqueueUs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_entries.empty() && !m_aborted && !m_finished)
+    {
+        // 队列为空时阻塞等待，不再空转
+        const qint64 waitStart = av_gettime_relative();
+        m_notEmpty.wait(&m_mutex, static_cast<unsigned long>(timeoutMs));
+        m_stats.consumerWaitMs += (av_gettime_relative() - waitStart) / 1000.0;
+    }
+    if (m_aborted)
+    {
+        return -1;
+    }
+    if (m_entries.empty())
+    {
+        return m_finished ? -1 : 0;
+    }
+
+    Entry entry = m_entries.front();
+    m_entries.pop_front();
+    av_packet_move_ref(packet, entry.packet);
+    av_packet_free(&entry.packet);
+    if (enqueueUs)
+    {
+        *enqueueUs = entry.enqueueUs;
+    }
+
+    const double waitMs = (av_gettime_relative() - entry.enqueueUs) / 1000.0;
+    m_totalQueueWaitMs += waitMs;
+    if (waitMs > m_stats.maxQueueWaitMs)
+    {
+        m_stats.maxQueueWaitMs = waitMs;
+    }
+    m_stats.popped++;
+    return 1;
+}
+
+void PacketQueue::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+    m_notEmpty.wakeAll();
+}
+
+void PacketQueue::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    m_aborted = true;
+    m_notEmpty.wakeAll();
+}
+
+int PacketQueue::flushToKeyframe(bool holdingKeyframe, bool *restartFromHeld)
+{
+    QMutexLocker locker(&m_mutex);
+    if (restartFromHeld)
+    {
+        *restartFromHeld = false;
+    }
+    size_t keep = m_entries.size();
+    for (size_t i = m_entries.size(); i > 0; i--)
+    {
+        if (m_entries[i - 1].packet->flags & AV_PKT_FLAG_KEY)
+        {
+            keep = i - 1;
+            break;
+        }
+    }
+
+    if (keep == m_entries.size() && holdingKeyframe)
+    {
+        // 调用方手中的关键帧是最新的，排队的包都在它之后，保留
+        if (restartFromHeld)
+        {
+            *restartFromHeld = true;
+        }
+        return 0;
+    }
+    if (keep == m_entries.size())
+    {
+        // 队列中没有关键帧，全部丢弃并等待下一个
+        const int dropped = static_cast<int>(m_entries.size());
+        m_stats.dropped += dropped;
+        clearLocked();
+        m_waitKeyframe = true;
+        return dropped;
+    }
+
+    for (size_t i = 0; i < keep; i++)
+    {
+        av_packet_free(&m_entries[i].packet);
+    }
+    m_entries.erase(m_entries.begin(), m_entries.begin() + static_cast<std::ptrdiff_t>(keep));
+    m_stats.dropped += keep;
+    return static_cast<int>(keep);
+}
+
+int PacketQueue::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_entries.size());
+}
+
+PacketQueue::Stats PacketQueue::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    Stats s = m_stats;
+    s.depth = static_cast<int>(m_entries.size());
+    s.bufferedMs = bufferedMsLocked();
+    s.avgQueueWaitMs = m_stats.popped ? m_totalQueueWaitMs / m_stats.popped : 0;
+    return s;
+}
+
+void PacketQueue::clearLocked()
+{
+    for (Entry &entry : m_entries)
+    {
+        av_packet_free(&entry.packet);
+    }
+    m_entries.clear();
+}
+
+double PacketQueue::bufferedMsLocked() const
+{
+    if (m_entries.size() < 2)
+    {
+        return 0;
+    }
+    const AVPacket *first = m_entries.front().packet;
+    const AVPacket *last = m_entries.back().packet;
+    const int64_t firstTs = first->dts != AV_NOPTS_VALUE ? first->dts : first->pts;
+    const int64_t lastTs = last->dts != AV_NOPTS_VALUE ? last->dts : last->pts;
+    if (firstTs == AV_NOPTS_VALUE || lastTs == AV_NOPTS_VALUE)
+    {
+        // 没有时间戳时按停留时间估算
+        return (av_gettime_relative() - m_entries.front().enqueueUs) / 1000.0;
+    }
+    return (lastTs - firstTs) * av_q2d(m_timeBase) * 1000.0;
+}
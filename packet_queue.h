@@ -0,0 +1,125 @@
+#ifndef PACKETQUEUE_H
+#define PACKETQUEUE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 读取线程与解码线程之间的有界压缩包队列
+ *
+ * 队列按包数量和缓冲时长（按 PTS 计算）双重限制。超过任一上限时，
+ * 丢弃已排队的全部包并继续丢弃新包直到下一个关键帧，
+ * 使解码端总是从关键帧重新开始，避免在积压上继续累积延迟。
+ */
+class PacketQueue
+{
+public:
+    /**
+     * @brief 队列统计信息
+     */
+    struct Stats
+    {
+        int depth = 0;              // 当前排队包数
+        int maxDepth = 0;           // 历史最大排队包数
+        double bufferedMs = 0;      // 当前排队内容的时长
+        quint64 pushed = 0;         // 入队包数
+        quint64 popped = 0;         // 出队包数
+        quint64 dropped = 0;        // 因超限丢弃的包数
+        quint64 overflows = 0;      // 触发“丢弃到关键帧”的次数
+        double avgQueueWaitMs = 0;  // 包在队列中的平均停留时间
+        double maxQueueWaitMs = 0;  // 包在队列中的最大停留时间
+        double consumerWaitMs = 0;  // 解码端因队列为空累计等待的时间
+    };
+
+    /**
+     * @param maxPackets 最大排队包数
+     * @param latencyBudgetMs 最大缓冲时长，<= 0 表示不按时长限制
+     */
+    PacketQueue(int maxPackets, int latencyBudgetMs);
+    ~PacketQueue();
+
+    PacketQueue(const PacketQueue &) = delete;
+    PacketQueue &operator=(const PacketQueue &) = delete;
+
+    /**
+     * @brief 清空队列并重新开始（新的流开始前调用）
+     * @param timeBase 包时间戳的时间基，用于计算缓冲时长
+     */
+    void reset(AVRational timeBase);
+
+    /**
+     * @brief 入队，成功时接管 packet 的数据引用（packet 被置空）
+     * @return 被丢弃时返回 false，packet 保持不变由调用方释放
+     */
+    bool push(AVPacket *packet);
+
+    /**
+     * @brief 出队
+     * @param packet 输出包，调用方负责 av_packet_unref
+     * @param timeoutMs 队列为空时的最长等待时间
+     * @param enqueueUs 可选，输出该包入队时的单调时钟时间（微秒）
+     * @return 1 取得数据；0 超时；-1 队列已中止或已结束且为空
+     */
+    int pop(AVPacket *packet, int timeoutMs, qint64 *enqueueUs = nullptr);
+
+    /**
+     * @brief 标记输入结束，排空后 pop 返回 -1
+     */
+    void finish();
+
+    /**
+     * @brief 立即中止，唤醒所有等待者
+     */
+    void abort();
+
+    /**
+     * @brief 丢弃到最新的关键帧
+     *
+     * 队列中有关键帧时保留最后一个关键帧及其后的包。否则若调用方刚取出的包就是关键帧，
+     * 它即为最新的关键帧：队列保持不变，由调用方从该包重新开始解码；
+     * 两者都没有时丢弃全部排队包，并丢弃后续包直到下一个关键帧。
+     * @param holdingKeyframe 调用方刚取出（尚未送入解码器）的包是否为关键帧
+     * @param restartFromHeld 可选，输出调用方是否应保留手中的包并从它重新开始
+     * @return 丢弃的包数（不含调用方手中的包）
+     */
+    int flushToKeyframe(bool holdingKeyframe = false, bool *restartFromHeld = nullptr);
+
+    /**
+     * @brief 当前排队包数
+     */
+    int size() const;
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        AVPacket *packet;
+        qint64 enqueueUs;
+    };
+
+    void clearLocked();
+    double bufferedMsLocked() const;
+
+    const int m_maxPackets;
+    const int m_latencyBudgetMs;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    std::deque<Entry> m_entries;
+    AVRational m_timeBase{1, 1000};
+    bool m_waitKeyframe = true;     // 新流总是从关键帧开始
+    bool m_finished = false;
+    bool m_aborted = false;
+
+    Stats m_stats;
+    double m_totalQueueWaitMs = 0;
+};
+
+#endif // PACKETQUEUE_H
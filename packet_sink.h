@@ -0,0 +1,35 @@
+#ifndef PACKETSINK_H
+#define PACKETSINK_H
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 压缩包旁路接收端（录像、预录缓冲等）
+ *
+ * 由 VideoDecoder 的读取线程在包进入解码队列之前调用，收到的是读取到的全部视频包，
+ * 不受解码端丢帧影响。只转发视频流：音频包只交给音频解码分支，录像和预录片段中没有声音
+ * （FLV 的音频流在读到第一个音频包时才出现，此时容器头可能已经写出）。各方法都必须立即返回，不得阻塞读取线程；
+ * 需要保留数据时用 av_packet_ref 增加引用，不拷贝数据。
+ */
+class PacketSink
+{
+public:
+    virtual ~PacketSink() = default;
+
+    /**
+     * @brief 新的连接开始（或加入时已在解码），参数在调用期间有效
+     */
+    virtual void beginStream(const AVCodecParameters *par, AVRational timeBase) = 0;
+
+    virtual void writePacket(const AVPacket *packet) = 0;
+
+    /**
+     * @brief 连接结束（断线、停止或被移除）
+     */
+    virtual void endStream() = 0;
+};
+
+#endif // PACKETSINK_H
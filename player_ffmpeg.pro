@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui multimedia
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -39,26 +39,69 @@ QMAKE_LFLAGS += -Wl,-rpath,/opt/EmbedSky/TQ3588/toolchain/aarch64-buildroot-linu
 
 
 SOURCES += \
+    audio_decoder.cpp \
+    audio_output.cpp \
+    byte_ring.cpp \
+    catch_up_controller.cpp \
+    convert_worker_pool.cpp \
+    decoder_profile.cpp \
+    frame_mailbox.cpp \
+    frame_pool.cpp \
+    frame_presenter.cpp \
+    input_source.cpp \
+    latency_tracer.cpp \
     main.cpp \
     mainwindow.cpp \
+    mosaicview.cpp \
     mqtt_client.cpp \
     numberpaddialog.cpp \
     operatingarea.cpp \
     operatingareaflick.cpp \
+    packet_muxer.cpp \
+    packet_queue.cpp \
+    pre_roll_buffer.cpp \
     showwidget.cpp \
+    snapshot_capture.cpp \
+    stream_probe_cache.cpp \
+    stream_recorder.cpp \
+    stream_transport.cpp \
+    sws_context_cache.cpp \
     video_decoder.cpp \
-    videowidget.cpp
+    videowidget.cpp \
+    yuv_convert.cpp
 
 HEADERS += \
+    audio_decoder.h \
+    audio_output.h \
+    byte_ring.h \
+    catch_up_controller.h \
     config.h \
+    convert_worker_pool.h \
+    decoder_profile.h \
+    frame_mailbox.h \
+    frame_pool.h \
+    frame_presenter.h \
+    input_source.h \
+    latency_tracer.h \
     mainwindow.h \
+    mosaicview.h \
     mqtt_client.h \
     numberpaddialog.h \
     operatingarea.h \
     operatingareaflick.h \
+    packet_muxer.h \
+    packet_queue.h \
+    packet_sink.h \
+    pre_roll_buffer.h \
     showwidget.h \
+    snapshot_capture.h \
+    stream_probe_cache.h \
+    stream_recorder.h \
+    stream_transport.h \
+    sws_context_cache.h \
     video_decoder.h \
-    videowidget.h
+    videowidget.h \
+    yuv_convert.h
 
 FORMS += \
     mainwindow.ui \
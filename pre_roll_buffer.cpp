@@ -0,0 +1,295 @@
+#include "pre_roll_buffer.h"
+#include "packet_muxer.h"
+#include "stream_probe_cache.h"
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+namespace
+{
+const int kExportIoBufferSize = 1024 * 1024;
+
+int64_t packetTs(const AVPacket *packet)
+{
+    return packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+}
+}
+
+PreRollBuffer::PreRollBuffer(qint64 maxBytes, int maxSeconds, QObject *parent)
+    : QObject(parent), m_maxBytes(maxBytes), m_maxSeconds(maxSeconds)
+{
+    m_exportThread = std::thread(&PreRollBuffer::exportLoop, this);
+}
+
+PreRollBuffer::~PreRollBuffer()
+{
+    // 已提交的导出全部完成后再退出
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_hasJob.wakeAll();
+    }
+    m_exportThread.join();
+    clearLocked();
+    avcodec_parameters_free(&m_par);
+}
+
+void PreRollBuffer::freeGop(Gop &gop)
+{
+    for (AVPacket *&packet : gop.packets)
+    {
+        av_packet_free(&packet);
+    }
+    gop.packets.clear();
+    gop.bytes = 0;
+}
+
+void PreRollBuffer::freeJob(ExportJob &job)
+{
+    for (AVPacket *&packet : job.packets)
+    {
+        av_packet_free(&packet);
+    }
+    job.packets.clear();
+    avcodec_parameters_free(&job.par);
+}
+
+void PreRollBuffer::clearLocked()
+{
+    for (Gop &gop : m_gops)
+    {
+        freeGop(gop);
+    }
+    m_gops.clear();
+    m_bytes = 0;
+    m_tsOffset = 0;
+    m_lastDts = AV_NOPTS_VALUE;
+}
+
+void PreRollBuffer::beginStream(const AVCodecParameters *par, AVRational timeBase)
+{
+    QMutexLocker locker(&m_mutex);
+    // 参数或时间基变化后旧内容无法与新内容封装在同一文件中
+    if (m_par && (!StreamProbeCache::matches(m_par, par) || av_cmp_q(m_timeBase, timeBase) != 0))
+    {
+        clearLocked();
+    }
+    if (!m_par)
+    {
+        m_par = avcodec_parameters_alloc();
+    }
+    if (!m_par || avcodec_parameters_copy(m_par, par) < 0)
+    {
+        avcodec_parameters_free(&m_par);
+        clearLocked();
+        return;
+    }
+    m_timeBase = timeBase;
+    m_streamActive = true;
+    m_waitKeyframe = true;
+    // 重连后保留断线前的内容，新连接的时间戳接在其后
+    m_rebaseTs = !m_gops.empty();
+}
+
+void PreRollBuffer::writePacket(const AVPacket *packet)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_streamActive)
+    {
+        return;
+    }
+    if (packet->flags & AV_PKT_FLAG_KEY)
+    {
+        m_gops.emplace_back();
+        m_waitKeyframe = false;
+    }
+    else if (m_waitKeyframe)
+    {
+        return;
+    }
+
+    AVPacket *copy = av_packet_alloc();
+    if (!copy || av_packet_ref(copy, packet) < 0)
+    {
+        av_packet_free(&copy);
+        return;
+    }
+    const int64_t ts = packetTs(copy);
+    if (m_rebaseTs && ts != AV_NOPTS_VALUE)
+    {
+        m_rebaseTs = false;
+        m_tsOffset = m_lastDts != AV_NOPTS_VALUE ? m_lastDts + qMax<int64_t>(copy->duration, 1) - ts : 0;
+    }
+    if (copy->pts != AV_NOPTS_VALUE)
+    {
+        copy->pts += m_tsOffset;
+    }
+    if (copy->dts != AV_NOPTS_VALUE)
+    {
+        copy->dts += m_tsOffset;
+    }
+    if (ts != AV_NOPTS_VALUE)
+    {
+        m_lastDts = packetTs(copy);
+    }
+
+    // 计入包结构本身的开销，缓冲大量小包时上限同样有效
+    const qint64 cost = copy->size + static_cast<qint64>(sizeof(AVPacket));
+    Gop &gop = m_gops.back();
+    gop.packets.push_back(copy);
+    gop.bytes += cost;
+    m_bytes += cost;
+    if (gop.bytes > m_maxBytes)
+    {
+        // 单个 GOP 就超过上限：整组丢弃，等待下一个关键帧
+        m_bytes -= gop.bytes;
+        freeGop(gop);
+        m_gops.pop_back();
+        m_oversizedGops++;
+        m_waitKeyframe = true;
+        return;
+    }
+    evictLocked();
+    m_peakBytes = qMax(m_peakBytes, m_bytes);
+}
+
+void PreRollBuffer::endStream()
+{
+    // 断线前的内容保留，仍可导出
+    QMutexLocker locker(&m_mutex);
+    m_streamActive = false;
+}
+
+qint64 PreRollBuffer::spanUsLocked(size_t fromGop) const
+{
+    if (fromGop >= m_gops.size() || m_gops[fromGop].packets.empty() || m_lastDts == AV_NOPTS_VALUE)
+    {
+        return 0;
+    }
+    const int64_t startTs = packetTs(m_gops[fromGop].packets.front());
+    return startTs != AV_NOPTS_VALUE ? av_rescale_q(m_lastDts - startTs, m_timeBase, AV_TIME_BASE_Q) : 0;
+}
+
+void PreRollBuffer::evictLocked()
+{
+    // 至少保留正在写入的 GOP；按时长淘汰时保证剩余内容仍覆盖 maxSeconds
+    const qint64 maxSpanUs = static_cast<qint64>(m_maxSeconds) * 1000000;
+    while (m_gops.size() > 1 &&
+           (m_bytes > m_maxBytes || (m_maxSeconds > 0 && spanUsLocked(1) >= maxSpanUs)))
+    {
+        m_bytes -= m_gops.front().bytes;
+        freeGop(m_gops.front());
+        m_gops.pop_front();
+        m_evictedGops++;
+    }
+}
+
+bool PreRollBuffer::exportClip(const QString &path, const QString &format, int seconds)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_gops.empty() || !m_par)
+    {
+        return false;
+    }
+
+    // 从覆盖所需时长的最近一个 GOP 开始
+    size_t first = 0;
+    if (seconds > 0)
+    {
+        const qint64 wantUs = static_cast<qint64>(seconds) * 1000000;
+        first = m_gops.size() - 1;
+        while (first > 0 && spanUsLocked(first) < wantUs)
+        {
+            first--;
+        }
+    }
+
+    ExportJob job;
+    job.path = path;
+    job.format = format;
+    job.timeBase = m_timeBase;
+    job.par = avcodec_parameters_alloc();
+    if (!job.par || avcodec_parameters_copy(job.par, m_par) < 0)
+    {
+        freeJob(job);
+        return false;
+    }
+    // 只增加引用，不拷贝数据
+    for (size_t i = first; i < m_gops.size(); i++)
+    {
+        for (const AVPacket *packet : m_gops[i].packets)
+        {
+            AVPacket *ref = av_packet_alloc();
+            if (ref && av_packet_ref(ref, packet) >= 0)
+            {
+                job.packets.push_back(ref);
+            }
+            else
+            {
+                av_packet_free(&ref);
+            }
+        }
+    }
+    m_jobs.push_back(std::move(job));
+    m_hasJob.wakeOne();
+    return true;
+}
+
+void PreRollBuffer::exportLoop()
+{
+    for (;;)
+    {
+        ExportJob job;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stopping && m_jobs.empty())
+            {
+                m_hasJob.wait(&m_mutex);
+            }
+            if (m_jobs.empty())
+            {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        runExport(job);
+        freeJob(job);
+    }
+}
+
+void PreRollBuffer::runExport(ExportJob &job)
+{
+    const qint64 beginUs = av_gettime_relative();
+    PacketMuxer muxer;
+    bool ok = muxer.open(job.path, job.format, job.par, job.timeBase, kExportIoBufferSize);
+    for (size_t i = 0; ok && i < job.packets.size(); i++)
+    {
+        ok = muxer.write(job.packets[i]);
+    }
+    const QString error = muxer.errorString();
+    ok = muxer.close() && ok;
+    m_lastExportUs.store(av_gettime_relative() - beginUs, std::memory_order_relaxed);
+    (ok ? m_exports : m_exportFailures).fetch_add(1, std::memory_order_relaxed);
+    emit clipExported(job.path, ok, error);
+}
+
+PreRollBuffer::Stats PreRollBuffer::stats() const
+{
+    Stats s;
+    {
+        QMutexLocker locker(&m_mutex);
+        s.gops = static_cast<int>(m_gops.size());
+        s.bufferedMB = m_bytes / (1024.0 * 1024.0);
+        s.peakMB = m_peakBytes / (1024.0 * 1024.0);
+        s.bufferedSeconds = spanUsLocked(0) / 1e6;
+        s.evictedGops = m_evictedGops;
+        s.oversizedGops = m_oversizedGops;
+    }
+    s.exports = m_exports.load(std::memory_order_relaxed);
+    s.exportFailures = m_exportFailures.load(std::memory_order_relaxed);
+    s.lastExportMs = m_lastExportUs.load(std::memory_order_relaxed) / 1000.0;
+    return s;
+}
@@ -0,0 +1,124 @@
+#ifndef PREROLLBUFFER_H
+#define PREROLLBUFFER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "packet_sink.h"
+
+/**
+ * @brief 内存中的预录环形缓冲，保留最近一段时间的压缩包，可随时导出为片段
+ *
+ * 以 GOP（关键帧及其后的包）为单位保存，总字节数超过上限或时长超过
+ * maxSeconds 时整组淘汰最旧的 GOP，导出的片段总是从关键帧开始。
+ * 单个 GOP 就超过上限时丢弃该 GOP 并等待下一个关键帧，内存占用不随码率突增而增长。
+ * 导出只对缓冲中的包增加引用，封装写盘在后台线程完成，不影响读取与解码。
+ * 只缓冲视频流，导出的片段没有音轨（见 PacketSink）。
+ */
+class PreRollBuffer : public QObject, public PacketSink
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief 预录缓冲统计信息
+     */
+    struct Stats
+    {
+        int gops = 0;                   // 当前缓冲的 GOP 数
+        double bufferedMB = 0;          // 当前缓冲的数据量
+        double peakMB = 0;              // 历史最大缓冲数据量
+        double bufferedSeconds = 0;     // 当前缓冲覆盖的时长
+        quint64 evictedGops = 0;        // 淘汰的 GOP 数
+        quint64 oversizedGops = 0;      // 因单组超限被丢弃的 GOP 数
+        quint64 exports = 0;            // 成功导出的片段数
+        quint64 exportFailures = 0;     // 导出失败次数
+        double lastExportMs = 0;        // 最近一次导出（封装写盘）耗时
+    };
+
+    /**
+     * @param maxBytes 缓冲字节数上限
+     * @param maxSeconds 缓冲时长上限，<= 0 表示只按字节数限制
+     */
+    PreRollBuffer(qint64 maxBytes, int maxSeconds, QObject *parent = nullptr);
+    ~PreRollBuffer() override;
+
+    void beginStream(const AVCodecParameters *par, AVRational timeBase) override;
+    void writePacket(const AVPacket *packet) override;
+    void endStream() override;
+
+    /**
+     * @brief 将缓冲内容导出为文件，立即返回，完成后发出 clipExported
+     * @param format 容器格式：mp4 / mkv / ts
+     * @param seconds 只导出最近的秒数（从其之前最近的关键帧开始），<= 0 表示全部
+     * @return 缓冲为空时返回 false
+     */
+    bool exportClip(const QString &path, const QString &format, int seconds = 0);
+
+    Stats stats() const;
+
+signals:
+    /**
+     * @brief 片段导出完成（在导出线程发出）
+     */
+    void clipExported(const QString &path, bool ok, const QString &error);
+
+private:
+    struct Gop
+    {
+        std::vector<AVPacket *> packets;
+        qint64 bytes = 0;
+    };
+
+    struct ExportJob
+    {
+        QString path;
+        QString format;
+        AVCodecParameters *par = nullptr;
+        AVRational timeBase{1, 1000};
+        std::vector<AVPacket *> packets;
+    };
+
+    static void freeGop(Gop &gop);
+    static void freeJob(ExportJob &job);
+    void clearLocked();
+    void evictLocked();
+    qint64 spanUsLocked(size_t fromGop) const;
+    void exportLoop();
+    void runExport(ExportJob &job);
+
+    const qint64 m_maxBytes;
+    const int m_maxSeconds;
+
+    mutable QMutex m_mutex;
+    std::deque<Gop> m_gops;
+    qint64 m_bytes = 0;
+    AVCodecParameters *m_par = nullptr;     // 缓冲内容对应的流参数
+    AVRational m_timeBase{1, 1000};
+    bool m_streamActive = false;
+    bool m_waitKeyframe = true;
+    bool m_rebaseTs = false;                // 重连后第一个包需重新计算时间戳偏移
+    int64_t m_tsOffset = 0;                 // 重连后续接时间戳的偏移（m_timeBase 单位）
+    int64_t m_lastDts = AV_NOPTS_VALUE;     // 已缓冲的最后一个包的 DTS（已加偏移）
+
+    // 导出线程
+    QWaitCondition m_hasJob;
+    std::deque<ExportJob> m_jobs;
+    bool m_stopping = false;
+    std::thread m_exportThread;
+
+    // 统计信息
+    qint64 m_peakBytes = 0;
+    quint64 m_evictedGops = 0;
+    quint64 m_oversizedGops = 0;
+    std::atomic<quint64> m_exports{0};
+    std::atomic<quint64> m_exportFailures{0};
+    std::atomic<qint64> m_lastExportUs{0};
+};
+
+#endif // PREROLLBUFFER_H
@@ -0,0 +1,194 @@
+#include "snapshot_capture.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+
+#ifdef Q_OS_LINUX
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+SnapshotCapture::SnapshotCapture(int quality, QObject *parent)
+    : QObject(parent), m_quality(quality)
+{
+    m_thread = std::thread(&SnapshotCapture::workerLoop, this);
+}
+
+SnapshotCapture::~SnapshotCapture()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_hasJob.wakeAll();
+    }
+    m_thread.join();
+    // 已入队的帧已由工作线程处理完；尚未等到帧的截图请求不再执行，计入跳过
+    int untaken = 0;
+    for (const Burst &burst : m_bursts)
+    {
+        untaken += burst.count - burst.taken;
+    }
+    if (untaken > 0)
+    {
+        m_skipped.fetch_add(static_cast<quint64>(untaken), std::memory_order_relaxed);
+        qWarning() << "Snapshot: stopped with" << untaken << "requested shots not taken";
+    }
+    sws_freeContext(m_swsCtx);
+}
+
+void SnapshotCapture::request(const QString &basePath, const QString &format, int count, int intervalMs)
+{
+    Burst burst;
+    burst.basePath = basePath;
+    burst.format = format;
+    burst.count = qMax(1, count);
+    burst.intervalUs = static_cast<qint64>(qMax(0, intervalMs)) * 1000;
+    QMutexLocker locker(&m_mutex);
+    m_bursts.push_back(burst);
+    m_requested.fetch_add(burst.count, std::memory_order_relaxed);
+    m_pending.store(true, std::memory_order_release);
+}
+
+bool SnapshotCapture::wantsFrame(qint64 nowUs)
+{
+    if (!m_pending.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    return !m_bursts.empty() && nowUs >= m_bursts.front().nextDueUs;
+}
+
+void SnapshotCapture::submit(const AVFrame *frame, qint64 nowUs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_bursts.empty())
+    {
+        return;
+    }
+    Burst &burst = m_bursts.front();
+    const int index = burst.taken++;
+    burst.nextDueUs = nowUs + burst.intervalUs;
+
+    Job job;
+    job.format = burst.format;
+    job.path = (burst.count > 1 ? QString("%1_%2").arg(burst.basePath).arg(index + 1) : burst.basePath) + "." +
+               burst.format;
+    if (burst.taken >= burst.count)
+    {
+        m_bursts.pop_front();
+        m_pending.store(!m_bursts.empty(), std::memory_order_release);
+    }
+
+    // 编码跟不上时跳过，解码线程不等待
+    if (static_cast<int>(m_jobs.size()) >= kMaxQueued)
+    {
+        m_skipped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    job.frame = av_frame_alloc();
+    if (!job.frame || av_frame_ref(job.frame, frame) < 0)
+    {
+        av_frame_free(&job.frame);
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    job.queueLength = static_cast<int>(m_jobs.size());
+    m_jobs.push_back(job);
+    const int length = static_cast<int>(m_jobs.size());
+    if (length > m_maxQueueLength.load(std::memory_order_relaxed))
+    {
+        m_maxQueueLength.store(length, std::memory_order_relaxed);
+    }
+    m_hasJob.wakeOne();
+}
+
+void SnapshotCapture::workerLoop()
+{
+#ifdef Q_OS_LINUX
+    // 截图不是实时任务，降低本线程的调度优先级，让出 CPU 给解码与显示
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+    for (;;)
+    {
+        Job job;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stopping && m_jobs.empty())
+            {
+                m_hasJob.wait(&m_mutex);
+            }
+            // 停止时先把已入队的帧（最多 kMaxQueued 张）编码保存完再退出
+            if (m_jobs.empty())
+            {
+                return;
+            }
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        const qint64 beginUs = av_gettime_relative();
+        const bool ok = encode(job);
+        const qint64 encodeUs = av_gettime_relative() - beginUs;
+        av_frame_free(&job.frame);
+
+        m_lastEncodeUs.store(encodeUs, std::memory_order_relaxed);
+        m_encodeUsTotal.fetch_add(static_cast<quint64>(encodeUs), std::memory_order_relaxed);
+        (ok ? m_saved : m_failed).fetch_add(1, std::memory_order_relaxed);
+        emit snapshotSaved(job.path, ok, encodeUs / 1000.0, job.queueLength);
+    }
+}
+
+bool SnapshotCapture::encode(const Job &job)
+{
+    const AVFrame *frame = job.frame;
+    if (frame->width <= 0 || frame->height <= 0)
+    {
+        return false;
+    }
+    // 原始分辨率转换为 RGB24，不缩放
+    m_swsCtx = sws_getCachedContext(m_swsCtx, frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                    frame->width, frame->height, AV_PIX_FMT_RGB24, SWS_BILINEAR, nullptr, nullptr,
+                                    nullptr);
+    if (!m_swsCtx)
+    {
+        return false;
+    }
+    QImage image(frame->width, frame->height, QImage::Format_RGB888);
+    if (image.isNull())
+    {
+        return false;
+    }
+    uint8_t *dstData[4] = {image.bits(), nullptr, nullptr, nullptr};
+    int dstLinesize[4] = {static_cast<int>(image.bytesPerLine()), 0, 0, 0};
+    sws_scale(m_swsCtx, frame->data, frame->linesize, 0, frame->height, dstData, dstLinesize);
+
+    QDir().mkpath(QFileInfo(job.path).absolutePath());
+    const bool png = job.format.compare("png", Qt::CaseInsensitive) == 0;
+    return image.save(job.path, png ? "PNG" : "JPG", png ? -1 : m_quality);
+}
+
+SnapshotCapture::Stats SnapshotCapture::stats() const
+{
+    Stats s;
+    {
+        QMutexLocker locker(&m_mutex);
+        s.queueLength = static_cast<int>(m_jobs.size());
+    }
+    s.requested = m_requested.load(std::memory_order_relaxed);
+    s.saved = m_saved.load(std::memory_order_relaxed);
+    s.failed = m_failed.load(std::memory_order_relaxed);
+    s.skipped = m_skipped.load(std::memory_order_relaxed);
+    s.maxQueueLength = m_maxQueueLength.load(std::memory_order_relaxed);
+    s.lastEncodeMs = m_lastEncodeUs.load(std::memory_order_relaxed) / 1000.0;
+    const quint64 done = s.saved + s.failed;
+    s.avgEncodeMs = done ? m_encodeUsTotal.load(std::memory_order_relaxed) / 1000.0 / done : 0;
+    return s;
+}
@@ -0,0 +1,126 @@
+#ifndef SNAPSHOTCAPTURE_H
+#define SNAPSHOTCAPTURE_H
+
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <thread>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief 原始分辨率截图（支持连拍）
+ *
+ * 解码线程对到期的解码帧只做 av_frame_ref 后入队，颜色转换与 JPEG/PNG 编码
+ * 在低优先级的工作线程中完成，不影响实时画面。截图取自解码输出，
+ * 为原始分辨率，与显示端缩放后的尺寸无关。待编码的帧数有上限，
+ * 超过时跳过本次截图而不是阻塞解码线程。析构时先保存完已入队的帧再退出。
+ */
+class SnapshotCapture : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief 截图统计信息
+     */
+    struct Stats
+    {
+        quint64 requested = 0;      // 请求的截图张数
+        quint64 saved = 0;          // 成功保存的张数
+        quint64 failed = 0;         // 转换或保存失败的张数
+        quint64 skipped = 0;        // 因待编码队列已满、或停止时尚未取到帧而跳过的张数
+        int queueLength = 0;        // 当前待编码的帧数
+        int maxQueueLength = 0;     // 历史最大待编码帧数
+        double lastEncodeMs = 0;    // 最近一张的转换加编码耗时
+        double avgEncodeMs = 0;     // 平均转换加编码耗时
+    };
+
+    /**
+     * @param quality JPEG 质量（0-100），PNG 时忽略
+     */
+    explicit SnapshotCapture(int quality = 90, QObject *parent = nullptr);
+    ~SnapshotCapture() override;
+
+    /**
+     * @brief 请求截图（任意线程调用），从下一帧解码输出开始
+     * @param basePath 不含扩展名的文件路径，连拍时追加 _1、_2 ...
+     * @param format jpg / png
+     * @param count 张数
+     * @param intervalMs 连拍间隔
+     */
+    void request(const QString &basePath, const QString &format, int count = 1, int intervalMs = 0);
+
+    /**
+     * @brief 解码线程每输出一帧调用：有到期的截图时返回 true
+     */
+    bool wantsFrame(qint64 nowUs);
+
+    /**
+     * @brief 提交帧（仅增加引用），队列已满时跳过，不会阻塞
+     */
+    void submit(const AVFrame *frame, qint64 nowUs);
+
+    Stats stats() const;
+
+signals:
+    /**
+     * @brief 一张截图处理完毕（在工作线程发出）
+     * @param encodeMs 转换加编码耗时
+     * @param queueLength 提交时已在排队的帧数
+     */
+    void snapshotSaved(const QString &path, bool ok, double encodeMs, int queueLength);
+
+private:
+    struct Burst
+    {
+        QString basePath;
+        QString format;
+        int count = 1;
+        int taken = 0;
+        qint64 intervalUs = 0;
+        qint64 nextDueUs = 0;       // 0 表示下一帧即可
+    };
+
+    struct Job
+    {
+        AVFrame *frame = nullptr;
+        QString path;
+        QString format;
+        int queueLength = 0;
+    };
+
+    void workerLoop();
+    bool encode(const Job &job);
+
+    static constexpr int kMaxQueued = 4;    // 待编码帧上限（持有解码帧引用，不宜过多）
+
+    const int m_quality;
+    mutable QMutex m_mutex;
+    QWaitCondition m_hasJob;
+    std::deque<Burst> m_bursts;
+    std::deque<Job> m_jobs;
+    std::atomic<bool> m_pending{false};     // 有未完成的截图请求，解码线程无锁快速判断
+    bool m_stopping = false;
+    std::thread m_thread;
+
+    // 工作线程独占
+    SwsContext *m_swsCtx = nullptr;
+
+    // 统计信息
+    std::atomic<quint64> m_requested{0};
+    std::atomic<quint64> m_saved{0};
+    std::atomic<quint64> m_failed{0};
+    std::atomic<quint64> m_skipped{0};
+    std::atomic<int> m_maxQueueLength{0};
+    std::atomic<qint64> m_lastEncodeUs{0};
+    std::atomic<quint64> m_encodeUsTotal{0};
+};
+
+#endif // SNAPSHOTCAPTURE_H
@@ -0,0 +1,152 @@
+#include "stream_probe_cache.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+extern "C"
+{
+#include <libavutil/mem.h>
+}
+
+namespace
+{
+const int kCacheVersion = 1;
+
+QByteArray extradataOf(const AVCodecParameters *par)
+{
+    if (!par->extradata || par->extradata_size <= 0)
+    {
+        return QByteArray();
+    }
+    return QByteArray(reinterpret_cast<const char *>(par->extradata), par->extradata_size);
+}
+
+QJsonObject toJson(const AVCodecParameters *par, AVRational timeBase)
+{
+    QJsonObject obj;
+    obj["version"] = kCacheVersion;
+    obj["codec_id"] = static_cast<int>(par->codec_id);
+    obj["codec_tag"] = static_cast<qint64>(par->codec_tag);
+    obj["format"] = par->format;
+    obj["width"] = par->width;
+    obj["height"] = par->height;
+    obj["profile"] = par->profile;
+    obj["level"] = par->level;
+    obj["bits_per_raw_sample"] = par->bits_per_raw_sample;
+    obj["field_order"] = static_cast<int>(par->field_order);
+    obj["color_range"] = static_cast<int>(par->color_range);
+    obj["color_primaries"] = static_cast<int>(par->color_primaries);
+    obj["color_trc"] = static_cast<int>(par->color_trc);
+    obj["color_space"] = static_cast<int>(par->color_space);
+    obj["chroma_location"] = static_cast<int>(par->chroma_location);
+    obj["sar_num"] = par->sample_aspect_ratio.num;
+    obj["sar_den"] = par->sample_aspect_ratio.den;
+    obj["time_base_num"] = timeBase.num;
+    obj["time_base_den"] = timeBase.den;
+    obj["extradata"] = QString::fromLatin1(extradataOf(par).toBase64());
+    return obj;
+}
+}
+
+QString StreamProbeCache::pathFor(const QString &url)
+{
+    const QByteArray hash = QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1).toHex();
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    return dir + "/stream_probe/" + QString::fromLatin1(hash) + ".json";
+}
+
+bool StreamProbeCache::load(const QString &url, AVCodecParameters *par, AVRational *timeBase)
+{
+    QFile file(pathFor(url));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    const QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+    if (obj.value("version").toInt() != kCacheVersion || obj.value("codec_id").toInt() == AV_CODEC_ID_NONE)
+    {
+        return false;
+    }
+
+    par->codec_type = AVMEDIA_TYPE_VIDEO;
+    par->codec_id = static_cast<AVCodecID>(obj.value("codec_id").toInt());
+    par->codec_tag = static_cast<uint32_t>(obj.value("codec_tag").toVariant().toLongLong());
+    par->format = obj.value("format").toInt(-1);
+    par->width = obj.value("width").toInt();
+    par->height = obj.value("height").toInt();
+    par->profile = obj.value("profile").toInt();
+    par->level = obj.value("level").toInt();
+    par->bits_per_raw_sample = obj.value("bits_per_raw_sample").toInt();
+    par->field_order = static_cast<AVFieldOrder>(obj.value("field_order").toInt());
+    par->color_range = static_cast<AVColorRange>(obj.value("color_range").toInt());
+    par->color_primaries = static_cast<AVColorPrimaries>(obj.value("color_primaries").toInt());
+    par->color_trc = static_cast<AVColorTransferCharacteristic>(obj.value("color_trc").toInt());
+    par->color_space = static_cast<AVColorSpace>(obj.value("color_space").toInt());
+    par->chroma_location = static_cast<AVChromaLocation>(obj.value("chroma_location").toInt());
+    par->sample_aspect_ratio = AVRational{obj.value("sar_num").toInt(), obj.value("sar_den").toInt(1)};
+    *timeBase = AVRational{obj.value("time_base_num").toInt(1), obj.value("time_base_den").toInt(1000)};
+
+    // extradata 需按 FFmpeg 要求分配并补齐填充字节
+    av_freep(&par->extradata);
+    par->extradata_size = 0;
+    const QByteArray extradata = QByteArray::fromBase64(obj.value("extradata").toString().toLatin1());
+    if (!extradata.isEmpty())
+    {
+        par->extradata = static_cast<uint8_t *>(av_mallocz(extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!par->extradata)
+        {
+            return false;
+        }
+        memcpy(par->extradata, extradata.constData(), extradata.size());
+        par->extradata_size = extradata.size();
+    }
+    return true;
+}
+
+bool StreamProbeCache::save(const QString &url, const AVCodecParameters *par, AVRational timeBase)
+{
+    const QString path = pathFor(url);
+    const QByteArray content = QJsonDocument(toJson(par, timeBase)).toJson(QJsonDocument::Compact);
+
+    QFile existing(path);
+    if (existing.open(QIODevice::ReadOnly) && existing.readAll() == content)
+    {
+        return true;
+    }
+    existing.close();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    file.write(content);
+    return file.commit();
+}
+
+void StreamProbeCache::remove(const QString &url)
+{
+    QFile::remove(pathFor(url));
+}
+
+bool StreamProbeCache::matches(const AVCodecParameters *cached, const AVCodecParameters *actual)
+{
+    if (actual->codec_id != cached->codec_id)
+    {
+        return false;
+    }
+    if (actual->width > 0 && actual->height > 0 &&
+        (actual->width != cached->width || actual->height != cached->height))
+    {
+        return false;
+    }
+    const QByteArray actualExtradata = extradataOf(actual);
+    return actualExtradata.isEmpty() || actualExtradata == extradataOf(cached);
+}
@@ -0,0 +1,53 @@
+#ifndef STREAMPROBECACHE_H
+#define STREAMPROBECACHE_H
+
+#include <QString>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 按流地址在磁盘上缓存上次成功打开的视频流参数
+ *
+ * 保存编码参数（含 extradata，即 SPS/PPS 等）与时间基，
+ * 下次启动时可直接用缓存打开解码器，省去 avformat_find_stream_info
+ * 等待关键帧的探测时间。缓存只是提示，使用方需用实际收到的流参数校验，
+ * 不一致时调用 remove() 并退回完整探测。
+ */
+class StreamProbeCache
+{
+public:
+    /**
+     * @brief 读取缓存
+     * @param url 流地址
+     * @param par 输出编码参数，需由调用方 avcodec_parameters_alloc 分配
+     * @param timeBase 输出流时间基
+     * @return 缓存存在且完整时返回 true
+     */
+    static bool load(const QString &url, AVCodecParameters *par, AVRational *timeBase);
+
+    /**
+     * @brief 写入缓存（内容未变时不重复写盘）
+     */
+    static bool save(const QString &url, const AVCodecParameters *par, AVRational timeBase);
+
+    /**
+     * @brief 删除缓存（校验失败时调用）
+     */
+    static void remove(const QString &url);
+
+    /**
+     * @brief 判断实际流参数是否与缓存一致
+     *
+     * 编码格式必须相同；实际参数中已知的尺寸和 extradata 也必须相同，
+     * 尚未解析出来的（为 0 或为空）不参与比较。
+     */
+    static bool matches(const AVCodecParameters *cached, const AVCodecParameters *actual);
+
+private:
+    static QString pathFor(const QString &url);
+};
+
+#endif // STREAMPROBECACHE_H
@@ -0,0 +1,269 @@
+#include "stream_recorder.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+extern "C"
+{
+#include <libavutil/time.h>
+}
+
+StreamRecorder::StreamRecorder(const QString &dir, const QString &prefix, const QString &format,
+                               int segmentSeconds, int queueBytes, int ioBufferSize)
+    : m_dir(dir), m_prefix(prefix), m_format(format), m_segmentSeconds(segmentSeconds),
+      m_queueBytes(queueBytes), m_ioBufferSize(ioBufferSize)
+{
+    QDir().mkpath(m_dir);
+    m_thread = std::thread(&StreamRecorder::ioLoop, this);
+}
+
+StreamRecorder::~StreamRecorder()
+{
+    // 已入队的数据全部写完后再退出，保证文件完整
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_hasWork.wakeAll();
+    }
+    m_thread.join();
+    closeSegment();
+    avcodec_parameters_free(&m_par);
+}
+
+void StreamRecorder::beginStream(const AVCodecParameters *par, AVRational timeBase)
+{
+    Item item;
+    item.type = ItemBegin;
+    item.par = avcodec_parameters_alloc();
+    item.timeBase = timeBase;
+    if (!item.par || avcodec_parameters_copy(item.par, par) < 0)
+    {
+        freeItem(item);
+        return;
+    }
+    enqueue(item);
+}
+
+void StreamRecorder::writePacket(const AVPacket *packet)
+{
+    QMutexLocker locker(&m_mutex);
+    const bool isKey = packet->flags & AV_PKT_FLAG_KEY;
+    if (m_waitKeyframe && !isKey)
+    {
+        m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (m_queuedBytes + packet->size > m_queueBytes)
+    {
+        // 写盘跟不上：丢弃新包直到下一个关键帧，已排队的包照常写入
+        if (!m_waitKeyframe)
+        {
+            m_overflows.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_waitKeyframe = true;
+        m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_waitKeyframe = false;
+
+    Item item;
+    item.packet = av_packet_alloc();
+    if (!item.packet || av_packet_ref(item.packet, packet) < 0)
+    {
+        freeItem(item);
+        m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_queuedBytes += packet->size;
+    m_items.push_back(item);
+    const int depth = static_cast<int>(m_items.size());
+    if (depth > m_maxQueueDepth.load(std::memory_order_relaxed))
+    {
+        m_maxQueueDepth.store(depth, std::memory_order_relaxed);
+    }
+    m_hasWork.wakeOne();
+}
+
+void StreamRecorder::endStream()
+{
+    Item item;
+    item.type = ItemEnd;
+    enqueue(item);
+}
+
+void StreamRecorder::enqueue(const Item &item)
+{
+    QMutexLocker locker(&m_mutex);
+    m_items.push_back(item);
+    m_hasWork.wakeOne();
+}
+
+void StreamRecorder::freeItem(Item &item)
+{
+    av_packet_free(&item.packet);
+    avcodec_parameters_free(&item.par);
+}
+
+StreamRecorder::Stats StreamRecorder::stats() const
+{
+    Stats s;
+    {
+        QMutexLocker locker(&m_mutex);
+        s.queueDepth = static_cast<int>(m_items.size());
+        s.queuedMB = m_queuedBytes / (1024.0 * 1024.0);
+        s.currentFile = m_currentFile;
+    }
+    s.maxQueueDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+    s.packetsWritten = m_packetsWritten.load(std::memory_order_relaxed);
+    s.packetsDropped = m_packetsDropped.load(std::memory_order_relaxed);
+    s.overflows = m_overflows.load(std::memory_order_relaxed);
+    s.segments = m_segments.load(std::memory_order_relaxed);
+    s.writeErrors = m_writeErrors.load(std::memory_order_relaxed);
+    const qint64 bytes = m_bytesWritten.load(std::memory_order_relaxed);
+    const qint64 ioUs = m_ioUs.load(std::memory_order_relaxed);
+    s.writtenMB = bytes / (1024.0 * 1024.0);
+    s.writeMBps = ioUs > 0 ? s.writtenMB / (ioUs / 1e6) : 0;
+    return s;
+}
+
+void StreamRecorder::ioLoop()
+{
+    for (;;)
+    {
+        Item item;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stopping && m_items.empty())
+            {
+                m_hasWork.wait(&m_mutex);
+            }
+            if (m_items.empty())
+            {
+                return;     // 正在停止且已排空
+            }
+            item = m_items.front();
+            m_items.pop_front();
+            if (item.packet)
+            {
+                m_queuedBytes -= item.packet->size;
+            }
+        }
+
+        switch (item.type)
+        {
+        case ItemBegin:
+            // 新连接的参数可能变化，总是开始新的分段
+            closeSegment();
+            avcodec_parameters_free(&m_par);
+            m_par = item.par;
+            item.par = nullptr;
+            m_timeBase = item.timeBase;
+            break;
+        case ItemPacket:
+            handlePacket(item.packet);
+            break;
+        case ItemEnd:
+            closeSegment();
+            avcodec_parameters_free(&m_par);
+            break;
+        }
+        freeItem(item);
+    }
+}
+
+int64_t StreamRecorder::packetTs(const AVPacket *packet) const
+{
+    return packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+}
+
+void StreamRecorder::handlePacket(const AVPacket *packet)
+{
+    if (!m_par)
+    {
+        return;
+    }
+    const bool isKey = packet->flags & AV_PKT_FLAG_KEY;
+    if (m_muxer.isOpen() && isKey && m_segmentSeconds > 0)
+    {
+        // 时长按时间戳计算，时间戳缺失时按本地时钟
+        const int64_t ts = packetTs(packet);
+        const qint64 elapsedUs = ts != AV_NOPTS_VALUE && m_segmentStartTs != AV_NOPTS_VALUE
+                                     ? av_rescale_q(ts - m_segmentStartTs, m_timeBase, AV_TIME_BASE_Q)
+                                     : av_gettime_relative() - m_segmentStartUs;
+        if (elapsedUs >= static_cast<qint64>(m_segmentSeconds) * 1000000)
+        {
+            closeSegment();
+        }
+    }
+    if (!m_muxer.isOpen())
+    {
+        // 分段总是从关键帧开始
+        if (!isKey || !openSegment(packet))
+        {
+            return;
+        }
+    }
+
+    if (!m_muxer.write(packet))
+    {
+        qWarning() << "Recording write failed:" << m_muxer.errorString();
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        m_packetsDropped.fetch_add(1, std::memory_order_relaxed);
+        closeSegment();     // 下一个关键帧重新开始新文件
+        return;
+    }
+    m_packetsWritten.fetch_add(1, std::memory_order_relaxed);
+    m_bytesWritten.store(m_closedBytes + m_muxer.bytesWritten(), std::memory_order_relaxed);
+    m_ioUs.store(m_closedIoUs + m_muxer.ioTimeUs(), std::memory_order_relaxed);
+}
+
+bool StreamRecorder::openSegment(const AVPacket *packet)
+{
+    const QString path = nextFileName();
+    if (!m_muxer.open(path, m_format, m_par, m_timeBase, m_ioBufferSize))
+    {
+        qWarning() << "Failed to open recording" << path << ":" << m_muxer.errorString();
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_segmentStartTs = packetTs(packet);
+    m_segmentStartUs = av_gettime_relative();
+    m_segments.fetch_add(1, std::memory_order_relaxed);
+    QMutexLocker locker(&m_mutex);
+    m_currentFile = path;
+    return true;
+}
+
+void StreamRecorder::closeSegment()
+{
+    if (!m_muxer.isOpen())
+    {
+        return;
+    }
+    if (!m_muxer.close())
+    {
+        qWarning() << "Failed to finalize recording:" << m_muxer.errorString();
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 关闭后计数仍保留，包含文件尾
+    m_closedBytes += m_muxer.bytesWritten();
+    m_closedIoUs += m_muxer.ioTimeUs();
+    m_bytesWritten.store(m_closedBytes, std::memory_order_relaxed);
+    m_ioUs.store(m_closedIoUs, std::memory_order_relaxed);
+    QMutexLocker locker(&m_mutex);
+    m_currentFile.clear();
+}
+
+QString StreamRecorder::nextFileName() const
+{
+    const QString ext = PacketMuxer::extensionFor(m_format);
+    const QString base = QString("%1_%2").arg(m_prefix, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    QString path = QDir(m_dir).filePath(base + "." + ext);
+    // 同一秒内重连产生的分段加序号区分
+    for (int i = 1; QFileInfo::exists(path); i++)
+    {
+        path = QDir(m_dir).filePath(QString("%1_%2.%3").arg(base).arg(i).arg(ext));
+    }
+    return path;
+}
@@ -0,0 +1,127 @@
+#ifndef STREAMRECORDER_H
+#define STREAMRECORDER_H
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <thread>
+
+#include "packet_sink.h"
+#include "packet_muxer.h"
+
+/**
+ * @brief 直播流分段录像（不转码）
+ *
+ * 作为 PacketSink 挂到 VideoDecoder 上，读取线程只对包增加引用后入队即返回；
+ * 封装与写盘在录像自己的 I/O 线程中完成。队列按字节数限制，超限时丢弃新包
+ * 直到下一个关键帧（计入丢包统计），绝不阻塞读取与解码。
+ * 每个分段从关键帧开始，时长达到 segmentSeconds 后在下一个关键帧处切换文件，
+ * 文件名为 <dir>/<prefix>_yyyyMMdd_HHmmss.<ext>。
+ * 只录视频流，摄像头带声音时录像也没有音轨（见 PacketSink）。
+ */
+class StreamRecorder : public PacketSink
+{
+public:
+    /**
+     * @brief 录像统计信息
+     */
+    struct Stats
+    {
+        int queueDepth = 0;             // 当前排队包数
+        int maxQueueDepth = 0;          // 历史最大排队包数
+        double queuedMB = 0;            // 当前排队数据量
+        quint64 packetsWritten = 0;     // 已写入的包数
+        quint64 packetsDropped = 0;     // 因队列超限或写盘失败丢弃的包数
+        quint64 overflows = 0;          // 队列超限次数
+        quint64 segments = 0;           // 已创建的分段文件数
+        quint64 writeErrors = 0;        // 写盘失败次数
+        double writtenMB = 0;           // 已写入文件的数据量（含容器开销）
+        double writeMBps = 0;           // 写盘吞吐（按实际写盘耗时计算）
+        QString currentFile;            // 当前正在写入的文件
+    };
+
+    /**
+     * @param dir 录像目录，不存在时自动创建
+     * @param prefix 文件名前缀（多路摄像头区分用）
+     * @param format 容器格式：mp4 / mkv / ts
+     * @param segmentSeconds 分段时长，<= 0 表示不分段
+     * @param queueBytes 排队数据量上限
+     * @param ioBufferSize 写缓冲区字节数
+     */
+    StreamRecorder(const QString &dir, const QString &prefix, const QString &format, int segmentSeconds,
+                   int queueBytes, int ioBufferSize);
+    ~StreamRecorder() override;
+
+    StreamRecorder(const StreamRecorder &) = delete;
+    StreamRecorder &operator=(const StreamRecorder &) = delete;
+
+    void beginStream(const AVCodecParameters *par, AVRational timeBase) override;
+    void writePacket(const AVPacket *packet) override;
+    void endStream() override;
+
+    Stats stats() const;
+
+private:
+    enum ItemType
+    {
+        ItemBegin,      // 新连接：携带流参数
+        ItemPacket,
+        ItemEnd         // 连接结束：关闭当前分段
+    };
+
+    struct Item
+    {
+        ItemType type = ItemPacket;
+        AVPacket *packet = nullptr;
+        AVCodecParameters *par = nullptr;
+        AVRational timeBase{1, 1000};
+    };
+
+    void enqueue(const Item &item);
+    static void freeItem(Item &item);
+    void ioLoop();
+    void handlePacket(const AVPacket *packet);
+    bool openSegment(const AVPacket *packet);
+    void closeSegment();
+    QString nextFileName() const;
+    int64_t packetTs(const AVPacket *packet) const;
+
+    const QString m_dir;
+    const QString m_prefix;
+    const QString m_format;
+    const int m_segmentSeconds;
+    const int m_queueBytes;
+    const int m_ioBufferSize;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_hasWork;
+    std::deque<Item> m_items;
+    qint64 m_queuedBytes = 0;
+    bool m_waitKeyframe = true;         // 丢包后等待关键帧（入队端）
+    bool m_stopping = false;
+    QString m_currentFile;
+    std::thread m_thread;
+
+    // I/O 线程独占
+    PacketMuxer m_muxer;
+    AVCodecParameters *m_par = nullptr; // 当前连接的流参数
+    AVRational m_timeBase{1, 1000};
+    int64_t m_segmentStartTs = AV_NOPTS_VALUE;
+    qint64 m_segmentStartUs = 0;        // 分段开始时刻（时间戳缺失时按本地时钟分段）
+    qint64 m_closedBytes = 0;           // 已关闭分段写入的字节数
+    qint64 m_closedIoUs = 0;            // 已关闭分段的写盘耗时
+
+    // 统计信息
+    std::atomic<int> m_maxQueueDepth{0};
+    std::atomic<quint64> m_packetsWritten{0};
+    std::atomic<quint64> m_packetsDropped{0};
+    std::atomic<quint64> m_overflows{0};
+    std::atomic<quint64> m_segments{0};
+    std::atomic<quint64> m_writeErrors{0};
+    std::atomic<qint64> m_bytesWritten{0};
+    std::atomic<qint64> m_ioUs{0};
+};
+
+#endif // STREAMRECORDER_H
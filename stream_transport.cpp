@@ -0,0 +1,114 @@
+#include "stream_transport.h"
+
+StreamTransport::Type StreamTransport::resolve(Type type, const QString &url)
+{
+    if (type != Auto)
+    {
+        return type;
+    }
+    if (url.startsWith("rtmp://", Qt::CaseInsensitive) || url.startsWith("rtmps://", Qt::CaseInsensitive))
+    {
+        return Rtmp;
+    }
+    if (url.startsWith("rtsp://", Qt::CaseInsensitive))
+    {
+        return RtspTcp;
+    }
+    if (url.startsWith("srt://", Qt::CaseInsensitive))
+    {
+        return Srt;
+    }
+    if (url.startsWith("udp://", Qt::CaseInsensitive))
+    {
+        return MpegTsUdp;
+    }
+    return Auto;
+}
+
+void StreamTransport::apply(const Settings &settings, Type type, AVDictionary **options, const AVInputFormat **format)
+{
+    // 通用：解复用器不为探测缓存数据，读到即交出
+    av_dict_set(options, "fflags", "nobuffer", 0);
+
+    switch (type)
+    {
+    case Rtmp:
+        // 编码参数在 FLV 头部的序列头中，不需要额外探测
+        av_dict_set(options, "probesize", "32", 0);
+        av_dict_set(options, "rtmp_live", "live", 0);
+        av_dict_set(options, "rtmp_buffer", "100", 0);     // 告知服务端的客户端缓冲时长（默认 3 秒）
+        break;
+    case RtspTcp:
+    case RtspUdp:
+        // 编码参数在 SDP 中
+        av_dict_set(options, "probesize", "32", 0);
+        av_dict_set(options, "rtsp_transport", type == RtspTcp ? "tcp" : "udp", 0);
+        if (type == RtspUdp)
+        {
+            // 乱序包最多等待 reorderDelayMs，之后按丢包处理
+            av_dict_set_int(options, "max_delay", static_cast<int64_t>(settings.reorderDelayMs) * 1000, 0);
+            av_dict_set_int(options, "buffer_size", static_cast<int64_t>(settings.udpBufferKb) * 1024, 0);
+        }
+        if (settings.listen)
+        {
+            av_dict_set(options, "rtsp_flags", "listen", 0);
+        }
+        break;
+    case Srt:
+        *format = av_find_input_format("mpegts");
+        av_dict_set(options, "transtype", "live", 0);
+        av_dict_set_int(options, "latency", static_cast<int64_t>(settings.srtLatencyMs) * 1000, 0);   // 微秒
+        av_dict_set(options, "mode", settings.listen ? "listener" : "caller", 0);
+        break;
+    case MpegTsUdp:
+        *format = av_find_input_format("mpegts");
+        av_dict_set_int(options, "buffer_size", static_cast<int64_t>(settings.udpBufferKb) * 1024, 0);
+        av_dict_set_int(options, "fifo_size", static_cast<int64_t>(settings.udpBufferKb) * 1024 / 188, 0);
+        av_dict_set(options, "overrun_nonfatal", "1", 0);
+        break;
+    default:
+        av_dict_set(options, "probesize", "32", 0);
+        break;
+    }
+
+    if (type == Srt || type == MpegTsUdp)
+    {
+        // MPEG-TS 的编码参数要等到第一个带 SPS 的关键帧，探测时长至少覆盖一个 GOP
+        av_dict_set(options, "probesize", "2000000", 0);
+        av_dict_set(options, "analyzeduration", "2000000", 0);
+    }
+}
+
+const char *StreamTransport::name(Type type)
+{
+    switch (type)
+    {
+    case Auto:
+        return "auto";
+    case Rtmp:
+        return "rtmp";
+    case RtspTcp:
+        return "rtsp-tcp";
+    case RtspUdp:
+        return "rtsp-udp";
+    case Srt:
+        return "srt";
+    case MpegTsUdp:
+        return "udp";
+    default:
+        return "unknown";
+    }
+}
+
+bool StreamTransport::fromName(const QString &name, Type *type)
+{
+    for (int i = 0; i < TypeCount; i++)
+    {
+        if (name == QLatin1String(StreamTransport::name(static_cast<Type>(i))))
+        {
+            *type = static_cast<Type>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#ifndef STREAMTRANSPORT_H
+#define STREAMTRANSPORT_H
+
+#include <QString>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief 流的传输方式及其低延迟打开参数
+ *
+ * 不同协议的低延迟参数互不相通：rtsp_transport 只对 RTSP 有效，
+ * SRT 的 latency 决定丢包重传的等待时间，裸 UDP 上的 MPEG-TS 需要足够大的套接字缓冲。
+ * RTMP 基于 TCP，链路丢包时重传造成的队头阻塞会让后续数据一起等待；
+ * RTSP/UDP 和 MPEG-TS/UDP 丢包只损坏当前帧，SRT 在 latency 以内重传、超时则放弃。
+ */
+class StreamTransport
+{
+public:
+    enum Type
+    {
+        Auto,           // 按地址前缀选择（rtmp:// rtsp:// srt:// udp://）
+        Rtmp,           // RTMP（TCP）
+        RtspTcp,        // RTSP，RTP 交织在 RTSP 的 TCP 连接中
+        RtspUdp,        // RTSP，RTP 走 UDP
+        Srt,            // SRT 承载 MPEG-TS
+        MpegTsUdp,      // 裸 UDP 承载 MPEG-TS
+        TypeCount
+    };
+
+    /**
+     * @brief 传输参数
+     */
+    struct Settings
+    {
+        Type type = Auto;
+        int srtLatencyMs = 120;         // SRT 接收端等待重传的时间，约为 RTT 的 3~4 倍
+        int udpBufferKb = 2048;         // UDP 套接字接收缓冲，码率突增时避免内核丢包
+        int reorderDelayMs = 100;       // RTSP/UDP 等待乱序包的最长时间
+        bool listen = false;            // 作为服务端等待推流（RTSP 监听、SRT listener）
+    };
+
+    /**
+     * @brief 确定实际的传输方式，Auto 时按地址前缀判断，无法判断时返回 Auto
+     */
+    static Type resolve(Type type, const QString &url);
+
+    /**
+     * @brief 在 avformat_open_input 之前设置打开参数
+     * @param type 已经 resolve() 的传输方式，Auto 时（本地文件、环形缓冲等）只设置通用参数
+     * @param format 需要指定输入格式时（SRT、UDP 上的 MPEG-TS）写入，否则不改动
+     */
+    static void apply(const Settings &settings, Type type, AVDictionary **options, const AVInputFormat **format);
+
+    static const char *name(Type type);
+
+    /**
+     * @brief 按名称（auto / rtmp / rtsp-tcp / rtsp-udp / srt / udp）解析传输方式
+     */
+    static bool fromName(const QString &name, Type *type);
+};
+
+#endif // STREAMTRANSPORT_H
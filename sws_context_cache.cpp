@@ -0,0 +1,86 @@
+#include "sws_context_cache.h"
+
+bool SwsContextCache::Key::operator==(const Key &other) const
+{
+    return srcFormat == other.srcFormat && srcWidth == other.srcWidth && srcHeight == other.srcHeight &&
+           dstFormat == other.dstFormat && dstWidth == other.dstWidth && dstHeight == other.dstHeight &&
+           bands == other.bands && colorspace == other.colorspace && range == other.range;
+}
+
+SwsContextCache::SwsContextCache(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+}
+
+SwsContextCache::~SwsContextCache()
+{
+    clear();
+}
+
+const std::vector<SwsContextCache::Band> *SwsContextCache::find(const Key &key)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return &m_entries.front().bands;
+        }
+    }
+    return nullptr;
+}
+
+const std::vector<SwsContextCache::Band> &SwsContextCache::insert(const Key &key, std::vector<Band> bands,
+                                                                  qint64 buildUs)
+{
+    while (static_cast<int>(m_entries.size()) >= m_capacity)
+    {
+        freeBands(m_entries.back().bands);
+        m_entries.pop_back();
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_entries.push_front(Entry{key, std::move(bands)});
+    m_size.store(static_cast<int>(m_entries.size()), std::memory_order_relaxed);
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    m_buildUsTotal.fetch_add(static_cast<quint64>(buildUs), std::memory_order_relaxed);
+    if (buildUs > m_maxBuildUs.load(std::memory_order_relaxed))
+    {
+        m_maxBuildUs.store(buildUs, std::memory_order_relaxed);
+    }
+    return m_entries.front().bands;
+}
+
+void SwsContextCache::clear()
+{
+    for (Entry &entry : m_entries)
+    {
+        freeBands(entry.bands);
+    }
+    m_entries.clear();
+    m_size.store(0, std::memory_order_relaxed);
+}
+
+void SwsContextCache::freeBands(std::vector<Band> &bands)
+{
+    for (Band &band : bands)
+    {
+        sws_freeContext(band.ctx);
+        band.ctx = nullptr;
+    }
+    bands.clear();
+}
+
+SwsContextCache::Stats SwsContextCache::stats() const
+{
+    Stats s;
+    s.capacity = m_capacity;
+    s.size = m_size.load(std::memory_order_relaxed);
+    s.hits = m_hits.load(std::memory_order_relaxed);
+    s.misses = m_misses.load(std::memory_order_relaxed);
+    s.evictions = m_evictions.load(std::memory_order_relaxed);
+    s.avgBuildMs = s.misses ? m_buildUsTotal.load(std::memory_order_relaxed) / 1000.0 / s.misses : 0;
+    s.maxBuildMs = m_maxBuildUs.load(std::memory_order_relaxed) / 1000.0;
+    return s;
+}
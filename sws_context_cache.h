@@ -0,0 +1,114 @@
+#ifndef SWSCONTEXTCACHE_H
+#define SWSCONTEXTCACHE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <list>
+#include <vector>
+
+extern "C"
+{
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief 最近使用的 sws 上下文缓存（LRU）
+ *
+ * 以（输入格式、输入尺寸、输出格式、输出尺寸、分段数、色彩空间、取值范围）为键，
+ * 每项保存一组按输出行分段的 sws 上下文。摄像头在几种分辨率之间切换、
+ * 或显示控件在几种尺寸之间来回缩放时，直接取回之前建好的上下文，不再逐次重建。
+ * 容量很小，按顺序查找即可。仅限单一线程（解码线程）使用，统计信息可在任意线程读取。
+ */
+class SwsContextCache
+{
+public:
+    /**
+     * @brief 转换配置，作为缓存的键
+     */
+    struct Key
+    {
+        int srcFormat = -1;
+        int srcWidth = 0, srcHeight = 0;
+        int dstFormat = -1;
+        int dstWidth = 0, dstHeight = 0;
+        int bands = 0;
+        int colorspace = 0;
+        int range = 0;
+
+        bool operator==(const Key &other) const;
+        bool operator!=(const Key &other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief 一个行段的 sws 上下文及其负责的行范围
+     */
+    struct Band
+    {
+        SwsContext *ctx = nullptr;
+        int srcY = 0, srcH = 0;             // 输入行范围（缩放时为整帧）
+        int dstY = 0, dstH = 0;             // 输出行范围
+    };
+
+    /**
+     * @brief 缓存统计信息
+     */
+    struct Stats
+    {
+        int capacity = 0;           // 最多缓存的配置数
+        int size = 0;               // 当前缓存的配置数
+        quint64 hits = 0;           // 取回已有上下文的次数
+        quint64 misses = 0;         // 新建上下文的次数
+        quint64 evictions = 0;      // 淘汰最久未用配置的次数
+        double avgBuildMs = 0;      // 新建一组上下文的平均耗时
+        double maxBuildMs = 0;      // 新建一组上下文的最大耗时
+    };
+
+    explicit SwsContextCache(int capacity);
+    ~SwsContextCache();
+
+    SwsContextCache(const SwsContextCache &) = delete;
+    SwsContextCache &operator=(const SwsContextCache &) = delete;
+
+    /**
+     * @brief 查找配置，命中时移到最近使用的位置
+     * @return 未命中时返回 nullptr；返回的指针在下一次 insert() 或 clear() 之前有效
+     */
+    const std::vector<Band> *find(const Key &key);
+
+    /**
+     * @brief 加入新建的一组上下文（接管其所有权），超出容量时释放最久未用的一组
+     * @param buildUs 新建耗时，计入统计
+     */
+    const std::vector<Band> &insert(const Key &key, std::vector<Band> bands, qint64 buildUs);
+
+    /**
+     * @brief 释放全部上下文
+     */
+    void clear();
+
+    /**
+     * @brief 释放一组上下文（也用于新建失败时清理已建好的部分）
+     */
+    static void freeBands(std::vector<Band> &bands);
+
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        Key key;
+        std::vector<Band> bands;
+    };
+
+    const int m_capacity;
+    std::list<Entry> m_entries;         // 表头为最近使用
+
+    std::atomic<int> m_size{0};
+    std::atomic<quint64> m_hits{0};
+    std::atomic<quint64> m_misses{0};
+    std::atomic<quint64> m_evictions{0};
+    std::atomic<quint64> m_buildUsTotal{0};
+    std::atomic<qint64> m_maxBuildUs{0};
+};
+
+#endif // SWSCONTEXTCACHE_H
@@ -1,14 +1,87 @@
 #include "video_decoder.h"
 #include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <ctime>
+#include <thread>
 
 extern "C"
 {
 #include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/time.h>
+}
+
+namespace
+{
+qint64 threadCpuUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+const char *visibilityName(int state)
+{
+    static const char *const kNames[] = {"visible", "hidden", "idle"};
+    return state >= 0 && state < 3 ? kNames[state] : "unknown";
+}
+
+// 可独立解码的关键帧（IDR）；open GOP 中的普通 I 帧之后的帧仍可能引用损坏的画面
+bool isKeyFrame(const AVFrame *frame)
+{
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(58, 29, 100)
+    return frame->flags & AV_FRAME_FLAG_KEY;
+#else
+    return frame->key_frame;
+#endif
+}
+
+// 排队时长不会超过落后于直播端的时间，因此队列的时长上限不低于追帧的清空阈值时，
+// 积压总是先由追帧逐级处理（丢非参考帧、跳过转换、清空到关键帧），队列超限丢弃只作为最后一道限制
+int packetQueueBudgetMs(const AppConfig &cfg)
+{
+    if (cfg.CATCHUP_BUDGET_MS <= 0 || cfg.LATENCY_BUDGET_MS <= 0)
+    {
+        return cfg.LATENCY_BUDGET_MS;
+    }
+    return qMax(cfg.LATENCY_BUDGET_MS, cfg.CATCHUP_BUDGET_MS * CatchUpController::kFlushMultiple);
 }
 
-VideoDecoder::VideoDecoder(const AppConfig &cfg, QObject *parent)
-    : QThread(parent), m_config(cfg)
+// 输出缓冲区归缓冲池所有，包装为 AVBufferRef 时不释放
+void keepBuffer(void *, uint8_t *)
 {
+}
+}
+
+VideoDecoder::VideoDecoder(const AppConfig &cfg, const QString &url,
+                           std::shared_ptr<ConvertWorkerPool> convertPool, QObject *parent)
+    : QThread(parent), m_config(cfg), m_url(url.isEmpty() ? cfg.RTMP_URL : url),
+      m_convertPool(convertPool ? std::move(convertPool) : std::make_shared<ConvertWorkerPool>(cfg.CONVERT_THREADS)),
+      m_swsCache(cfg.SWS_CACHE_SIZE),
+      m_catchUp(cfg.CATCHUP_BUDGET_MS),
+      m_tracer(std::make_shared<LatencyTracer>()),
+      m_source(std::make_shared<UrlInputSource>(m_url)),
+      m_packetQueue(cfg.PACKET_QUEUE_SIZE, packetQueueBudgetMs(cfg))
+{
+    DecoderProfile::Profile profile = DecoderProfile::LowLatency;
+    if (!DecoderProfile::fromName(cfg.DECODER_PROFILE, &profile))
+    {
+        qWarning() << "Unknown decoder profile" << cfg.DECODER_PROFILE << "- using low-latency";
+    }
+    m_requestedProfile.store(profile);
+
+    m_transport.srtLatencyMs = cfg.SRT_LATENCY_MS;
+    m_transport.udpBufferKb = cfg.UDP_BUFFER_KB;
+    m_transport.reorderDelayMs = cfg.RTSP_REORDER_DELAY_MS;
+    if (!StreamTransport::fromName(cfg.STREAM_TRANSPORT, &m_transport.type))
+    {
+        qWarning() << "Unknown stream transport" << cfg.STREAM_TRANSPORT << "- selecting by URL";
+        m_transport.type = StreamTransport::Auto;
+    }
+
     // 初始化 FFmpeg 网络模块，支持网络协议
     avformat_network_init();
 }
@@ -23,186 +96,1504 @@ VideoDecoder::~VideoDecoder()
 
 void VideoDecoder::stop()
 {
+    QElapsedTimer timer;
+    timer.start();
+    // 清除运行标志后，阻塞中的 FFmpeg I/O 会由中断回调尽快返回
     m_running.store(false);
-    // 唤醒可能处于等待状态的线程
-    m_pauseCondition.wakeAll();
+    // 唤醒可能处于等待状态的线程（持锁唤醒，避免与重连等待之间丢失唤醒）
+    {
+        QMutexLocker locker(&m_pauseMutex);
+        m_pauseCondition.wakeAll();
+    }
     if (isRunning()) {
         wait();  // 等待线程结束
+        m_lastStopUs.store(timer.nsecsElapsed() / 1000, std::memory_order_relaxed);
+    }
+}
+
+int VideoDecoder::interruptCallback(void *opaque)
+{
+    VideoDecoder *self = static_cast<VideoDecoder *>(opaque);
+    if (!self->m_running.load(std::memory_order_relaxed))
+    {
+        return 1;
+    }
+    const qint64 deadline = self->m_ioDeadlineUs.load(std::memory_order_relaxed);
+    if (deadline && av_gettime_relative() > deadline)
+    {
+        self->m_ioTimedOut.store(true, std::memory_order_relaxed);
+        return 1;
     }
+    return 0;
+}
+
+void VideoDecoder::setIoDeadline(int timeoutMs)
+{
+    m_ioTimedOut.store(false, std::memory_order_relaxed);
+    m_ioDeadlineUs.store(timeoutMs > 0 ? av_gettime_relative() + static_cast<qint64>(timeoutMs) * 1000 : 0,
+                         std::memory_order_relaxed);
+}
+
+std::shared_ptr<LatencyTracer> VideoDecoder::latencyTracer() const
+{
+    return m_tracer;
+}
+
+FramePool::Stats VideoDecoder::framePoolStats() const
+{
+    std::shared_ptr<FramePool> pool = std::atomic_load(&m_framePool);
+    return pool ? pool->stats() : FramePool::Stats();
+}
+
+PacketQueue::Stats VideoDecoder::packetQueueStats() const
+{
+    return m_packetQueue.stats();
+}
+
+CatchUpController::Stats VideoDecoder::catchUpStats() const
+{
+    return m_catchUp.stats();
+}
+
+VideoDecoder::Stats VideoDecoder::stats() const
+{
+    Stats s;
+    s.framesDecoded = m_framesDecoded.load(std::memory_order_relaxed);
+    s.framesConverted = m_framesConverted.load(std::memory_order_relaxed);
+    s.avgConvertMs = s.framesConverted
+                         ? m_convertUsTotal.load(std::memory_order_relaxed) / 1000.0 / s.framesConverted
+                         : 0;
+    s.lastConvertMs = m_lastConvertUs.load(std::memory_order_relaxed) / 1000.0;
+    s.outputSize = unpackSize(m_outputSize.load(std::memory_order_relaxed));
+    const SwsContextCache::Stats cache = m_swsCache.stats();
+    s.swsRebuilds = cache.misses;
+    s.swsCacheHits = cache.hits;
+    s.swsCacheEvictions = cache.evictions;
+    s.swsCacheSize = cache.size;
+    s.avgSwsBuildMs = cache.avgBuildMs;
+    s.maxSwsBuildMs = cache.maxBuildMs;
+    s.inputChanges = m_inputChanges.load(std::memory_order_relaxed);
+    s.reconfigurations = m_reconfigurations.load(std::memory_order_relaxed);
+    s.lastReconfigMs = m_lastReconfigUs.load(std::memory_order_relaxed) / 1000.0;
+    s.maxReconfigMs = m_maxReconfigUs.load(std::memory_order_relaxed) / 1000.0;
+    s.simdFrames = m_simdFrames.load(std::memory_order_relaxed);
+    s.simdKernel = YuvConverter::kernelName(m_yuvConverter.kernel());
+    s.bandedFrames = m_bandedFrames.load(std::memory_order_relaxed);
+    s.convertThreads = m_convertPool->threadCount();
+    s.decoderProfile = DecoderProfile::name(static_cast<DecoderProfile::Profile>(m_activeProfileStat.load(std::memory_order_relaxed)));
+    s.decoderThreads = m_decoderThreads.load(std::memory_order_relaxed);
+    s.decoderThreadType = m_activeThreadType.load(std::memory_order_relaxed);
+    s.profileSwitches = m_profileSwitches.load(std::memory_order_relaxed);
+    s.rateSkippedPackets = m_rateSkippedPackets.load(std::memory_order_relaxed);
+    s.probeCached = m_probeCached.load(std::memory_order_relaxed);
+    s.openMs = m_openUs.load(std::memory_order_relaxed) / 1000.0;
+    s.probeMs = m_probeUs.load(std::memory_order_relaxed) / 1000.0;
+    s.timeToFirstFrameMs = m_firstFrameUs.load(std::memory_order_relaxed) / 1000.0;
+    s.reconnects = m_reconnects.load(std::memory_order_relaxed);
+    s.reconnectAttempts = m_reconnectAttempts.load(std::memory_order_relaxed);
+    s.decoderReuses = m_decoderReuses.load(std::memory_order_relaxed);
+    s.lastReconnectMs = m_lastReconnectUs.load(std::memory_order_relaxed) / 1000.0;
+    s.openTimeouts = m_ioOpenTimeouts.load(std::memory_order_relaxed);
+    s.probeTimeouts = m_ioProbeTimeouts.load(std::memory_order_relaxed);
+    s.readStalls = m_readStalls.load(std::memory_order_relaxed);
+    s.lastStopMs = m_lastStopUs.load(std::memory_order_relaxed) / 1000.0;
+    s.visibility = visibilityName(m_visibilityStat.load(std::memory_order_relaxed));
+    s.hiddenConversionsSkipped = m_hiddenConversionsSkipped.load(std::memory_order_relaxed);
+    s.hiddenConvertMsSaved = s.hiddenConversionsSkipped * s.avgConvertMs;
+    s.idlePacketsSkipped = m_idlePacketsSkipped.load(std::memory_order_relaxed);
+    s.visibleMs = m_stateWallUs[VisibilityVisible].load(std::memory_order_relaxed) / 1000.0;
+    s.hiddenMs = m_stateWallUs[VisibilityHidden].load(std::memory_order_relaxed) / 1000.0;
+    s.idleMs = m_stateWallUs[VisibilityIdle].load(std::memory_order_relaxed) / 1000.0;
+    s.visibleCpuMs = m_stateCpuUs[VisibilityVisible].load(std::memory_order_relaxed) / 1000.0;
+    s.hiddenCpuMs = m_stateCpuUs[VisibilityHidden].load(std::memory_order_relaxed) / 1000.0;
+    s.idleCpuMs = m_stateCpuUs[VisibilityIdle].load(std::memory_order_relaxed) / 1000.0;
+
+    const std::shared_ptr<InputSource> source = std::atomic_load(&m_source);
+    const qint64 waitUs = source->readWaitUs();
+    const quint64 packetsRead = m_packetsRead.load(std::memory_order_relaxed);
+    s.inputSource = source->name();
+    s.inputWaitMs = waitUs / 1000.0;
+    s.transport = StreamTransport::name(static_cast<StreamTransport::Type>(m_transportStat.load(std::memory_order_relaxed)));
+    s.decodeErrors = m_decodeErrors.load(std::memory_order_relaxed);
+    s.corruptFrames = m_corruptFrames.load(std::memory_order_relaxed);
+    s.corruptionEvents = m_corruptionEvents.load(std::memory_order_relaxed);
+    s.keyframeRequests = m_keyframeRequests.load(std::memory_order_relaxed);
+    s.frozenFrames = m_frozenFrames.load(std::memory_order_relaxed);
+    s.recoveries = m_recoveries.load(std::memory_order_relaxed);
+    s.lastRecoveryMs = m_lastRecoveryUs.load(std::memory_order_relaxed) / 1000.0;
+    s.avgRecoveryMs = s.recoveries ? m_recoveryUsTotal.load(std::memory_order_relaxed) / 1000.0 / s.recoveries : 0;
+    s.maxRecoveryMs = m_maxRecoveryUs.load(std::memory_order_relaxed) / 1000.0;
+    s.avgDemuxUs = packetsRead
+                       ? qMax<qint64>(0, static_cast<qint64>(m_readFrameUsTotal.load(std::memory_order_relaxed)) - waitUs) /
+                             static_cast<double>(packetsRead)
+                       : 0;
+    s.avgReconnectMs = s.reconnects
+                           ? m_reconnectUsTotal.load(std::memory_order_relaxed) / 1000.0 / s.reconnects
+                           : 0;
+    return s;
+}
+
+void VideoDecoder::setFrameMailbox(std::shared_ptr<FrameMailbox> mailbox)
+{
+    std::atomic_store(&m_mailbox, std::move(mailbox));
+}
+
+void VideoDecoder::setInputSource(std::shared_ptr<InputSource> source)
+{
+    std::atomic_store(&m_source, std::move(source));
+}
+
+void VideoDecoder::setTransport(const StreamTransport::Settings &settings)
+{
+    m_transport = settings;
+}
+
+void VideoDecoder::setReconnectEnabled(bool enabled)
+{
+    m_reconnectEnabled.store(enabled);
+}
+
+void VideoDecoder::setReadPacing(bool enabled)
+{
+    m_readPacing.store(enabled);
+}
+
+void VideoDecoder::setSnapshotCapture(std::shared_ptr<SnapshotCapture> capture)
+{
+    std::atomic_store(&m_snapshot, std::move(capture));
+}
+
+void VideoDecoder::setFramePresenter(std::shared_ptr<FramePresenter> presenter)
+{
+    std::atomic_store(&m_presenter, std::move(presenter));
+}
+
+void VideoDecoder::setAudioOutput(std::shared_ptr<AudioOutput> output)
+{
+    m_audio.reset(output ? new AudioDecoder(std::move(output), m_config.PACKET_QUEUE_SIZE) : nullptr);
+}
+
+AudioDecoder::Stats VideoDecoder::audioStats() const
+{
+    return m_audio ? m_audio->stats() : AudioDecoder::Stats();
 }
 
 void VideoDecoder::run()
 {
     m_running.store(true);
+    std::shared_ptr<FrameMailbox> mailbox = std::atomic_load(&m_mailbox);
 
-    // 设置 FFmpeg 网络及低延迟参数
-    AVDictionary *options = nullptr;
-    av_dict_set(&options, "rtsp_transport", "tcp", 0);
-    av_dict_set(&options, "fflags", "nobuffer", 0);
-    av_dict_set(&options, "flags", "low_delay", 0);
-    av_dict_set(&options, "tune", "zerolatency", 0);
-    av_dict_set(&options, "framedrop", "1", 0);
-    av_dict_set(&options, "probesize", "32", 0);
+    // 释放上一次运行留下的输入与解码器
+    cleanup();
+    m_videoStream = -1;
+    m_reconnectLostUs = 0;
+
+    // 分配解码所需资源
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
 
-    if (avformat_open_input(&m_formatCtx, m_config.RTMP_URL.toUtf8().constData(), nullptr, &options) < 0)
+    bool connected = false;
+    while (m_running.load())
     {
-        emit errorOccurred("Failed to open stream");
-        return;
+        const qint64 startUs = LatencyTracer::nowUs();
+        AVRational timeBase{1, 1000};
+        QString error;
+        if (!openSession(packet, startUs, &timeBase, &error))
+        {
+            if (!m_running.load())
+            {
+                break;
+            }
+            if (!connected)
+            {
+                // 首次连接失败直接报告，由用户决定是否重试
+                emit errorOccurred(error);
+                break;
+            }
+            qWarning() << "Reconnect failed:" << error;
+            closeInput();
+            waitBeforeReconnect();
+            continue;
+        }
+        connected = true;
+
+        // 读取线程负责 av_read_frame，本线程只负责解码与转换，两者通过有界队列解耦
+        m_packetQueue.reset(timeBase);
+        m_catchUp.reset();
+        beginSinkStream(timeBase);
+        if (packet->data && packet->stream_index == m_videoStream)
+        {
+            // 校验缓存时读到的第一个视频包
+            writeSinks(packet);
+            m_packetQueue.push(packet);
+            av_packet_unref(packet);
+        }
+        m_audioStream = -1;
+        if (m_audio)
+        {
+            // 音频与视频共用抖动缓冲的时钟
+            m_audio->start(std::atomic_load(&m_presenter));
+        }
+        flushProbeAudio();
+        std::thread reader(&VideoDecoder::readLoop, this);
+        decodeLoop(packet, frame, mailbox, timeBase, startUs);
+
+        // 通知读取线程退出并等待
+        m_packetQueue.abort();
+        reader.join();
+        if (m_audio)
+        {
+            m_audio->stop();
+        }
+        endSinkStream();
+        if (!m_running.load() || !m_reconnectEnabled.load())
+        {
+            break;
+        }
+
+        // 连接断开：只重新打开输入，解码器、sws 上下文和缓冲池保留复用，
+        // 界面在此期间继续显示最后一帧
+        qInfo() << "Stream lost, reconnecting";
+        if (!m_reconnectLostUs)
+        {
+            // 重连后尚未出帧又断开时，恢复时间仍从最初断开算起
+            m_reconnectLostUs = LatencyTracer::nowUs();
+        }
+        closeInput();
+        waitBeforeReconnect();
     }
+    m_running.store(false);
 
-    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0)
+    // 清理解码资源（缓冲池由仍在显示的帧继续持有，最后一帧释放时回收）
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+}
+
+bool VideoDecoder::openSession(AVPacket *packet, qint64 startUs, AVRational *timeBase, QString *error)
+{
+    // 中断回调在停止或超过当前操作的截止时间时让阻塞的 I/O 立即返回
+    m_formatCtx = avformat_alloc_context();
+    m_formatCtx->interrupt_callback.callback = &VideoDecoder::interruptCallback;
+    m_formatCtx->interrupt_callback.opaque = this;
+
+    // 由输入来源决定打开的地址、格式以及是否使用自定义 I/O
+    const std::shared_ptr<InputSource> source = std::atomic_load(&m_source);
+    QString url;
+    const AVInputFormat *format = nullptr;
+    if (!source->prepare(m_formatCtx, &url, &format, error))
     {
-        emit errorOccurred("Failed to get stream info");
-        return;
+        avformat_free_context(m_formatCtx);
+        m_formatCtx = nullptr;
+        source->close();
+        return false;
     }
 
-    // 查找视频流
-    for (unsigned i = 0; i < m_formatCtx->nb_streams; i++)
+    // 按传输方式设置低延迟参数，本地文件和环形缓冲只设置通用参数；来源已指定格式时不覆盖
+    const StreamTransport::Type transport =
+        source->isNetwork() ? StreamTransport::resolve(m_transport.type, url) : StreamTransport::Auto;
+    AVDictionary *options = nullptr;
+    const AVInputFormat *transportFormat = nullptr;
+    StreamTransport::apply(m_transport, transport, &options, &transportFormat);
+    if (!format)
     {
-        if (m_formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        format = transportFormat;
+    }
+    m_transportStat.store(transport, std::memory_order_relaxed);
+
+    setIoDeadline(m_config.OPEN_TIMEOUT_MS);
+    const int ret = avformat_open_input(&m_formatCtx, url.toUtf8().constData(),
+                                        const_cast<AVInputFormat *>(format), &options);
+    av_dict_free(&options);
+    if (ret < 0)
+    {
+        // 打开失败时 FFmpeg 已释放上下文（自定义 I/O 由来源释放）
+        source->close();
+        *error = m_ioTimedOut.load() ? "Timed out opening stream" : "Failed to open stream";
+        countIoTimeout(m_ioOpenTimeouts);
+        setIoDeadline(0);
+        return false;
+    }
+    const qint64 openedUs = LatencyTracer::nowUs();
+
+    // 优先用上次缓存的流参数直接打开解码器，校验失败再做完整探测
+    m_videoStream = -1;
+    setIoDeadline(m_config.PROBE_TIMEOUT_MS);
+    const bool cachedProbe = m_config.STREAM_PROBE_CACHE && openFromProbeCache(packet, timeBase);
+    if (!cachedProbe)
+    {
+        av_packet_unref(packet);
+        if (m_ioTimedOut.load() || !probeStream(timeBase, error))
         {
-            m_videoStream = i;
-            break;
+            if (m_ioTimedOut.load())
+            {
+                *error = "Timed out probing stream";
+                countIoTimeout(m_ioProbeTimeouts);
+            }
+            setIoDeadline(0);
+            return false;
         }
     }
+    setIoDeadline(0);
+    const qint64 probedUs = LatencyTracer::nowUs();
+    m_probeCached.store(cachedProbe, std::memory_order_relaxed);
+    m_openUs.store(openedUs - startUs, std::memory_order_relaxed);
+    m_probeUs.store(probedUs - openedUs, std::memory_order_relaxed);
+    m_firstFrameUs.store(0, std::memory_order_relaxed);
+    return true;
+}
 
-    if (m_videoStream == -1 || !initDecoder())
+void VideoDecoder::countIoTimeout(std::atomic<quint64> &counter)
+{
+    if (m_ioTimedOut.load(std::memory_order_relaxed))
     {
-        emit errorOccurred("No video stream found");
-        return;
+        counter.fetch_add(1, std::memory_order_relaxed);
     }
+}
 
-    if (!initSwsContext())
+void VideoDecoder::closeInput()
+{
+    if (m_formatCtx)
     {
-        emit errorOccurred("Failed to initialize sws context");
-        return;
+        avformat_close_input(&m_formatCtx);
+    }
+    std::atomic_load(&m_source)->close();
+    m_videoStream = -1;
+    // 探测失败时未送出的音频包属于已关闭的输入
+    for (AVPacket *&packet : m_probeAudio)
+    {
+        av_packet_free(&packet);
     }
+    m_probeAudio.clear();
+}
 
-    // 分配解码所需资源
-    AVPacket *packet = av_packet_alloc();
-    AVFrame *frame = av_frame_alloc();
-    AVFrame *rgbFrame = av_frame_alloc();
-    uint8_t *buffer = nullptr;
+void VideoDecoder::waitBeforeReconnect()
+{
+    // 指数退避，上限 RECONNECT_MAX_MS；成功出帧后归零
+    const int attempt = m_reconnectAttempt++;
+    const qint64 delayMs = qMin<qint64>(static_cast<qint64>(m_config.RECONNECT_MIN_MS) << qMin(attempt, 16),
+                                        m_config.RECONNECT_MAX_MS);
+    m_reconnectAttempts.fetch_add(1, std::memory_order_relaxed);
+
+    // stop() 会唤醒该条件变量，等待期间可立即退出
+    QMutexLocker locker(&m_pauseMutex);
+    if (m_running.load())
+    {
+        m_pauseCondition.wait(&m_pauseMutex, static_cast<unsigned long>(delayMs));
+    }
+}
 
-    AVCodecParameters *codecPar = m_formatCtx->streams[m_videoStream]->codecpar;
-    int bufferSize = av_image_get_buffer_size(AV_PIX_FMT_RGB24, codecPar->width, codecPar->height, 1);
-    buffer = static_cast<uint8_t *>(av_malloc(bufferSize));
-    av_image_fill_arrays(rgbFrame->data, rgbFrame->linesize, buffer,
-                         AV_PIX_FMT_RGB24, codecPar->width, codecPar->height, 1);
+void VideoDecoder::decodeLoop(AVPacket *packet, AVFrame *frame, const std::shared_ptr<FrameMailbox> &mailbox,
+                              AVRational timeBase, qint64 startUs)
+{
+    bool firstFrame = true;
+    const std::shared_ptr<SnapshotCapture> snapshot = std::atomic_load(&m_snapshot);
+    const std::shared_ptr<FramePresenter> presenter = std::atomic_load(&m_presenter);
+    if (presenter)
+    {
+        // 重连后时间戳可能从头开始，旧连接的帧也不再显示
+        presenter->reset();
+    }
+    m_corruptSinceUs = 0;
+    m_keyframeRequestUs = 0;
+    m_stateSinceUs = LatencyTracer::nowUs();
+    m_stateCpuSinceUs = threadCpuUs();
 
     // 主解码循环
     while (m_running.load())
     {
-        int ret = av_read_frame(m_formatCtx, packet);
+        qint64 readUs = 0;
+        int ret = m_packetQueue.pop(packet, 100, &readUs);
         if (ret < 0)
+            break;
+        if (ret == 0)
+            continue;   // 超时，重新检查运行状态
+
+        // 运行中切换配置档或线程数：重新打开解码器，非关键帧丢弃
+        if ((decoderProfile() != m_activeProfile || decoderThreads() != m_activeThreadSetting) &&
+            !switchDecoderProfile(packet))
         {
-            if (ret == AVERROR_EOF)
-                break;
-            if (ret != AVERROR(EAGAIN))
+            av_packet_unref(packet);
+            if (!m_codecCtx)
             {
-                qWarning() << "Read frame error:" << ret;
+                // 解码器无法重新打开，结束本次连接（允许重连时重新建立解码器）
                 break;
             }
             continue;
         }
 
-        if (packet->stream_index == m_videoStream)
+        // 显示端不可见时只解码；长时间不可见时进一步降为只解码关键帧
+        updateVisibility(mailbox, presenter, LatencyTracer::nowUs());
+        const bool idle = m_visibility == VisibilityIdle;
+
+        // 只解码关键帧时直接丢弃其余包；恢复全帧率后从下一个关键帧开始，避免参考帧缺失
+        const DecodeRate rate = idle ? RateKeyframesOnly : decodeRate();
+        const bool isKey = packet->flags & AV_PKT_FLAG_KEY;
+        if (rate == RateKeyframesOnly)
+        {
+            m_rateNeedsKeyframe = true;
+        }
+        else if (isKey)
+        {
+            m_rateNeedsKeyframe = false;
+        }
+        if (m_rateNeedsKeyframe && !isKey)
+        {
+            (idle ? m_idlePacketsSkipped : m_rateSkippedPackets).fetch_add(1, std::memory_order_relaxed);
+            av_packet_unref(packet);
+            continue;
+        }
+
+        // 按解码时间戳判断是否落后于直播端，落后时逐级减少解码工作
+        const qint64 nowUs = LatencyTracer::nowUs();
+        const int64_t ts = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+        const CatchUpController::Level level =
+            m_catchUp.update(ts != AV_NOPTS_VALUE ? av_rescale_q(ts, timeBase, AV_TIME_BASE_Q) : AV_NOPTS_VALUE, nowUs);
+        if (level == CatchUpController::LevelFlush)
         {
-            ret = avcodec_send_packet(m_codecCtx, packet);
-            if (ret < 0 && ret != AVERROR(EAGAIN))
+            // 丢弃积压直接跳到最新的关键帧，解码器内尚未输出的帧一并丢弃；
+            // 刚取出的包本身就是最新的关键帧时保留它，从它重新开始解码
+            bool restartFromPacket = false;
+            const int flushed = m_packetQueue.flushToKeyframe(isKey, &restartFromPacket);
+            m_catchUp.countFlush(restartFromPacket ? flushed : flushed + 1);
+            avcodec_flush_buffers(m_codecCtx);
+            m_packetTimings.fill(PacketTiming());
+            if (!restartFromPacket)
             {
-                qWarning() << "Error sending packet:" << ret;
                 av_packet_unref(packet);
                 continue;
             }
+        }
+        m_codecCtx->skip_frame = level >= CatchUpController::LevelSkipNonRef || rate == RateReferenceOnly
+                                     ? AVDISCARD_NONREF
+                                     : AVDISCARD_DEFAULT;
+
+        // 记下该包的读取/送入时间，解码出对应帧时按 PTS 取回
+        rememberPacketTiming(packet, readUs, nowUs);
+        ret = avcodec_send_packet(m_codecCtx, packet);
+        av_packet_unref(packet);
+        if (ret < 0 && ret != AVERROR(EAGAIN))
+        {
+            qWarning() << "Error sending packet:" << ret;
+            m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+            markCorrupt(LatencyTracer::nowUs(), "decode error");
+            continue;
+        }
+        m_catchUp.countPacketSent();
+
+        // 循环接收解码帧
+        while (m_running.load())
+        {
+            ret = avcodec_receive_frame(m_codecCtx, frame);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+                break;
+            if (ret < 0)
+            {
+                qWarning() << "Error receiving frame:" << ret;
+                m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+                markCorrupt(LatencyTracer::nowUs(), "decode error");
+                break;
+            }
+
+            m_framesDecoded.fetch_add(1, std::memory_order_relaxed);
+            m_catchUp.countFrameDecoded();
+            FrameTiming timing = takePacketTiming(frame);
+            timing.receiveUs = LatencyTracer::nowUs();
+            const int64_t pts = frame->best_effort_timestamp;
+            timing.ptsUs = pts != AV_NOPTS_VALUE ? av_rescale_q(pts, timeBase, AV_TIME_BASE_Q) : AV_NOPTS_VALUE;
+
+            // 损坏期间（直到完好的关键帧）停在最后一帧完好画面，也不截取花屏
+            if (!checkIntegrity(frame, timing.receiveUs))
+            {
+                continue;
+            }
+
+            // 截图只增加帧引用，转换和编码在截图器的工作线程完成
+            if (snapshot && snapshot->wantsFrame(timing.receiveUs))
+            {
+                snapshot->submit(frame, timing.receiveUs);
+            }
 
-            // 循环接收解码帧
-            while (m_running.load())
+            if (firstFrame)
             {
-                ret = avcodec_receive_frame(m_codecCtx, frame);
-                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                    break;
-                if (ret < 0)
+                firstFrame = false;
+                onFirstFrame(startUs, timeBase);
+            }
+
+            // 不可见：只保留最后一帧的引用，恢复可见时直接转换显示
+            if (m_visibility != VisibilityVisible)
+            {
+                if (!m_hiddenFrame)
                 {
-                    qWarning() << "Error receiving frame:" << ret;
-                    break;
+                    m_hiddenFrame = av_frame_alloc();
                 }
+                av_frame_unref(m_hiddenFrame);
+                av_frame_move_ref(m_hiddenFrame, frame);
+                m_hiddenConversionsSkipped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // 追帧时后面已有包在排队的帧不会被显示，省去颜色转换
+            if (!m_catchUp.shouldConvert(m_packetQueue.size() > 0, timing.receiveUs))
+            {
+                continue;
+            }
 
-                // 颜色空间转换
-                sws_scale(m_swsCtx,
-                          frame->data, frame->linesize,
-                          0, codecPar->height,
-                          rgbFrame->data, rgbFrame->linesize);
+            // 直接转换到显示端当前的尺寸和像素格式
+            QImage image;
+            if (!convertFrame(frame, mailbox ? mailbox->targetSize() : QSize(), &image))
+            {
+                break;
+            }
+            timing.convertedUs = LatencyTracer::nowUs();
 
-                // 直接利用缓冲区数据构造 QImage 对象
-                QImage image(buffer, codecPar->width, codecPar->height, QImage::Format_RGB888);
-                emit frameReady(image);
+            if (presenter)
+            {
+                // 交给抖动缓冲按 PTS 定时显示，写入信箱的时间由显示端记录
+                presenter->push(image, timing, timing.ptsUs, timing.readUs);
+                m_tracer->recordDecoderStages(timing);
+                continue;
             }
+
+            // 交给显示端，未及显示的旧帧直接被覆盖；交接时刻由信箱在帧对显示端可见时记录
+            timing.handoffUs = mailbox ? mailbox->publish(image, timing) : LatencyTracer::nowUs();
+            m_tracer->recordDecoderStages(timing);
         }
-        av_packet_unref(packet);
     }
-
-    // 清理解码资源
-    av_free(buffer);
-    av_frame_free(&frame);
-    av_frame_free(&rgbFrame);
-    av_packet_free(&packet);
 }
 
-bool VideoDecoder::initDecoder()
+bool VideoDecoder::checkIntegrity(const AVFrame *frame, qint64 nowUs)
 {
-    AVCodecParameters *codecPar = m_formatCtx->streams[m_videoStream]->codecpar;
-    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
-    if (!codec)
+    // 错误隐藏、参考帧缺失等由解码器在帧上标记；之后的帧即使没有标记，也引用了损坏的画面
+    if ((frame->flags & AV_FRAME_FLAG_CORRUPT) || frame->decode_error_flags)
     {
-        qWarning() << "Unsupported codec:" << codecPar->codec_id;
-        return false;
+        m_corruptFrames.fetch_add(1, std::memory_order_relaxed);
+        markCorrupt(nowUs, frame->decode_error_flags & FF_DECODE_ERROR_MISSING_REFERENCE ? "missing reference"
+                                                                                         : "corrupt frame");
+    }
+    else if (m_corruptSinceUs && isKeyFrame(frame))
+    {
+        const qint64 recoveryUs = nowUs - m_corruptSinceUs;
+        m_corruptSinceUs = 0;
+        m_keyframeRequestUs = 0;
+        m_recoveries.fetch_add(1, std::memory_order_relaxed);
+        m_lastRecoveryUs.store(recoveryUs, std::memory_order_relaxed);
+        m_recoveryUsTotal.fetch_add(static_cast<quint64>(recoveryUs), std::memory_order_relaxed);
+        if (recoveryUs > m_maxRecoveryUs.load(std::memory_order_relaxed))
+        {
+            m_maxRecoveryUs.store(recoveryUs, std::memory_order_relaxed);
+        }
+        qInfo().noquote() << QString("[Keyframe] %1 clean after %2 ms").arg(m_url).arg(recoveryUs / 1000.0, 0, 'f', 1);
+    }
+    if (!m_corruptSinceUs)
+    {
+        return true;
     }
 
-    m_codecCtx = avcodec_alloc_context3(codec);
-    avcodec_parameters_to_context(m_codecCtx, codecPar);
-
-    // 设置低延迟以及多线程
-    m_codecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
-    m_codecCtx->flags2 |= AV_CODEC_FLAG2_FAST;
-    m_codecCtx->thread_count = 4;
-    m_codecCtx->thread_type = FF_THREAD_FRAME;
+    // 请求或摄像头的应答可能丢失，未恢复时限速重发
+    requestKeyframe(nowUs);
+    if (!m_config.CORRUPTION_FREEZE ||
+        nowUs - m_corruptSinceUs > static_cast<qint64>(m_config.CORRUPTION_FREEZE_MAX_MS) * 1000)
+    {
+        return true;
+    }
+    m_frozenFrames.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
 
-    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+void VideoDecoder::markCorrupt(qint64 nowUs, const char *reason)
+{
+    if (!m_corruptSinceUs)
     {
-        qWarning() << "Failed to open codec";
-        return false;
+        m_corruptSinceUs = nowUs;
+        m_corruptReason = reason;
+        m_corruptionEvents.fetch_add(1, std::memory_order_relaxed);
     }
-    return true;
+    requestKeyframe(nowUs);
 }
 
-bool VideoDecoder::initSwsContext()
+void VideoDecoder::requestKeyframe(qint64 nowUs)
 {
-    AVCodecParameters *codecPar = m_formatCtx->streams[m_videoStream]->codecpar;
-    m_swsCtx = sws_getContext(
-        codecPar->width, codecPar->height,
-        m_codecCtx->pix_fmt,
-        codecPar->width, codecPar->height,
-        AV_PIX_FMT_RGB24,
-        SWS_FAST_BILINEAR,
-        nullptr, nullptr, nullptr);
-    return m_swsCtx != nullptr;
+    if (!m_config.KEYFRAME_REQUEST_ENABLED ||
+        (m_keyframeRequestUs &&
+         nowUs - m_keyframeRequestUs < static_cast<qint64>(m_config.KEYFRAME_REQUEST_INTERVAL_MS) * 1000))
+    {
+        return;
+    }
+    m_keyframeRequestUs = nowUs;
+    m_keyframeRequests.fetch_add(1, std::memory_order_relaxed);
+    emit keyframeRequested(QString::fromLatin1(m_corruptReason));
 }
 
-void VideoDecoder::cleanup()
+void VideoDecoder::updateVisibility(const std::shared_ptr<FrameMailbox> &mailbox,
+                                    const std::shared_ptr<FramePresenter> &presenter, qint64 nowUs)
 {
-    if (m_codecCtx)
+    const bool visible = !mailbox || mailbox->isVisible();
+    Visibility next = VisibilityVisible;
+    if (!visible)
     {
-        avcodec_close(m_codecCtx);
-        avcodec_free_context(&m_codecCtx);
+        if (m_visibility == VisibilityVisible)
+        {
+            m_hiddenSinceUs = nowUs;
+        }
+        const bool idle = m_config.LAZY_IDLE_SECONDS > 0 &&
+                          nowUs - m_hiddenSinceUs >= static_cast<qint64>(m_config.LAZY_IDLE_SECONDS) * 1000000;
+        next = idle ? VisibilityIdle : VisibilityHidden;
     }
-    if (m_formatCtx)
+    if (next == m_visibility && nowUs - m_stateSinceUs < 1000000)
     {
-        avformat_close_input(&m_formatCtx);
+        return;
+    }
+
+    // 状态切换时（以及每秒一次）结算当前状态的时长和本线程 CPU 时间
+    const qint64 cpuUs = threadCpuUs();
+    m_stateWallUs[m_visibility].fetch_add(nowUs - m_stateSinceUs, std::memory_order_relaxed);
+    m_stateCpuUs[m_visibility].fetch_add(cpuUs - m_stateCpuSinceUs, std::memory_order_relaxed);
+    m_stateSinceUs = nowUs;
+    m_stateCpuSinceUs = cpuUs;
+    if (next == m_visibility)
+    {
+        return;
     }
-    if (m_swsCtx)
+    const Visibility previous = m_visibility;
+    m_visibility = next;
+    m_visibilityStat.store(next, std::memory_order_relaxed);
+
+    if (next == VisibilityVisible && previous != VisibilityVisible)
     {
-        sws_freeContext(m_swsCtx);
-        m_swsCtx = nullptr;
+        publishHiddenFrame(mailbox, presenter);
+    }
+}
+
+void VideoDecoder::publishHiddenFrame(const std::shared_ptr<FrameMailbox> &mailbox,
+                                      const std::shared_ptr<FramePresenter> &presenter)
+{
+    // 恢复可见时立即显示不可见期间最后解码的一帧，不必等待下一帧
+    if (!m_hiddenFrame || !m_hiddenFrame->buf[0] || !mailbox)
+    {
+        return;
+    }
+    QImage image;
+    if (convertFrame(m_hiddenFrame, mailbox->targetSize(), &image))
+    {
+        if (presenter)
+        {
+            presenter->push(image, FrameTiming(), AV_NOPTS_VALUE, 0);
+        }
+        else
+        {
+            mailbox->publish(image);
+        }
+    }
+    av_frame_unref(m_hiddenFrame);
+}
+
+void VideoDecoder::readLoop()
+{
+    AVPacket *packet = av_packet_alloc();
+    const bool pacing = m_readPacing.load();
+    int64_t firstTs = AV_NOPTS_VALUE;
+    qint64 firstUs = 0;
+    // 超过 READ_STALL_MS 没有读到任何数据视为断流，结束本次连接交给重连处理
+    setIoDeadline(m_config.READ_STALL_MS);
+    while (m_running.load())
+    {
+        const qint64 readBeginUs = av_gettime_relative();
+        int ret = av_read_frame(m_formatCtx, packet);
+        m_readFrameUsTotal.fetch_add(static_cast<quint64>(av_gettime_relative() - readBeginUs),
+                                     std::memory_order_relaxed);
+        if (ret < 0)
+        {
+            if (ret == AVERROR(EAGAIN) && !interruptCallback(this))
+            {
+                // 暂无数据，短暂休眠而不是空转
+                av_usleep(5000);
+                continue;
+            }
+            if (m_ioTimedOut.load())
+            {
+                qWarning() << "Read stalled for" << m_config.READ_STALL_MS << "ms";
+                countIoTimeout(m_readStalls);
+            }
+            else if (m_running.load() && ret != AVERROR_EOF)
+            {
+                qWarning() << "Read frame error:" << ret;
+            }
+            break;
+        }
+        m_packetsRead.fetch_add(1, std::memory_order_relaxed);
+
+        if (pacing && packet->stream_index == m_videoStream && packet->dts != AV_NOPTS_VALUE)
+        {
+            // 按第一个包以来的时间戳间隔等待，分段休眠以便及时响应停止
+            if (firstTs == AV_NOPTS_VALUE)
+            {
+                firstTs = packet->dts;
+                firstUs = av_gettime_relative();
+            }
+            const AVRational timeBase = m_formatCtx->streams[m_videoStream]->time_base;
+            const qint64 dueUs = firstUs + av_rescale_q(packet->dts - firstTs, timeBase, AV_TIME_BASE_Q);
+            for (qint64 waitUs = dueUs - av_gettime_relative(); waitUs > 0 && m_running.load();
+                 waitUs = dueUs - av_gettime_relative())
+            {
+                av_usleep(static_cast<unsigned>(qMin<qint64>(waitUs, 10000)));
+            }
+        }
+        setIoDeadline(m_config.READ_STALL_MS);
+
+        if (packet->stream_index == m_videoStream)
+        {
+            // 旁路接收端在入队前拿到全部视频包，不受解码端丢帧影响
+            writeSinks(packet);
+            m_packetQueue.push(packet);
+        }
+        else
+        {
+            pushAudioPacket(packet);
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    setIoDeadline(0);
+
+    // 排空后解码端自然结束
+    m_packetQueue.finish();
+}
+
+void VideoDecoder::pushAudioPacket(AVPacket *packet)
+{
+    if (!m_audio || (m_audioStream >= 0 && packet->stream_index != m_audioStream) ||
+        m_formatCtx->streams[packet->stream_index]->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
+    {
+        return;
+    }
+    if (m_audioStream < 0)
+    {
+        // 读到第一个音频包时解复用器已解析出音频参数（FLV 的音频流在此时才创建）
+        m_audioStream = packet->stream_index;
+        const AVStream *stream = m_formatCtx->streams[m_audioStream];
+        m_audio->beginStream(stream->codecpar, stream->time_base);
+    }
+    m_audio->pushPacket(packet);
+}
+
+void VideoDecoder::flushProbeAudio()
+{
+    for (AVPacket *&packet : m_probeAudio)
+    {
+        pushAudioPacket(packet);
+        av_packet_free(&packet);
+    }
+    m_probeAudio.clear();
+}
+
+void VideoDecoder::addPacketSink(std::shared_ptr<PacketSink> sink)
+{
+    QMutexLocker locker(&m_sinkMutex);
+    if (m_sinkPar)
+    {
+        sink->beginStream(m_sinkPar, m_sinkTimeBase);
+    }
+    m_sinks.push_back(std::move(sink));
+}
+
+void VideoDecoder::removePacketSink(const std::shared_ptr<PacketSink> &sink)
+{
+    QMutexLocker locker(&m_sinkMutex);
+    auto it = std::find(m_sinks.begin(), m_sinks.end(), sink);
+    if (it == m_sinks.end())
+    {
+        return;
+    }
+    if (m_sinkPar)
+    {
+        sink->endStream();
+    }
+    m_sinks.erase(it);
+}
+
+void VideoDecoder::beginSinkStream(AVRational timeBase)
+{
+    QMutexLocker locker(&m_sinkMutex);
+    avcodec_parameters_free(&m_sinkPar);
+    m_sinkPar = avcodec_parameters_alloc();
+    if (!m_sinkPar || avcodec_parameters_copy(m_sinkPar, m_formatCtx->streams[m_videoStream]->codecpar) < 0)
+    {
+        avcodec_parameters_free(&m_sinkPar);
+        return;
+    }
+    // 缓存路径下解复用器可能尚未给出尺寸，以解码器参数补齐
+    if (m_codecCtx && (m_sinkPar->width <= 0 || m_sinkPar->height <= 0))
+    {
+        m_sinkPar->width = m_codecCtx->width;
+        m_sinkPar->height = m_codecCtx->height;
+    }
+    m_sinkTimeBase = timeBase;
+    for (const std::shared_ptr<PacketSink> &sink : m_sinks)
+    {
+        sink->beginStream(m_sinkPar, timeBase);
+    }
+}
+
+void VideoDecoder::writeSinks(const AVPacket *packet)
+{
+    QMutexLocker locker(&m_sinkMutex);
+    if (!m_sinkPar)
+    {
+        return;
+    }
+    for (const std::shared_ptr<PacketSink> &sink : m_sinks)
+    {
+        sink->writePacket(packet);
+    }
+}
+
+void VideoDecoder::endSinkStream()
+{
+    QMutexLocker locker(&m_sinkMutex);
+    if (!m_sinkPar)
+    {
+        return;
+    }
+    for (const std::shared_ptr<PacketSink> &sink : m_sinks)
+    {
+        sink->endStream();
+    }
+    avcodec_parameters_free(&m_sinkPar);
+}
+
+bool VideoDecoder::openFromProbeCache(AVPacket *firstPacket, AVRational *timeBase)
+{
+    AVCodecParameters *cachedPar = avcodec_parameters_alloc();
+    if (!cachedPar || !StreamProbeCache::load(m_url, cachedPar, timeBase))
+    {
+        avcodec_parameters_free(&cachedPar);
+        return false;
+    }
+
+    // 读到第一个视频包为止，此时解复用器已解析出流的实际参数（FLV 的 extradata 在此之前到达）
+    bool matched = false;
+    bool sawVideo = false;
+    int packets = 0;
+    while (m_running.load() && packets < kProbeCachePackets)
+    {
+        int ret = av_read_frame(m_formatCtx, firstPacket);
+        if (ret == AVERROR(EAGAIN))
+        {
+            if (interruptCallback(this))
+            {
+                break;
+            }
+            av_usleep(5000);
+            continue;
+        }
+        if (ret < 0)
+        {
+            break;
+        }
+        packets++;
+        const AVStream *stream = m_formatCtx->streams[firstPacket->stream_index];
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            sawVideo = true;
+            matched = StreamProbeCache::matches(cachedPar, stream->codecpar);
+            if (matched)
+            {
+                m_videoStream = firstPacket->stream_index;
+                *timeBase = stream->time_base;
+            }
+            break;
+        }
+        if (m_audio && stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+        {
+            // 视频包之前的音频包暂存，音频分支启动后再送入；改做完整探测时也保留，探测读到的包随后才交出
+            AVPacket *audio = av_packet_alloc();
+            if (audio)
+            {
+                av_packet_move_ref(audio, firstPacket);
+                m_probeAudio.push_back(audio);
+            }
+        }
+        av_packet_unref(firstPacket);
+    }
+
+    if (matched)
+    {
+        matched = prepareDecoder(cachedPar);
+    }
+    if (!matched)
+    {
+        // 超时或停止导致没读到视频包时不算缓存失效
+        if (sawVideo)
+        {
+            qInfo() << "Stream probe cache mismatch, falling back to full probe";
+            StreamProbeCache::remove(m_url);
+        }
+        av_packet_unref(firstPacket);
+        m_videoStream = -1;
+    }
+    avcodec_parameters_free(&cachedPar);
+    return matched;
+}
+
+bool VideoDecoder::probeStream(AVRational *timeBase, QString *error)
+{
+    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0)
+    {
+        *error = "Failed to get stream info";
+        return false;
+    }
+
+    // 查找视频流
+    for (unsigned i = 0; i < m_formatCtx->nb_streams; i++)
+    {
+        if (m_formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            m_videoStream = i;
+            break;
+        }
+    }
+
+    if (m_videoStream == -1 || !prepareDecoder(m_formatCtx->streams[m_videoStream]->codecpar))
+    {
+        *error = "No video stream found";
+        return false;
+    }
+    *timeBase = m_formatCtx->streams[m_videoStream]->time_base;
+    return true;
+}
+
+void VideoDecoder::onFirstFrame(qint64 startUs, AVRational timeBase)
+{
+    const qint64 firstFrameUs = LatencyTracer::nowUs() - startUs;
+    m_firstFrameUs.store(firstFrameUs, std::memory_order_relaxed);
+    const bool cached = m_probeCached.load(std::memory_order_relaxed);
+    qInfo().noquote() << QString("[Startup] %1 probe: open %2 ms, probe %3 ms, first frame %4 ms")
+                             .arg(cached ? "cached" : "full")
+                             .arg(m_openUs.load(std::memory_order_relaxed) / 1000.0, 0, 'f', 1)
+                             .arg(m_probeUs.load(std::memory_order_relaxed) / 1000.0, 0, 'f', 1)
+                             .arg(firstFrameUs / 1000.0, 0, 'f', 1);
+
+    // 重连成功：记录从断开到重新出帧的时间，退避归零
+    m_reconnectAttempt = 0;
+    if (m_reconnectLostUs)
+    {
+        const qint64 reconnectUs = LatencyTracer::nowUs() - m_reconnectLostUs;
+        m_reconnectLostUs = 0;
+        m_reconnects.fetch_add(1, std::memory_order_relaxed);
+        m_lastReconnectUs.store(reconnectUs, std::memory_order_relaxed);
+        m_reconnectUsTotal.fetch_add(static_cast<quint64>(reconnectUs), std::memory_order_relaxed);
+        qInfo().noquote() << QString("[Reconnect] recovered in %1 ms (decoder %2)")
+                                 .arg(reconnectUs / 1000.0, 0, 'f', 1)
+                                 .arg(m_decoderReused ? "reused" : "reopened");
+    }
+
+    // 以解码器实际得到的参数（尺寸、像素格式已确定）更新缓存
+    if (m_config.STREAM_PROBE_CACHE)
+    {
+        AVCodecParameters *par = avcodec_parameters_alloc();
+        if (par && avcodec_parameters_from_context(par, m_codecCtx) >= 0)
+        {
+            StreamProbeCache::save(m_url, par, timeBase);
+        }
+        avcodec_parameters_free(&par);
+    }
+}
+
+void VideoDecoder::rememberPacketTiming(const AVPacket *packet, qint64 readUs, qint64 sendUs)
+{
+    PacketTiming &slot = m_packetTimings[m_packetTimingIndex];
+    m_packetTimingIndex = (m_packetTimingIndex + 1) % m_packetTimings.size();
+    slot.pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+    slot.readUs = readUs;
+    slot.sendUs = sendUs;
+}
+
+FrameTiming VideoDecoder::takePacketTiming(const AVFrame *frame)
+{
+    FrameTiming timing;
+    const int64_t pts = frame->pts != AV_NOPTS_VALUE ? frame->pts : frame->pkt_dts;
+    if (pts == AV_NOPTS_VALUE)
+    {
+        return timing;
+    }
+    // 帧可能因 B 帧重排而乱序输出，按 PTS 查找
+    for (PacketTiming &slot : m_packetTimings)
+    {
+        if (slot.pts == pts && slot.sendUs)
+        {
+            timing.readUs = slot.readUs;
+            timing.sendUs = slot.sendUs;
+            slot = PacketTiming();
+            break;
+        }
+    }
+    return timing;
+}
+
+bool VideoDecoder::prepareDecoder(const AVCodecParameters *codecPar)
+{
+    // 重连后参数不变时沿用已打开的解码器，只清空其内部缓存的帧
+    m_decoderReused = false;
+    if (m_codecCtx)
+    {
+        AVCodecParameters *current = avcodec_parameters_alloc();
+        if (current && avcodec_parameters_from_context(current, m_codecCtx) >= 0 &&
+            StreamProbeCache::matches(current, codecPar) && m_activeProfile == decoderProfile() &&
+            m_activeThreadSetting == decoderThreads())
+        {
+            m_decoderReused = true;
+        }
+        avcodec_parameters_free(&current);
+        if (m_decoderReused)
+        {
+            avcodec_flush_buffers(m_codecCtx);
+            m_packetTimings.fill(PacketTiming());
+            m_decoderReuses.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return initDecoder(codecPar, decoderProfile(), decoderThreads());
+}
+
+bool VideoDecoder::initDecoder(const AVCodecParameters *codecPar, DecoderProfile::Profile profile, int threads)
+{
+    if (m_codecCtx)
+    {
+        avcodec_free_context(&m_codecCtx);
+    }
+    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
+    if (!codec)
+    {
+        qWarning() << "Unsupported codec:" << codecPar->codec_id;
+        return false;
+    }
+
+    m_codecCtx = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(m_codecCtx, codecPar);
+
+    // 按配置档设置多线程方式（低延迟 / 平衡 / 吞吐）
+    DecoderProfile::apply(m_codecCtx, profile, threads > 0 ? threads : m_config.DECODER_THREADS);
+
+    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+    {
+        qWarning() << "Failed to open codec with profile" << DecoderProfile::name(profile) << "threads:" << threads;
+        // 不保留未打开的上下文
+        avcodec_free_context(&m_codecCtx);
+        return false;
+    }
+    m_activeProfile = profile;
+    m_activeThreadSetting = threads;
+    m_activeProfileStat.store(profile, std::memory_order_relaxed);
+    m_decoderThreads.store(m_codecCtx->thread_count, std::memory_order_relaxed);
+    m_activeThreadType.store(DecoderProfile::activeThreadTypeName(m_codecCtx), std::memory_order_relaxed);
+    return true;
+}
+
+bool VideoDecoder::switchDecoderProfile(const AVPacket *packet)
+{
+    // 只重新打开解码器，输入和转换部分保持不变
+    const DecoderProfile::Profile previousProfile = m_activeProfile;
+    const int previousThreads = m_activeThreadSetting;
+    AVCodecParameters *par = avcodec_parameters_alloc();
+    if (!par || avcodec_parameters_from_context(par, m_codecCtx) < 0)
+    {
+        // 原解码器未动，撤销请求继续使用
+        avcodec_parameters_free(&par);
+        m_requestedProfile.store(previousProfile);
+        m_requestedThreads.store(previousThreads);
+        qWarning() << "Failed to switch decoder profile: cannot copy codec parameters";
+        return true;
+    }
+    const DecoderProfile::Profile profile = decoderProfile();
+    const int threads = decoderThreads();
+    if (!initDecoder(par, profile, threads))
+    {
+        // 新配置打不开：改回原配置档和线程数，避免之后每个包都重试
+        m_requestedProfile.store(previousProfile);
+        m_requestedThreads.store(previousThreads);
+        if (!initDecoder(par, previousProfile, previousThreads))
+        {
+            // 原配置也打不开时 m_codecCtx 为空，由解码循环结束本次连接
+            avcodec_parameters_free(&par);
+            emit errorOccurred("Failed to reopen decoder");
+            return false;
+        }
+        // 已恢复原配置档，画面不中断，只记日志而不经 errorOccurred（界面会因此停止这一路）
+        qWarning().noquote() << QString("Failed to open decoder with profile %1, keeping %2")
+                                    .arg(DecoderProfile::name(profile), DecoderProfile::name(previousProfile));
+    }
+    else
+    {
+        m_profileSwitches.fetch_add(1, std::memory_order_relaxed);
+        qInfo() << "Decoder profile switched to" << DecoderProfile::name(m_activeProfile)
+                << "threads:" << m_codecCtx->thread_count
+                << "active:" << DecoderProfile::activeThreadTypeName(m_codecCtx);
+    }
+    avcodec_parameters_free(&par);
+    m_packetTimings.fill(PacketTiming());
+
+    // 新解码器需从关键帧开始
+    if (packet->flags & AV_PKT_FLAG_KEY)
+    {
+        return true;
+    }
+    m_packetQueue.flushToKeyframe();
+    return false;
+}
+
+void VideoDecoder::setDecoderProfile(DecoderProfile::Profile profile)
+{
+    m_requestedProfile.store(profile);
+}
+
+DecoderProfile::Profile VideoDecoder::decoderProfile() const
+{
+    return static_cast<DecoderProfile::Profile>(m_requestedProfile.load());
+}
+
+void VideoDecoder::setDecoderThreads(int threadCount)
+{
+    m_requestedThreads.store(qMax(0, threadCount));
+}
+
+int VideoDecoder::decoderThreads() const
+{
+    return m_requestedThreads.load();
+}
+
+void VideoDecoder::setDecodeRate(DecodeRate rate)
+{
+    m_decodeRate.store(rate);
+}
+
+VideoDecoder::DecodeRate VideoDecoder::decodeRate() const
+{
+    return static_cast<DecodeRate>(m_decodeRate.load());
+}
+
+bool VideoDecoder::decodeRateFromName(const QString &name, DecodeRate *rate)
+{
+    if (name == "full")
+    {
+        *rate = RateFull;
+    }
+    else if (name == "nonref")
+    {
+        *rate = RateReferenceOnly;
+    }
+    else if (name == "keyframes")
+    {
+        *rate = RateKeyframesOnly;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+int VideoDecoder::planBands(const AVFrame *frame, const QSize &outputSize) const
+{
+    // 低分辨率帧单线程转换即可，拆分反而增加同步开销
+    if (static_cast<qint64>(frame->width) * frame->height < m_config.CONVERT_BAND_MIN_PIXELS)
+    {
+        return 1;
+    }
+    // 每段至少 32 行
+    return qBound(1, qMin(m_convertPool->threadCount(), outputSize.height() / 32), kMaxBands);
+}
+
+bool VideoDecoder::initSwsContext(const AVFrame *frame, const QSize &outputSize, int bands)
+{
+    SwsContextCache::Key key;
+    key.srcFormat = frame->format;
+    key.srcWidth = frame->width;
+    key.srcHeight = frame->height;
+    key.dstFormat = AV_PIX_FMT_RGB32;
+    key.dstWidth = outputSize.width();
+    key.dstHeight = outputSize.height();
+    key.bands = bands;
+    key.colorspace = frame->colorspace == AVCOL_SPC_BT709 ? SWS_CS_ITU709 : SWS_CS_DEFAULT;
+    key.range = (frame->color_range == AVCOL_RANGE_JPEG || frame->format == AV_PIX_FMT_YUVJ420P) ? 1 : 0;
+
+    // 与上一帧配置相同时直接使用；否则先在缓存中找之前建好的上下文
+    if (m_swsBands && key == m_swsKey)
+    {
+        return true;
+    }
+    if (const std::vector<SwsContextCache::Band> *cached = m_swsCache.find(key))
+    {
+        m_swsBands = cached;
+        m_swsKey = key;
+        return true;
+    }
+
+    const qint64 buildBeginUs = av_gettime_relative();
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    if (!desc)
+    {
+        return false;
+    }
+
+    // 按输出行均分为若干段，各段的上下文互不相关，由共享的转换线程池并行执行
+    const bool scaled = outputSize != QSize(frame->width, frame->height);
+    std::vector<SwsContextCache::Band> plan(static_cast<size_t>(bands));
+    if (scaled)
+    {
+        // 缩放时插值要用到段边界两侧的输入行：每段一个整帧尺寸的上下文，整帧送入，只取回本段的输出行
+        for (int i = 0; i < bands; i++)
+        {
+            SwsContextCache::Band &band = plan[i];
+            band.dstY = outputSize.height() * i / bands;
+            band.dstH = outputSize.height() * (i + 1) / bands - band.dstY;
+            band.srcY = 0;
+            band.srcH = frame->height;
+        }
+    }
+    else
+    {
+        // 不缩放时输入输出行一一对应：以色度垂直采样对齐的行数为单位分段，输入与输出行范围相同
+        const int align = 1 << desc->log2_chroma_h;
+        const int units = (frame->height + align - 1) / align;
+        for (int i = 0; i < bands; i++)
+        {
+            SwsContextCache::Band &band = plan[i];
+            band.dstY = units * i / bands * align;
+            const int end = i == bands - 1 ? frame->height : units * (i + 1) / bands * align;
+            band.dstH = end - band.dstY;
+            band.srcY = band.dstY;
+            band.srcH = band.dstH;
+        }
+    }
+    for (const SwsContextCache::Band &band : plan)
+    {
+        if (band.srcH <= 0 || band.dstH <= 0)
+        {
+            // 分段过细，退化为单段
+            return initSwsContext(frame, outputSize, 1);
+        }
+    }
+
+    const int *srcCoeffs = sws_getCoefficients(key.colorspace);
+    for (SwsContextCache::Band &band : plan)
+    {
+        band.ctx = sws_alloc_context();
+        if (!band.ctx)
+        {
+            SwsContextCache::freeBands(plan);
+            return false;
+        }
+        av_opt_set_int(band.ctx, "srcw", frame->width, 0);
+        av_opt_set_int(band.ctx, "srch", band.srcH, 0);
+        av_opt_set_int(band.ctx, "src_format", frame->format, 0);
+        av_opt_set_int(band.ctx, "dstw", outputSize.width(), 0);
+        av_opt_set_int(band.ctx, "dsth", scaled ? outputSize.height() : band.dstH, 0);
+        av_opt_set_int(band.ctx, "dst_format", AV_PIX_FMT_RGB32, 0);
+        av_opt_set_int(band.ctx, "sws_flags", SWS_FAST_BILINEAR, 0);
+        if (sws_init_context(band.ctx, nullptr, nullptr) < 0)
+        {
+            SwsContextCache::freeBands(plan);
+            return false;
+        }
+        const int sliceAlign = sws_receive_slice_alignment(band.ctx);
+        if (scaled && bands > 1 && (band.dstY % sliceAlign || band.dstH % sliceAlign))
+        {
+            // 输出格式要求取回的行段对齐而本段不满足，退化为单段
+            SwsContextCache::freeBands(plan);
+            return initSwsContext(frame, outputSize, 1);
+        }
+        // 与 YuvConverter 使用相同的色彩空间和取值范围，两条路径切换时颜色一致
+        sws_setColorspaceDetails(band.ctx, srcCoeffs, key.range,
+                                 sws_getCoefficients(SWS_CS_DEFAULT), 1,
+                                 0, 1 << 16, 1 << 16);
+    }
+
+    m_swsBands = &m_swsCache.insert(key, std::move(plan), av_gettime_relative() - buildBeginUs);
+    m_swsKey = key;
+    return true;
+}
+
+void VideoDecoder::freeSwsContexts()
+{
+    m_swsBands = nullptr;
+    m_swsKey = SwsContextCache::Key();
+    m_swsCache.clear();
+}
+
+bool VideoDecoder::convertFrame(const AVFrame *frame, const QSize &viewport, QImage *image)
+{
+    const qint64 startUs = av_gettime_relative();
+    if (frame->width <= 0 || frame->height <= 0)
+    {
+        return false;
+    }
+
+    // 保持宽高比缩放到显示区域内；显示端尺寸未知时按原始分辨率输出
+    const QSize inputSize(frame->width, frame->height);
+    QSize outputSize = inputSize;
+    if (viewport.isValid() && !viewport.isEmpty())
+    {
+        outputSize.scale(viewport, Qt::KeepAspectRatio);
+        outputSize = outputSize.expandedTo(QSize(2, 2));
+    }
+
+    // 逐帧检查输入的分辨率和像素格式：摄像头切换模式或编码器切换格式时，从这一帧起按新参数转换
+    const bool inputChanged = inputSize != m_convertInputSize || frame->format != m_convertInputFormat;
+    const bool reconfigure = inputChanged || outputSize != m_convertOutputSize;
+    if (inputChanged && m_convertInputSize.isValid())
+    {
+        m_inputChanges.fetch_add(1, std::memory_order_relaxed);
+        qInfo().noquote() << QString("[Convert] input changed: %1x%2 %3 -> %4x%5 %6")
+                                 .arg(m_convertInputSize.width())
+                                 .arg(m_convertInputSize.height())
+                                 .arg(QString::fromLatin1(av_get_pix_fmt_name(static_cast<AVPixelFormat>(m_convertInputFormat))))
+                                 .arg(frame->width)
+                                 .arg(frame->height)
+                                 .arg(QString::fromLatin1(av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format))));
+    }
+
+    // 不需要缩放的 4:2:0 帧走向量化转换，其余情况交给 sws_scale
+    const bool useSimd = outputSize == inputSize &&
+                         YuvConverter::supports(frame);
+    int bands = planBands(frame, outputSize);
+    if (!useSimd)
+    {
+        if (!initSwsContext(frame, outputSize, bands))
+        {
+            emit errorOccurred("Failed to initialize sws context");
+            return false;
+        }
+        bands = static_cast<int>(m_swsBands->size());
+    }
+    m_outputSize.store(packSize(outputSize), std::memory_order_relaxed);
+
+    // 缓冲池的缓冲区容纳不下新尺寸时重建缓冲池，旧池随最后一帧释放
+    const int bytesPerLine = FFALIGN(outputSize.width() * 4, 32);
+    const int required = bytesPerLine * outputSize.height();
+    if (!m_framePool || m_framePool->bufferSize() < required)
+    {
+        // 抖动缓冲中的帧也占用缓冲区，按其容量额外预留
+        const std::shared_ptr<FramePresenter> presenter = std::atomic_load(&m_presenter);
+        const int capacity = m_config.FRAME_POOL_SIZE + (presenter ? presenter->capacity() : 0);
+        std::atomic_store(&m_framePool, FramePool::create(capacity, required));
+    }
+    if (reconfigure)
+    {
+        // 配置变化的这一帧多花的准备时间（取回或新建 sws 上下文、重建缓冲池）
+        const qint64 reconfigUs = av_gettime_relative() - startUs;
+        m_reconfigurations.fetch_add(1, std::memory_order_relaxed);
+        m_lastReconfigUs.store(reconfigUs, std::memory_order_relaxed);
+        if (reconfigUs > m_maxReconfigUs.load(std::memory_order_relaxed))
+        {
+            m_maxReconfigUs.store(reconfigUs, std::memory_order_relaxed);
+        }
+        m_convertInputSize = inputSize;
+        m_convertInputFormat = frame->format;
+        m_convertOutputSize = outputSize;
+    }
+
+    // Format_RGB32 与 AV_PIX_FMT_RGB32 内存布局一致，Qt 绘制时无需再做格式转换
+    *image = m_framePool->acquireImage(outputSize.width(), outputSize.height(),
+                                       bytesPerLine, QImage::Format_RGB32);
+    if (image->isNull())
+    {
+        qWarning() << "Failed to acquire frame buffer";
+        return false;
+    }
+
+    // 颜色空间转换，直接写入缓冲池中的缓冲区；高分辨率帧按行段分给工作线程并行处理
+    uint8_t *dst = image->bits();
+    if (useSimd)
+    {
+        m_convertPool->run(bands, [&](int i)
+                           {
+                               // 行段起点取偶数，保证每段从完整的色度行开始
+                               const int rowBegin = frame->height * i / bands & ~1;
+                               const int rowEnd = i == bands - 1 ? frame->height
+                                                                 : frame->height * (i + 1) / bands & ~1;
+                               m_yuvConverter.convert(frame, dst, bytesPerLine, rowBegin, rowEnd); });
+        m_simdFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (outputSize != inputSize)
+    {
+        // 缩放：各段的上下文都送入整帧，只取回本段的输出行，在共享的转换线程池中并行
+        if (!m_swsDstFrame)
+        {
+            m_swsDstFrame = av_frame_alloc();
+        }
+        m_swsDstFrame->format = AV_PIX_FMT_RGB32;
+        m_swsDstFrame->width = outputSize.width();
+        m_swsDstFrame->height = outputSize.height();
+        m_swsDstFrame->data[0] = dst;
+        m_swsDstFrame->linesize[0] = bytesPerLine;
+        m_swsDstFrame->buf[0] = av_buffer_create(dst, required, keepBuffer, nullptr, 0);
+        std::atomic<int> error{m_swsDstFrame->buf[0] ? 0 : AVERROR(ENOMEM)};
+        if (!error.load())
+        {
+            m_convertPool->run(bands, [&](int i)
+                               {
+                                   const SwsContextCache::Band &band = (*m_swsBands)[i];
+                                   int ret = sws_frame_start(band.ctx, m_swsDstFrame, frame);
+                                   if (ret >= 0)
+                                   {
+                                       ret = sws_send_slice(band.ctx, 0, frame->height);
+                                   }
+                                   if (ret >= 0)
+                                   {
+                                       ret = sws_receive_slice(band.ctx, band.dstY, band.dstH);
+                                   }
+                                   sws_frame_end(band.ctx);
+                                   if (ret < 0)
+                                   {
+                                       error.store(ret);
+                                   } });
+        }
+        av_frame_unref(m_swsDstFrame);
+        if (error.load() < 0)
+        {
+            qWarning() << "sws scaling failed:" << error.load();
+            return false;
+        }
+    }
+    else
+    {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+        m_convertPool->run(bands, [&](int i)
+                           {
+                               const SwsContextCache::Band &band = (*m_swsBands)[i];
+                               const uint8_t *srcData[4] = {nullptr, nullptr, nullptr, nullptr};
+                               for (int p = 0; p < 4 && frame->data[p]; p++)
+                               {
+                                   const int shift = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+                                   srcData[p] = frame->data[p] + static_cast<ptrdiff_t>(band.srcY >> shift) * frame->linesize[p];
+                               }
+                               uint8_t *dstData[4] = {dst + static_cast<ptrdiff_t>(band.dstY) * bytesPerLine,
+                                                      nullptr, nullptr, nullptr};
+                               int dstLinesize[4] = {bytesPerLine, 0, 0, 0};
+                               sws_scale(band.ctx, srcData, frame->linesize, 0, band.srcH,
+                                         dstData, dstLinesize); });
+    }
+    if (bands > 1)
+    {
+        m_bandedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_framesConverted.fetch_add(1, std::memory_order_relaxed);
+    const qint64 elapsedUs = av_gettime_relative() - startUs;
+    m_convertUsTotal.fetch_add(static_cast<quint64>(elapsedUs), std::memory_order_relaxed);
+    m_lastConvertUs.store(elapsedUs, std::memory_order_relaxed);
+    return true;
+}
+
+void VideoDecoder::cleanup()
+{
+    if (m_codecCtx)
+    {
+        avcodec_close(m_codecCtx);
+        avcodec_free_context(&m_codecCtx);
     }
+    closeInput();
+    av_frame_free(&m_hiddenFrame);
+    av_frame_free(&m_swsDstFrame);
+    freeSwsContexts();
 }
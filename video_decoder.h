@@ -7,6 +7,9 @@
 #include <QWaitCondition>
 #include <QMutex>
 #include <atomic>  // 用于原子类型
+#include <array>
+#include <memory>
+#include <vector>
 
 extern "C"
 {
@@ -16,49 +19,462 @@ extern "C"
 }
 
 #include "config.h"
+#include "frame_pool.h"
+#include "frame_mailbox.h"
+#include "packet_queue.h"
+#include "yuv_convert.h"
+#include "sws_context_cache.h"
+#include "convert_worker_pool.h"
+#include "latency_tracer.h"
+#include "catch_up_controller.h"
+#include "stream_probe_cache.h"
+#include "decoder_profile.h"
+#include "packet_sink.h"
+#include "snapshot_capture.h"
+#include "input_source.h"
+#include "stream_transport.h"
+#include "frame_presenter.h"
+#include "audio_decoder.h"
 
 /**
  * @brief 负责从视频流中解码视频帧，并通过信号传递给界面显示
+ *
+ * 连接建立后如果读取出错或流结束，只重新打开输入并按指数退避重试，
+ * 参数不变时解码器、sws 上下文和帧缓冲池都保留复用，界面继续显示最后一帧。
  */
 class VideoDecoder : public QThread
 {
     Q_OBJECT
 public:
-    explicit VideoDecoder(const AppConfig &cfg, QObject *parent = nullptr);
+    /**
+     * @brief 解码与颜色转换统计信息
+     */
+    struct Stats
+    {
+        quint64 framesDecoded = 0;      // 解码输出的帧数
+        quint64 framesConverted = 0;    // 完成颜色转换的帧数
+        double avgConvertMs = 0;        // 平均每帧颜色转换耗时
+        double lastConvertMs = 0;       // 最近一帧颜色转换耗时
+        QSize outputSize;               // 当前输出尺寸（即显示端尺寸）
+        quint64 swsRebuilds = 0;        // 新建 sws 上下文的次数（缓存未命中）
+        quint64 swsCacheHits = 0;       // 配置变化时从缓存取回 sws 上下文的次数
+        quint64 swsCacheEvictions = 0;  // 缓存已满淘汰最久未用配置的次数
+        int swsCacheSize = 0;           // 当前缓存的配置数
+        double avgSwsBuildMs = 0;       // 新建一组 sws 上下文的平均耗时
+        double maxSwsBuildMs = 0;       // 新建一组 sws 上下文的最大耗时
+        quint64 inputChanges = 0;       // 解码帧分辨率或像素格式变化的次数
+        quint64 reconfigurations = 0;   // 转换配置（输入或输出尺寸、格式）变化的次数
+        double lastReconfigMs = 0;      // 最近一次配置变化的那一帧多花的准备时间（上下文和缓冲池）
+        double maxReconfigMs = 0;       // 配置变化时准备时间的最大值
+        quint64 simdFrames = 0;         // 由向量化内核（而非 sws_scale）转换的帧数
+        const char *simdKernel = "";    // 当前使用的向量化内核名称
+        quint64 bandedFrames = 0;       // 分段并行转换的帧数
+        int convertThreads = 0;         // 转换工作线程数
+        const char *decoderProfile = "";    // 当前解码器多线程配置档
+        int decoderThreads = 0;             // 解码线程数
+        const char *decoderThreadType = ""; // 实际生效的多线程方式（frame / slice / none）
+        quint64 profileSwitches = 0;        // 运行中切换配置档的次数
+        quint64 rateSkippedPackets = 0;     // 因降低解码帧率而丢弃的包数
+        bool probeCached = false;       // 本次启动是否使用了缓存的流参数
+        double openMs = 0;              // avformat_open_input 耗时
+        double probeMs = 0;             // 取得流参数并打开解码器的耗时（缓存路径含校验）
+        double timeToFirstFrameMs = 0;  // 从启动到第一帧交给显示端的耗时，0 表示尚未出帧
+        quint64 reconnects = 0;         // 断线后成功恢复出帧的次数
+        quint64 reconnectAttempts = 0;  // 重连尝试次数（含失败）
+        quint64 decoderReuses = 0;      // 重连时沿用原解码器的次数
+        double lastReconnectMs = 0;     // 最近一次从断开到重新出帧的耗时
+        double avgReconnectMs = 0;      // 平均恢复耗时
+        quint64 openTimeouts = 0;       // 打开输入超时次数
+        quint64 probeTimeouts = 0;      // 探测流参数超时次数
+        quint64 readStalls = 0;         // 读取超时（断流）次数
+        double lastStopMs = 0;          // 最近一次 stop() 等待线程退出的耗时
+        const char *visibility = "";    // 显示端可见状态：visible / hidden（只解码）/ idle（只解码关键帧）
+        quint64 hiddenConversionsSkipped = 0;   // 不可见期间省去的颜色转换次数
+        double hiddenConvertMsSaved = 0;        // 按平均转换耗时估算省去的转换时间
+        quint64 idlePacketsSkipped = 0;         // 长时间不可见、只解码关键帧期间丢弃的包数
+        double visibleMs = 0, hiddenMs = 0, idleMs = 0;         // 各状态累计时长
+        double visibleCpuMs = 0, hiddenCpuMs = 0, idleCpuMs = 0; // 各状态下解码线程累计 CPU 时间
+        const char *inputSource = "";   // 输入来源（url / ring）
+        double avgDemuxUs = 0;          // 平均每包解复用耗时（扣除输入来源等待数据的时间；网络地址含网络等待）
+        double inputWaitMs = 0;         // 输入来源累计等待数据的时间
+        const char *transport = "";     // 本次连接实际使用的传输方式（本地文件、环形缓冲为 auto）
+        quint64 decodeErrors = 0;       // 送包或取帧出错的次数
+        quint64 corruptFrames = 0;      // 带损坏标记（错误隐藏、参考帧缺失）的帧数
+        quint64 corruptionEvents = 0;   // 画面由完好变为损坏的次数
+        quint64 keyframeRequests = 0;   // 发出的关键帧请求数（含未恢复时的重发）
+        quint64 frozenFrames = 0;       // 损坏期间未显示、停在最后一帧完好画面的帧数
+        quint64 recoveries = 0;         // 损坏后解码出完好关键帧的次数
+        double lastRecoveryMs = 0;      // 最近一次从发现损坏到完好画面的耗时
+        double avgRecoveryMs = 0;       // 平均恢复耗时
+        double maxRecoveryMs = 0;       // 最大恢复耗时
+    };
+
+    /**
+     * @brief 解码帧率档位，多路显示时非焦点画面降低解码开销
+     */
+    enum DecodeRate
+    {
+        RateFull,               // 解码全部帧
+        RateReferenceOnly,      // 丢弃非参考帧（skip_frame = AVDISCARD_NONREF）
+        RateKeyframesOnly       // 只解码关键帧，其余包送入解码器前丢弃
+    };
+
+    /**
+     * @param url 流地址，为空时使用 cfg.RTMP_URL
+     * @param convertPool 颜色转换线程池，多路解码器共享同一个池；为空时自建
+     */
+    explicit VideoDecoder(const AppConfig &cfg, const QString &url = QString(),
+                          std::shared_ptr<ConvertWorkerPool> convertPool = nullptr,
+                          QObject *parent = nullptr);
     ~VideoDecoder();
 
     /**
      * @brief 停止解码线程，并安全退出（不使用强制终止）
+     *
+     * 阻塞中的打开、探测和读取操作由中断回调打断，返回时间不依赖网络状况。
      */
     void stop();
 
-signals:
     /**
-     * @brief 当视频帧解码完成后发出信号
-     * @param frame 解码后的 QImage 对象
+     * @brief 获取输出帧缓冲池的统计信息（可在任意线程调用）
+     */
+    FramePool::Stats framePoolStats() const;
+
+    /**
+     * @brief 获取解码与颜色转换统计信息（可在任意线程调用）
+     */
+    Stats stats() const;
+
+    /**
+     * @brief 获取读取线程与解码线程之间压缩包队列的统计信息
+     */
+    PacketQueue::Stats packetQueueStats() const;
+
+    /**
+     * @brief 获取直播追帧的当前级别与丢帧统计
+     */
+    CatchUpController::Stats catchUpStats() const;
+
+    /**
+     * @brief 逐帧各阶段延迟统计，显示端记录绘制阶段后可得到端到端延迟
+     */
+    std::shared_ptr<LatencyTracer> latencyTracer() const;
+
+    /**
+     * @brief 切换解码器多线程配置档，可在任意线程调用
+     *
+     * 解码中切换时只重新打开解码器（从下一个关键帧开始），输入连接不受影响。
+     */
+    void setDecoderProfile(DecoderProfile::Profile profile);
+    DecoderProfile::Profile decoderProfile() const;
+
+    /**
+     * @brief 设置本解码器的解码线程数（0 表示按配置），切换方式同 setDecoderProfile()
+     *
+     * FFmpeg 的解码线程属于各自的解码上下文，多路解码时通过给每路分配线程数限制总线程数。
+     */
+    void setDecoderThreads(int threadCount);
+    int decoderThreads() const;
+
+    /**
+     * @brief 设置解码帧率档位，可在任意线程调用，下一个包起生效
+     *
+     * 从只解码关键帧恢复时，需等到下一个关键帧才重新输出画面。
+     */
+    void setDecodeRate(DecodeRate rate);
+    DecodeRate decodeRate() const;
+
+    /**
+     * @brief 按名称（full / nonref / keyframes）解析帧率档位
+     */
+    static bool decodeRateFromName(const QString &name, DecodeRate *rate);
+
+    QString url() const { return m_url; }
+
+    /**
+     * @brief 添加压缩包旁路接收端（录像等），可在任意线程调用
+     *
+     * 已在解码时立即以当前流参数调用 beginStream()。
+     */
+    void addPacketSink(std::shared_ptr<PacketSink> sink);
+
+    /**
+     * @brief 移除接收端，正在解码时先调用其 endStream()
+     */
+    void removePacketSink(const std::shared_ptr<PacketSink> &sink);
+
+    /**
+     * @brief 设置解码帧的输出信箱，需在 start() 之前调用
+     * @param mailbox 通常为 VideoWidget::frameMailbox()
+     */
+    void setFrameMailbox(std::shared_ptr<FrameMailbox> mailbox);
+
+    /**
+     * @brief 设置输入来源（默认按 url 打开），需在 start() 之前调用
+     *
+     * url 仍用作流参数缓存和日志中的标识。
      */
-    void frameReady(const QImage &frame);
+    void setInputSource(std::shared_ptr<InputSource> source);
 
+    /**
+     * @brief 设置传输方式及其参数（默认按 cfg.STREAM_TRANSPORT），需在 start() 之前调用
+     *
+     * 只对网络地址生效；Auto 时按地址前缀选择。
+     */
+    void setTransport(const StreamTransport::Settings &settings);
+    StreamTransport::Settings transport() const { return m_transport; }
+
+    /**
+     * @brief 连接结束后是否自动重连（默认开启），需在 start() 之前调用
+     *
+     * 关闭后读到流结束即退出线程，用于测试程序解码本地文件。
+     */
+    void setReconnectEnabled(bool enabled);
+
+    /**
+     * @brief 按包的时间戳节奏读取（默认关闭），需在 start() 之前调用
+     *
+     * 本地文件默认以最快速度读取，开启后模拟直播的到达节奏。
+     */
+    void setReadPacing(bool enabled);
+
+    /**
+     * @brief 设置截图器，需在 start() 之前调用
+     *
+     * 截图取自解码输出的原始帧，不受显示端缩放和追帧跳过转换的影响。
+     */
+    void setSnapshotCapture(std::shared_ptr<SnapshotCapture> capture);
+
+    /**
+     * @brief 设置按时间戳定时显示的抖动缓冲，需在 start() 之前调用
+     *
+     * 设置后转换好的帧连同 PTS 写入抖动缓冲，由显示端按刷新节奏取出后再写入信箱；
+     * 未设置时帧解码后立即写入信箱。
+     */
+    void setFramePresenter(std::shared_ptr<FramePresenter> presenter);
+
+    /**
+     * @brief 设置声卡输出，需在 start() 之前调用
+     *
+     * 设置后解码流中的第一个音频流，在独立线程中解码并重采样到声卡格式，
+     * 以抖动缓冲（若已设置）的时钟与视频同步；未设置时音频包直接丢弃。
+     */
+    void setAudioOutput(std::shared_ptr<AudioOutput> output);
+    bool hasAudio() const { return m_audio != nullptr; }
+
+    /**
+     * @brief 获取音频解码与同步统计（未设置声卡输出时为空）
+     */
+    AudioDecoder::Stats audioStats() const;
+
+signals:
     /**
      * @brief 当解码发生错误时发出信号
      * @param message 错误描述
      */
     void errorOccurred(const QString &message);
 
+    /**
+     * @brief 解码出现损坏、需要摄像头立即发送关键帧（IDR）时发出（在解码线程中发出）
+     *
+     * 同一次损坏在解码出完好的关键帧之前，按 KEYFRAME_REQUEST_INTERVAL_MS 限速重发。
+     * @param reason 损坏原因：decode error / corrupt frame / missing reference
+     */
+    void keyframeRequested(const QString &reason);
+
 protected:
+    /**
+     * @brief 解码线程：打开输入后启动读取线程，自身只做解码与颜色转换
+     */
     void run() override;
 
 private:
+    bool openSession(AVPacket *packet, qint64 startUs, AVRational *timeBase, QString *error);
+    void decodeLoop(AVPacket *packet, AVFrame *frame, const std::shared_ptr<FrameMailbox> &mailbox,
+                    AVRational timeBase, qint64 startUs);
+    void closeInput();
+    static int interruptCallback(void *opaque);
+    void setIoDeadline(int timeoutMs);
+    void countIoTimeout(std::atomic<quint64> &counter);
+    void waitBeforeReconnect();
+    void readLoop();
+    /**
+     * @brief 把音频包交给音频分支（仅限读取线程，或读取线程启动前的解码线程），第一次读到音频时确定音频流
+     */
+    void pushAudioPacket(AVPacket *packet);
+    /**
+     * @brief 把校验缓存时暂存的音频包交给已启动的音频分支
+     */
+    void flushProbeAudio();
+    void beginSinkStream(AVRational timeBase);
+    void writeSinks(const AVPacket *packet);
+    void endSinkStream();
     void cleanup();
-    bool initDecoder();
-    bool initSwsContext();
+    bool prepareDecoder(const AVCodecParameters *codecPar);
+    /**
+     * @brief 按指定配置档和线程数打开解码器，失败时释放上下文（m_codecCtx 为空）
+     */
+    bool initDecoder(const AVCodecParameters *codecPar, DecoderProfile::Profile profile, int threads);
+    /**
+     * @brief 按请求的配置档重新打开解码器；失败时恢复原配置档并记警告日志，
+     *        连原配置档也打不开时 m_codecCtx 为空并发出 errorOccurred
+     * @return 当前包能否送入新解码器（非关键帧时为 false）
+     */
+    bool switchDecoderProfile(const AVPacket *packet);
+    bool openFromProbeCache(AVPacket *firstPacket, AVRational *timeBase);
+    bool probeStream(AVRational *timeBase, QString *error);
+    void onFirstFrame(qint64 startUs, AVRational timeBase);
+    int planBands(const AVFrame *frame, const QSize &outputSize) const;
+    bool initSwsContext(const AVFrame *frame, const QSize &outputSize, int bands);
+    void freeSwsContexts();
+    void rememberPacketTiming(const AVPacket *packet, qint64 readUs, qint64 sendUs);
+    FrameTiming takePacketTiming(const AVFrame *frame);
+    bool checkIntegrity(const AVFrame *frame, qint64 nowUs);
+    void markCorrupt(qint64 nowUs, const char *reason);
+    void requestKeyframe(qint64 nowUs);
+    bool convertFrame(const AVFrame *frame, const QSize &viewport, QImage *image);
+    void updateVisibility(const std::shared_ptr<FrameMailbox> &mailbox,
+                          const std::shared_ptr<FramePresenter> &presenter, qint64 nowUs);
+    void publishHiddenFrame(const std::shared_ptr<FrameMailbox> &mailbox,
+                            const std::shared_ptr<FramePresenter> &presenter);
+
+    static quint64 packSize(const QSize &size) { return (quint64(quint32(size.width())) << 32) | quint32(size.height()); }
+    static QSize unpackSize(quint64 packed) { return QSize(int(packed >> 32), int(packed & 0xFFFFFFFFu)); }
 
     AppConfig m_config;
+    const QString m_url;                 // 流地址
     std::atomic<bool> m_running{false};  // 用于控制线程运行状态
     AVFormatContext *m_formatCtx = nullptr;
     AVCodecContext *m_codecCtx = nullptr;
-    SwsContext *m_swsCtx = nullptr;
+
+    static constexpr int kMaxBands = 16;
+    static constexpr int kProbeCachePackets = 64;   // 校验缓存时最多读取的包数
+    YuvConverter m_yuvConverter;             // 无需缩放时使用的向量化颜色转换
+    std::shared_ptr<ConvertWorkerPool> m_convertPool;  // 分段颜色转换的工作线程池
+
+    // 每个行段一个 sws 上下文，由转换线程池并行执行；缩放时各段上下文按整帧尺寸建立，
+    // 只取回本段的输出行（行段之间的插值需要相邻的输入行）。最近用过的几种配置保留在缓存中
+    SwsContextCache m_swsCache;
+    const std::vector<SwsContextCache::Band> *m_swsBands = nullptr;    // 当前配置，指向缓存中的项
+    SwsContextCache::Key m_swsKey;           // 当前配置的键
+    AVFrame *m_swsDstFrame = nullptr;        // 缩放时包装输出缓冲区，交给各段的 sws_frame_start
+    QSize m_convertInputSize;                // 上一帧的输入尺寸，用于检测分辨率变化
+    int m_convertInputFormat = AV_PIX_FMT_NONE;  // 上一帧的输入像素格式
+    QSize m_convertOutputSize;               // 上一帧的输出尺寸
+    CatchUpController m_catchUp;             // 落后于直播端时逐级减少解码工作
+
+    // 已送入解码器的包的时间戳，解码输出帧时按 PTS 取回（解码线程独占）
+    struct PacketTiming
+    {
+        int64_t pts = AV_NOPTS_VALUE;
+        qint64 readUs = 0;
+        qint64 sendUs = 0;
+    };
+    std::array<PacketTiming, 64> m_packetTimings;
+    size_t m_packetTimingIndex = 0;
+    std::shared_ptr<LatencyTracer> m_tracer;
     int m_videoStream = -1;
+    std::shared_ptr<FramePool> m_framePool;  // 输出帧缓冲池，跨线程读取时使用 atomic_load
+    std::shared_ptr<FrameMailbox> m_mailbox; // 输出帧信箱
+    std::shared_ptr<SnapshotCapture> m_snapshot;    // 截图器，可为空
+    std::shared_ptr<FramePresenter> m_presenter;    // 抖动缓冲，可为空
+    std::unique_ptr<AudioDecoder> m_audio;          // 音频解码分支，可为空
+    int m_audioStream = -1;                         // 当前连接的音频流（仅限读取线程）
+    std::vector<AVPacket *> m_probeAudio;           // 校验缓存时读到的音频包，音频分支启动后送入
+    std::shared_ptr<InputSource> m_source;  // 输入来源，跨线程读取时使用 atomic_load
+    StreamTransport::Settings m_transport;  // 传输方式，仅在 start() 之前修改
+    PacketQueue m_packetQueue;               // 读取线程 -> 解码线程
+
+    // 统计信息
+    std::atomic<quint64> m_framesDecoded{0};
+    std::atomic<quint64> m_framesConverted{0};
+    std::atomic<quint64> m_convertUsTotal{0};
+    std::atomic<qint64> m_lastConvertUs{0};
+    std::atomic<quint64> m_outputSize{0};
+    std::atomic<quint64> m_inputChanges{0};
+    std::atomic<quint64> m_reconfigurations{0};
+    std::atomic<qint64> m_lastReconfigUs{0};
+    std::atomic<qint64> m_maxReconfigUs{0};
+    std::atomic<quint64> m_simdFrames{0};
+    std::atomic<quint64> m_bandedFrames{0};
+    std::atomic<bool> m_probeCached{false};
+    std::atomic<qint64> m_openUs{0};
+    std::atomic<qint64> m_probeUs{0};
+    std::atomic<qint64> m_firstFrameUs{0};
+    std::atomic<quint64> m_reconnects{0};
+    std::atomic<quint64> m_reconnectAttempts{0};
+    std::atomic<quint64> m_decoderReuses{0};
+    std::atomic<qint64> m_lastReconnectUs{0};
+    std::atomic<quint64> m_reconnectUsTotal{0};
+
+    std::atomic<int> m_activeProfileStat{DecoderProfile::LowLatency};
+    std::atomic<int> m_decoderThreads{0};
+    std::atomic<const char *> m_activeThreadType{""};
+    std::atomic<quint64> m_profileSwitches{0};
+    std::atomic<quint64> m_rateSkippedPackets{0};
+    std::atomic<quint64> m_ioOpenTimeouts{0};
+    std::atomic<quint64> m_ioProbeTimeouts{0};
+    std::atomic<quint64> m_readStalls{0};
+    std::atomic<qint64> m_lastStopUs{0};
+    std::atomic<quint64> m_packetsRead{0};
+    std::atomic<quint64> m_readFrameUsTotal{0};     // av_read_frame 累计耗时
+    std::atomic<int> m_transportStat{StreamTransport::Auto};
+    std::atomic<quint64> m_decodeErrors{0};
+    std::atomic<quint64> m_corruptFrames{0};
+    std::atomic<quint64> m_corruptionEvents{0};
+    std::atomic<quint64> m_keyframeRequests{0};
+    std::atomic<quint64> m_frozenFrames{0};
+    std::atomic<quint64> m_recoveries{0};
+    std::atomic<qint64> m_lastRecoveryUs{0};
+    std::atomic<quint64> m_recoveryUsTotal{0};
+    std::atomic<qint64> m_maxRecoveryUs{0};
+
+    // 当前 I/O 操作的截止时间（单调时钟微秒，0 表示不限），由中断回调检查
+    std::atomic<qint64> m_ioDeadlineUs{0};
+    std::atomic<bool> m_ioTimedOut{false};
+
+    // 重连状态（解码线程独占）
+    int m_reconnectAttempt = 0;         // 连续失败次数，决定退避时长
+    qint64 m_reconnectLostUs = 0;       // 连接断开的时刻，0 表示未处于重连中
+    bool m_decoderReused = false;       // 本次连接是否沿用了原解码器
+
+    std::atomic<int> m_requestedProfile{DecoderProfile::LowLatency};   // 请求的配置档（任意线程写）
+    DecoderProfile::Profile m_activeProfile = DecoderProfile::LowLatency; // 当前解码器使用的配置档
+    std::atomic<int> m_requestedThreads{0};     // 请求的解码线程数，0 表示按配置
+    int m_activeThreadSetting = 0;              // 当前解码器按哪个线程数设置打开
+    std::atomic<int> m_decodeRate{RateFull};
+    bool m_rateNeedsKeyframe = false;           // 刚从只解码关键帧恢复，等待关键帧
+    // 解码损坏状态（解码线程独占）：丢包后直到解码出完好的关键帧之前画面都不可信
+    qint64 m_corruptSinceUs = 0;                // 发现损坏的时刻，0 表示画面完好
+    qint64 m_keyframeRequestUs = 0;             // 上次请求关键帧的时刻
+    const char *m_corruptReason = "";
+    // 显示端可见状态（解码线程独占），各状态的时长和 CPU 时间写入统计
+    enum Visibility
+    {
+        VisibilityVisible,      // 正常解码、转换、显示
+        VisibilityHidden,       // 只解码，不转换，恢复可见时立即显示最后一帧
+        VisibilityIdle,         // 不可见超过 LAZY_IDLE_SECONDS：只解码关键帧
+        VisibilityCount
+    };
+    Visibility m_visibility = VisibilityVisible;
+    qint64 m_hiddenSinceUs = 0;
+    qint64 m_stateSinceUs = 0;          // 本状态统计的起点（单调时钟）
+    qint64 m_stateCpuSinceUs = 0;       // 本状态统计的起点（线程 CPU 时间）
+    AVFrame *m_hiddenFrame = nullptr;   // 不可见期间最后解码的帧（仅增加引用）
+    std::atomic<int> m_visibilityStat{VisibilityVisible};
+    std::array<std::atomic<qint64>, VisibilityCount> m_stateWallUs{};
+    std::array<std::atomic<qint64>, VisibilityCount> m_stateCpuUs{};
+    std::atomic<quint64> m_hiddenConversionsSkipped{0};
+    std::atomic<quint64> m_idlePacketsSkipped{0};
+
+    std::atomic<bool> m_reconnectEnabled{true};
+    std::atomic<bool> m_readPacing{false};
+
+    // 压缩包旁路接收端，读取线程调用，增删可在任意线程
+    QMutex m_sinkMutex;
+    std::vector<std::shared_ptr<PacketSink>> m_sinks;
+    AVCodecParameters *m_sinkPar = nullptr;     // 当前连接的流参数，未连接时为空
+    AVRational m_sinkTimeBase{1, 1000};
 
     // 暂停/唤醒功能预留
     std::atomic<bool> m_paused{false};
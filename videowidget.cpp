@@ -1,40 +1,268 @@
 #include "videowidget.h"
 #include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QScreen>
+#include <QTimer>
 
-VideoWidget::VideoWidget(QWidget *parent): QWidget(parent)
+VideoWidget::VideoWidget(QWidget *parent): QWidget(parent),
+    m_mailbox(std::make_shared<FrameMailbox>())
 {
     setAttribute(Qt::WA_OpaquePaintEvent);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    // 新帧到达时投递一次重绘请求；信箱保证两次绘制之间最多投递一次。
+    // 回调在解码线程中执行，析构时在信箱锁内清除，之后不会再访问本控件
+    m_mailbox->setNotifier([this]()
+                           { QMetaObject::invokeMethod(this, "onFrameAvailable", Qt::QueuedConnection); });
+}
+
+VideoWidget::~VideoWidget()
+{
+    // 解码器可能比控件活得久，仍在向信箱写入
+    m_mailbox->setNotifier({});
+}
+
+void VideoWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    // 以设备像素告知解码器目标尺寸，下一帧起按新尺寸转换
+    m_mailbox->setTargetSize(size() * devicePixelRatioF());
+    m_cacheDirty = true;
 }
 
 void VideoWidget::setFrame(const QImage &frame)
 {
     if (!frame.isNull())
     {
-        QMutexLocker locker(&m_mutex);
-        m_currentFrame = frame;
-        m_videoSize = frame.size();
+        m_mailbox->publish(frame);
+    }
+}
+
+void VideoWidget::onFrameAvailable()
+{
+    // 视频区域不变时只重绘视频区域，黑边无需重画
+    if (m_cacheDirty || m_videoRect.isEmpty())
+    {
         update();
     }
+    else if (m_overlayEnabled && m_tracer)
+    {
+        // 叠加层随新帧刷新，与视频区域一起加入本次重绘区域
+        update(QRegion(m_videoRect) + overlayRect());
+    }
+    else
+    {
+        update(m_videoRect);
+    }
 }
 
-void VideoWidget::paintEvent(QPaintEvent *event)
+VideoWidget::PaintStats VideoWidget::paintStats() const
 {
-    Q_UNUSED(event);
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    return m_paintStats;
+}
 
-    if (!m_currentFrame.isNull())
+void VideoWidget::setLatencyTracer(const std::shared_ptr<LatencyTracer> &tracer)
+{
+    m_tracer = tracer;
+}
+
+void VideoWidget::setFramePresenter(const std::shared_ptr<FramePresenter> &presenter)
+{
+    m_presenter = presenter;
+    if (!m_presenter)
+    {
+        delete m_presentTimer;
+        m_presentTimer = nullptr;
+        return;
+    }
+    if (!m_presentTimer)
+    {
+        m_presentTimer = new QTimer(this);
+        m_presentTimer->setTimerType(Qt::PreciseTimer);
+        connect(m_presentTimer, &QTimer::timeout, this, &VideoWidget::onPresentTick);
+    }
+    // 以屏幕刷新间隔取帧，帧的显示时刻对齐到刷新节奏而不是解码节奏
+    const QScreen *display = screen();
+    const qreal refreshRate = display && display->refreshRate() > 1 ? display->refreshRate() : 60.0;
+    m_presentTimer->start(qMax(1, qRound(1000.0 / refreshRate)));
+}
+
+void VideoWidget::onPresentTick()
+{
+    // 不可见时解码端不再写入新帧，恢复可见后由解码端补上最后一帧
+    if (!m_mailbox->isVisible())
+    {
+        return;
+    }
+    QImage image;
+    FrameTiming timing;
+    if (m_presenter->take(LatencyTracer::nowUs(), &image, &timing))
+    {
+        timing.handoffUs = m_mailbox->publish(image, timing);
+        if (m_tracer)
+        {
+            m_tracer->record(LatencyTracer::StageHandoff, timing.convertedUs, timing.handoffUs);
+        }
+    }
+}
+
+void VideoWidget::setOverlayEnabled(bool enabled)
+{
+    if (m_overlayEnabled != enabled)
     {
-        QMutexLocker locker(&m_mutex);
-        QSize widgetSize = size();
-        QSize scaledSize = m_videoSize.scaled(widgetSize, Qt::KeepAspectRatio);
-        QRect drawRect(QPoint(0, 0), scaledSize);
-        drawRect.moveCenter(rect().center());
-        painter.drawPixmap(drawRect, QPixmap::fromImage(m_currentFrame));
+        m_overlayEnabled = enabled;
+        update();
+    }
+}
+
+void VideoWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    setOverlayEnabled(!m_overlayEnabled);
+    event->accept();
+}
+
+QRect VideoWidget::overlayRect() const
+{
+    const QFontMetrics metrics(font());
+    const int lineHeight = metrics.height();
+    const QRect area = m_videoRect.isEmpty() ? rect() : m_videoRect;
+    return QRect(area.topLeft() + QPoint(8, 8),
+                 QSize(metrics.horizontalAdvance(QStringLiteral("display  000.0 / 000.0 ms")) + 12,
+                       lineHeight * (LatencyTracer::StageCount + 2) + 8));
+}
+
+void VideoWidget::drawOverlay(QPainter &painter)
+{
+    const QRect box = overlayRect();
+    painter.fillRect(box, QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+
+    const int lineHeight = painter.fontMetrics().height();
+    int y = box.top() + 4 + painter.fontMetrics().ascent();
+    const int x = box.left() + 6;
+    painter.drawText(x, y, QStringLiteral("%1 fps  last / p95").arg(m_fps, 0, 'f', 1));
+    y += lineHeight;
+    for (int i = 0; i < LatencyTracer::StageCount; i++)
+    {
+        const LatencyTracer::Stage stage = static_cast<LatencyTracer::Stage>(i);
+        const LatencyTracer::Summary summary = m_tracer->summary(stage);
+        painter.drawText(x, y, QStringLiteral("%1 %2 / %3 ms")
+                                   .arg(QString::fromLatin1(LatencyTracer::stageName(stage)), -8)
+                                   .arg(summary.last, 5, 'f', 1)
+                                   .arg(summary.p95, 5, 'f', 1));
+        y += lineHeight;
+    }
+    painter.drawText(x, y, QStringLiteral("paint    %1 / %2 ms")
+                               .arg(m_paintStats.lastPaintMs, 5, 'f', 1)
+                               .arg(m_paintStats.maxPaintMs, 5, 'f', 1));
+}
+
+bool VideoWidget::updateCache(const QImage &frame)
+{
+    m_videoSize = frame.size();
+
+    const qreal dpr = devicePixelRatioF();
+    QSize scaledSize = (QSizeF(m_videoSize) / dpr).toSize().scaled(size(), Qt::KeepAspectRatio);
+    QRect drawRect(QPoint(0, 0), scaledSize);
+    drawRect.moveCenter(rect().center());
+    const bool geometryChanged = drawRect != m_videoRect;
+    m_videoRect = drawRect;
+
+    // 解码器通常已输出与显示区域等大的 RGB32 帧，直接引用即可；
+    // 仅在尺寸或格式不符时（如缩放窗口后的过渡帧）生成一次缓存，之后的重绘都是直接拷贝
+    const QSize devicePixels = m_videoRect.size() * dpr;
+    const bool nativeFormat = frame.format() == QImage::Format_RGB32 ||
+                              frame.format() == QImage::Format_ARGB32_Premultiplied;
+    if (frame.size() == devicePixels && nativeFormat)
+    {
+        m_cachedFrame = frame;
     }
     else
+    {
+        QImage converted = nativeFormat ? frame : frame.convertToFormat(QImage::Format_RGB32);
+        m_cachedFrame = converted.scaled(devicePixels, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        m_paintStats.cacheRebuilds++;
+    }
+    m_cachedDpr = dpr;
+    m_cacheDirty = false;
+    return geometryChanged;
+}
+
+void VideoWidget::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool newFrame = m_mailbox->hasNewFrame();
+    const QImage &frame = m_mailbox->latest();
+    if (!frame.isNull() && (newFrame || m_cacheDirty) && updateCache(frame) &&
+        !QRegion(rect()).subtracted(event->region()).isEmpty())
+    {
+        // 视频区域变化（如分辨率改变）时黑边位置也变了，补一次整体重绘
+        update();
+    }
+
+    QPainter painter(this);
+    const QRegion dirty = event->region();
+    if (m_cachedFrame.isNull())
     {
         painter.fillRect(rect(), Qt::black);
     }
+    else
+    {
+        // 只绘制失效区域内的黑边和视频部分
+        const QRegion bars = dirty.subtracted(m_videoRect);
+        for (const QRect &bar : bars)
+        {
+            painter.fillRect(bar, Qt::black);
+        }
+        const QRect videoDirty = dirty.boundingRect() & m_videoRect;
+        if (!videoDirty.isEmpty())
+        {
+            const QRectF source(QPointF(videoDirty.topLeft() - m_videoRect.topLeft()) * m_cachedDpr,
+                                QSizeF(videoDirty.size()) * m_cachedDpr);
+            painter.drawImage(videoDirty, m_cachedFrame, source);
+        }
+    }
+    if (m_overlayEnabled && m_tracer)
+    {
+        drawOverlay(painter);
+    }
+
+    const double elapsedMs = timer.nsecsElapsed() / 1e6;
+    m_paintStats.paints++;
+    m_paintStats.lastPaintMs = elapsedMs;
+    if (newFrame)
+    {
+        if (m_tracer)
+        {
+            // 绘制命令已提交即视为显示完成，合成器额外的延迟不计入
+            FrameTiming timing = m_mailbox->latestTiming();
+            timing.paintedUs = LatencyTracer::nowUs();
+            m_tracer->recordDisplayStages(timing);
+
+            m_fpsWindowFrames++;
+            if (!m_fpsWindowStartUs)
+            {
+                m_fpsWindowStartUs = timing.paintedUs;
+                m_fpsWindowFrames = 0;
+            }
+            else if (timing.paintedUs - m_fpsWindowStartUs >= 1000000)
+            {
+                m_fps = m_fpsWindowFrames * 1e6 / (timing.paintedUs - m_fpsWindowStartUs);
+                m_fpsWindowStartUs = timing.paintedUs;
+                m_fpsWindowFrames = 0;
+            }
+        }
+        m_paintStats.framePaints++;
+        m_framePaintMsTotal += elapsedMs;
+        m_paintStats.avgPaintMs = m_framePaintMsTotal / m_paintStats.framePaints;
+        if (elapsedMs > m_paintStats.maxPaintMs)
+        {
+            m_paintStats.maxPaintMs = elapsedMs;
+        }
+    }
 }
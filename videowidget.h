@@ -3,26 +3,102 @@
 
 #include <QWidget>
 #include <QImage>
-#include <QMutex>
+#include <memory>
+#include "frame_mailbox.h"
+#include "latency_tracer.h"
+#include "frame_presenter.h"
+
+class QTimer;
 
 /**
  * @brief 用于显示视频帧
+ *
+ * 帧通过 FrameMailbox 交接：解码线程直接写入信箱，
+ * paintEvent 只取最新的一帧，界面线程繁忙时旧帧被覆盖而不是排队。
+ * 控件尺寸变化时通知解码器，解码器直接输出与屏幕尺寸一致的帧。
+ * 设置 LatencyTracer 后记录每帧的显示阶段延迟，双击可切换延迟叠加显示。
+ * 设置 FramePresenter 后按屏幕刷新间隔从抖动缓冲取出到期的帧再写入信箱。
  */
 class VideoWidget : public QWidget
 {
     Q_OBJECT
 public:
+    /**
+     * @brief 绘制耗时统计
+     */
+    struct PaintStats
+    {
+        quint64 paints = 0;         // paintEvent 总次数
+        quint64 framePaints = 0;    // 因新帧到达而重绘的次数
+        quint64 cacheRebuilds = 0;  // 重新生成缓存图像的次数（尺寸或格式不匹配）
+        double avgPaintMs = 0;      // 新帧重绘的平均耗时
+        double lastPaintMs = 0;     // 最近一次重绘耗时
+        double maxPaintMs = 0;      // 新帧重绘的最大耗时
+    };
+
     explicit VideoWidget(QWidget *parent = nullptr);
+    ~VideoWidget() override;
+
+    /**
+     * @brief 写入一帧（可在任意单一线程调用，重绘请求会自动合并）
+     */
     void setFrame(const QImage &frame);
     QSize videoSize() const { return m_videoSize; }
 
+    /**
+     * @brief 供解码器直接写入帧的信箱
+     */
+    std::shared_ptr<FrameMailbox> frameMailbox() const { return m_mailbox; }
+
+    PaintStats paintStats() const;
+
+    /**
+     * @brief 设置延迟统计对象，绘制新帧时记录显示阶段和端到端延迟
+     */
+    void setLatencyTracer(const std::shared_ptr<LatencyTracer> &tracer);
+
+    /**
+     * @brief 设置抖动缓冲，按屏幕刷新间隔取出到期的帧显示；传入空指针恢复解码即显示
+     */
+    void setFramePresenter(const std::shared_ptr<FramePresenter> &presenter);
+
+    /**
+     * @brief 在画面左上角叠加显示各阶段延迟和帧率
+     */
+    void setOverlayEnabled(bool enabled);
+    bool overlayEnabled() const { return m_overlayEnabled; }
+
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private slots:
+    void onFrameAvailable();
+    void onPresentTick();
 
 private:
-    QImage m_currentFrame; // 当前视频帧
-    QSize m_videoSize;     // 视频原始尺寸
-    QMutex m_mutex;        // 互斥锁用于线程安全
+    bool updateCache(const QImage &frame);
+    void drawOverlay(QPainter &painter);
+    QRect overlayRect() const;
+
+    std::shared_ptr<FrameMailbox> m_mailbox;    // 解码线程 -> 界面线程的帧信箱
+    QSize m_videoSize;                          // 视频原始尺寸
+    QImage m_cachedFrame;                       // 已按显示区域缩放、格式可直接绘制的当前帧
+    qreal m_cachedDpr = 1.0;                    // 缓存图像对应的设备像素比（不写入共享的帧，避免触发深拷贝）
+    QRect m_videoRect;                          // 视频区域（控件坐标），其余部分为黑边
+    bool m_cacheDirty = true;                   // 控件尺寸变化后需要重建缓存
+
+    PaintStats m_paintStats;
+    double m_framePaintMsTotal = 0;
+
+    std::shared_ptr<LatencyTracer> m_tracer;
+    std::shared_ptr<FramePresenter> m_presenter;    // 抖动缓冲，可为空
+    QTimer *m_presentTimer = nullptr;               // 按屏幕刷新间隔触发的取帧定时器
+    bool m_overlayEnabled = false;
+    qint64 m_fpsWindowStartUs = 0;              // 帧率统计窗口起点
+    int m_fpsWindowFrames = 0;
+    double m_fps = 0;
 };
 
 #endif // VIDEOWIDGET_H
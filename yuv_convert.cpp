@@ -0,0 +1,482 @@
+#include "yuv_convert.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YUV_HAVE_X86 1
+#endif
+
+#if (defined(__aarch64__) || defined(__ARM_NEON)) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define YUV_HAVE_NEON 1
+#endif
+
+namespace
+{
+
+typedef YuvConverter::Coefficients Coefficients;
+
+// 所有内核共用的定点精度与舍入常数
+const int kShift = 13;
+const int kRound = 1 << (kShift - 1);
+
+// 有限范围 / 全范围 × BT.601 / BT.709，系数为 Q13
+const Coefficients kBt601Limited = {16, 9539, 13075, 3209, 6660, 16525};
+const Coefficients kBt601Full = {0, 8192, 11485, 2819, 5850, 14516};
+const Coefficients kBt709Limited = {16, 9539, 14686, 1747, 4366, 17305};
+const Coefficients kBt709Full = {0, 8192, 12901, 1535, 3835, 15201};
+
+// AV_PIX_FMT_RGB32 的字节顺序：小端为 B G R A，大端为 A R G B
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+const int kB = 0, kG = 1, kR = 2, kA = 3;
+#else
+const int kB = 3, kG = 2, kR = 1, kA = 0;
+#endif
+
+typedef void (*RowFunc)(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                        uint8_t *dst, int width, const Coefficients &c);
+
+// 打包两个 int16 系数供 madd 使用：低 16 位乘以偶数元素，高 16 位乘以奇数元素
+inline int packPair(int lo, int hi)
+{
+    return static_cast<int>((static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16) |
+                            static_cast<uint16_t>(lo));
+}
+
+inline uint8_t clampByte(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void storePixel(int y, int u, int v, const Coefficients &c, uint8_t *dst)
+{
+    const int yy = (y - c.yOffset) * c.cy + kRound;
+    dst[kB] = clampByte((yy + c.cbu * u) >> kShift);
+    dst[kG] = clampByte((yy - c.cgu * u - c.cgv * v) >> kShift);
+    dst[kR] = clampByte((yy + c.crv * v) >> kShift);
+    dst[kA] = 255;
+}
+
+void rowI420Scalar(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                   uint8_t *dst, int width, const Coefficients &c)
+{
+    for (int x = 0; x < width; x++)
+    {
+        storePixel(y[x], u[x >> 1] - 128, v[x >> 1] - 128, c, dst + x * 4);
+    }
+}
+
+void rowNv12Scalar(const uint8_t *y, const uint8_t *uv, const uint8_t *,
+                   uint8_t *dst, int width, const Coefficients &c)
+{
+    for (int x = 0; x < width; x++)
+    {
+        const uint8_t *chroma = uv + (x >> 1) * 2;
+        storePixel(y[x], chroma[0] - 128, chroma[1] - 128, c, dst + x * 4);
+    }
+}
+
+#ifdef YUV_HAVE_X86
+
+// 8 个像素的一个通道：a*ca + b*cb + round，再右移并饱和到 int16
+inline __m128i channelSse2(__m128i a, __m128i b, __m128i coef, __m128i round)
+{
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), coef), round);
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), coef), round);
+    return _mm_packs_epi32(_mm_srai_epi32(lo, kShift), _mm_srai_epi32(hi, kShift));
+}
+
+// 把 16 个像素的 B/G/R（各两组 8 个 int16）交织为 RGB32 写出
+inline void storeSse2(__m128i b0, __m128i b1, __m128i g0, __m128i g1,
+                      __m128i r0, __m128i r1, uint8_t *dst)
+{
+    const __m128i b = _mm_packus_epi16(b0, b1);
+    const __m128i g = _mm_packus_epi16(g0, g1);
+    const __m128i r = _mm_packus_epi16(r0, r1);
+    const __m128i a = _mm_set1_epi8(static_cast<char>(0xFF));
+    const __m128i bgLo = _mm_unpacklo_epi8(b, g);
+    const __m128i bgHi = _mm_unpackhi_epi8(b, g);
+    const __m128i raLo = _mm_unpacklo_epi8(r, a);
+    const __m128i raHi = _mm_unpackhi_epi8(r, a);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(bgLo, raLo));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(bgLo, raLo));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 32), _mm_unpacklo_epi16(bgHi, raHi));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 48), _mm_unpackhi_epi16(bgHi, raHi));
+}
+
+// 16 个像素：ys/u/v 为已去偏移的 int16，各分两组 8 个
+inline void convert16Sse2(__m128i y0, __m128i y1, __m128i u0, __m128i u1,
+                          __m128i v0, __m128i v1, const Coefficients &c, uint8_t *dst)
+{
+    const __m128i round = _mm_set1_epi32(kRound);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i coefR = _mm_set1_epi32(packPair(c.cy, c.crv));
+    const __m128i coefB = _mm_set1_epi32(packPair(c.cy, c.cbu));
+    const __m128i coefG1 = _mm_set1_epi32(packPair(c.cy, -c.cgu));
+    const __m128i coefG2 = _mm_set1_epi32(packPair(-c.cgv, kRound));
+
+    const __m128i r0 = channelSse2(y0, v0, coefR, round);
+    const __m128i r1 = channelSse2(y1, v1, coefR, round);
+    const __m128i b0 = channelSse2(y0, u0, coefB, round);
+    const __m128i b1 = channelSse2(y1, u1, coefB, round);
+    // G 有三项：y*cy - u*cgu 与 -v*cgv + 1*round 分两次 madd 后相加
+    __m128i g0lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y0, u0), coefG1),
+                                 _mm_madd_epi16(_mm_unpacklo_epi16(v0, ones), coefG2));
+    __m128i g0hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y0, u0), coefG1),
+                                 _mm_madd_epi16(_mm_unpackhi_epi16(v0, ones), coefG2));
+    __m128i g1lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(y1, u1), coefG1),
+                                 _mm_madd_epi16(_mm_unpacklo_epi16(v1, ones), coefG2));
+    __m128i g1hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(y1, u1), coefG1),
+                                 _mm_madd_epi16(_mm_unpackhi_epi16(v1, ones), coefG2));
+    const __m128i g0 = _mm_packs_epi32(_mm_srai_epi32(g0lo, kShift), _mm_srai_epi32(g0hi, kShift));
+    const __m128i g1 = _mm_packs_epi32(_mm_srai_epi32(g1lo, kShift), _mm_srai_epi32(g1hi, kShift));
+
+    storeSse2(b0, b1, g0, g1, r0, r1, dst);
+}
+
+inline void loadLumaSse2(const uint8_t *y, const Coefficients &c, __m128i *y0, __m128i *y1)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset = _mm_set1_epi16(static_cast<short>(c.yOffset));
+    const __m128i yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y));
+    *y0 = _mm_sub_epi16(_mm_unpacklo_epi8(yy, zero), offset);
+    *y1 = _mm_sub_epi16(_mm_unpackhi_epi8(yy, zero), offset);
+}
+
+// 8 个色度样本水平复制为 16 个像素使用的两组 int16
+inline void expandChromaSse2(__m128i chroma16, __m128i *c0, __m128i *c1)
+{
+    const __m128i bias = _mm_set1_epi16(128);
+    *c0 = _mm_sub_epi16(_mm_unpacklo_epi16(chroma16, chroma16), bias);
+    *c1 = _mm_sub_epi16(_mm_unpackhi_epi16(chroma16, chroma16), bias);
+}
+
+int rowI420Sse2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                uint8_t *dst, int width, const Coefficients &c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i y0, y1, u0, u1, v0, v1;
+        loadLumaSse2(y + x, c, &y0, &y1);
+        const __m128i uu = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2)), zero);
+        const __m128i vv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2)), zero);
+        expandChromaSse2(uu, &u0, &u1);
+        expandChromaSse2(vv, &v0, &v1);
+        convert16Sse2(y0, y1, u0, u1, v0, v1, c, dst + x * 4);
+    }
+    return x;
+}
+
+int rowNv12Sse2(const uint8_t *y, const uint8_t *uv, const uint8_t *,
+                uint8_t *dst, int width, const Coefficients &c)
+{
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i y0, y1, u0, u1, v0, v1;
+        loadLumaSse2(y + x, c, &y0, &y1);
+        const __m128i interleaved = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x));
+        expandChromaSse2(_mm_and_si128(interleaved, lowByte), &u0, &u1);
+        expandChromaSse2(_mm_srli_epi16(interleaved, 8), &v0, &v1);
+        convert16Sse2(y0, y1, u0, u1, v0, v1, c, dst + x * 4);
+    }
+    return x;
+}
+
+// AVX2 一次计算 16 个像素；unpack/pack 都在 128 位通道内进行且互为逆操作，结果保持原顺序
+__attribute__((target("avx2"))) inline __m256i channelAvx2(__m256i a, __m256i b, __m256i coef, __m256i round)
+{
+    __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), coef), round);
+    __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), coef), round);
+    return _mm256_packs_epi32(_mm256_srai_epi32(lo, kShift), _mm256_srai_epi32(hi, kShift));
+}
+
+__attribute__((target("avx2"))) inline void convert16Avx2(__m256i ys, __m256i u, __m256i v,
+                                                         const Coefficients &c, uint8_t *dst)
+{
+    const __m256i round = _mm256_set1_epi32(kRound);
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i coefR = _mm256_set1_epi32(packPair(c.cy, c.crv));
+    const __m256i coefB = _mm256_set1_epi32(packPair(c.cy, c.cbu));
+    const __m256i coefG1 = _mm256_set1_epi32(packPair(c.cy, -c.cgu));
+    const __m256i coefG2 = _mm256_set1_epi32(packPair(-c.cgv, kRound));
+
+    const __m256i r = channelAvx2(ys, v, coefR, round);
+    const __m256i b = channelAvx2(ys, u, coefB, round);
+    // G 有三项，与 SSE2 路径相同分两次 madd 后相加
+    __m256i glo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(ys, u), coefG1),
+                                   _mm256_madd_epi16(_mm256_unpacklo_epi16(v, ones), coefG2));
+    __m256i ghi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(ys, u), coefG1),
+                                   _mm256_madd_epi16(_mm256_unpackhi_epi16(v, ones), coefG2));
+    const __m256i g = _mm256_packs_epi32(_mm256_srai_epi32(glo, kShift), _mm256_srai_epi32(ghi, kShift));
+
+    storeSse2(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1),
+              _mm256_castsi256_si128(g), _mm256_extracti128_si256(g, 1),
+              _mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1), dst);
+}
+
+__attribute__((target("avx2"))) inline __m256i loadLumaAvx2(const uint8_t *y, const Coefficients &c)
+{
+    const __m256i yy = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y)));
+    return _mm256_sub_epi16(yy, _mm256_set1_epi16(static_cast<short>(c.yOffset)));
+}
+
+__attribute__((target("avx2"))) int rowI420Avx2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                                uint8_t *dst, int width, const Coefficients &c)
+{
+    const __m256i bias = _mm256_set1_epi16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m256i ys = loadLumaAvx2(y + x, c);
+        const __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2));
+        const __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2));
+        const __m256i uu = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)), bias);
+        const __m256i vv = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)), bias);
+        convert16Avx2(ys, uu, vv, c, dst + x * 4);
+    }
+    return x;
+}
+
+__attribute__((target("avx2"))) int rowNv12Avx2(const uint8_t *y, const uint8_t *uv, const uint8_t *,
+                                                uint8_t *dst, int width, const Coefficients &c)
+{
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    const __m256i bias = _mm256_set1_epi16(128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m256i ys = loadLumaAvx2(y + x, c);
+        const __m128i interleaved = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x));
+        const __m128i u16 = _mm_and_si128(interleaved, lowByte);
+        const __m128i v16 = _mm_srli_epi16(interleaved, 8);
+        const __m256i uu = _mm256_sub_epi16(_mm256_set_m128i(_mm_unpackhi_epi16(u16, u16),
+                                                             _mm_unpacklo_epi16(u16, u16)), bias);
+        const __m256i vv = _mm256_sub_epi16(_mm256_set_m128i(_mm_unpackhi_epi16(v16, v16),
+                                                             _mm_unpacklo_epi16(v16, v16)), bias);
+        convert16Avx2(ys, uu, vv, c, dst + x * 4);
+    }
+    return x;
+}
+
+#endif // YUV_HAVE_X86
+
+#ifdef YUV_HAVE_NEON
+
+inline int16x8_t channelNeon(int16x8_t y, int16x8_t a, int16_t cy, int16_t ca)
+{
+    int32x4_t lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(y), cy), vget_low_s16(a), ca);
+    int32x4_t hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(y), cy), vget_high_s16(a), ca);
+    // vqrshrn 带舍入右移并饱和，与标量的 (x + round) >> 13 再截断一致
+    return vcombine_s16(vqrshrn_n_s32(lo, kShift), vqrshrn_n_s32(hi, kShift));
+}
+
+inline int16x8_t greenNeon(int16x8_t y, int16x8_t u, int16x8_t v, const Coefficients &c)
+{
+    int32x4_t lo = vmull_n_s16(vget_low_s16(y), static_cast<int16_t>(c.cy));
+    lo = vmlsl_n_s16(lo, vget_low_s16(u), static_cast<int16_t>(c.cgu));
+    lo = vmlsl_n_s16(lo, vget_low_s16(v), static_cast<int16_t>(c.cgv));
+    int32x4_t hi = vmull_n_s16(vget_high_s16(y), static_cast<int16_t>(c.cy));
+    hi = vmlsl_n_s16(hi, vget_high_s16(u), static_cast<int16_t>(c.cgu));
+    hi = vmlsl_n_s16(hi, vget_high_s16(v), static_cast<int16_t>(c.cgv));
+    return vcombine_s16(vqrshrn_n_s32(lo, kShift), vqrshrn_n_s32(hi, kShift));
+}
+
+inline int16x8_t widenNeon(uint8x8_t value, int16_t offset)
+{
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(value)), vdupq_n_s16(offset));
+}
+
+// 16 个像素：u8/v8 为 8 个色度样本，水平复制后使用
+inline void convert16Neon(const uint8_t *y, uint8x8_t u8, uint8x8_t v8,
+                          const Coefficients &c, uint8_t *dst)
+{
+    const uint8x16_t yy = vld1q_u8(y);
+    const int16_t yOffset = static_cast<int16_t>(c.yOffset);
+    const uint8x8x2_t uDup = vzip_u8(u8, u8);
+    const uint8x8x2_t vDup = vzip_u8(v8, v8);
+
+    uint8x8_t b[2], g[2], r[2];
+    for (int half = 0; half < 2; half++)
+    {
+        const int16x8_t ys = widenNeon(half ? vget_high_u8(yy) : vget_low_u8(yy), yOffset);
+        const int16x8_t us = widenNeon(uDup.val[half], 128);
+        const int16x8_t vs = widenNeon(vDup.val[half], 128);
+        r[half] = vqmovun_s16(channelNeon(ys, vs, static_cast<int16_t>(c.cy), static_cast<int16_t>(c.crv)));
+        b[half] = vqmovun_s16(channelNeon(ys, us, static_cast<int16_t>(c.cy), static_cast<int16_t>(c.cbu)));
+        g[half] = vqmovun_s16(greenNeon(ys, us, vs, c));
+    }
+
+    uint8x16x4_t pixels;
+    pixels.val[kB] = vcombine_u8(b[0], b[1]);
+    pixels.val[kG] = vcombine_u8(g[0], g[1]);
+    pixels.val[kR] = vcombine_u8(r[0], r[1]);
+    pixels.val[kA] = vdupq_n_u8(255);
+    vst4q_u8(dst, pixels);
+}
+
+int rowI420Neon(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                uint8_t *dst, int width, const Coefficients &c)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        convert16Neon(y + x, vld1_u8(u + x / 2), vld1_u8(v + x / 2), c, dst + x * 4);
+    }
+    return x;
+}
+
+int rowNv12Neon(const uint8_t *y, const uint8_t *uv, const uint8_t *,
+                uint8_t *dst, int width, const Coefficients &c)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8x8x2_t chroma = vld2_u8(uv + x);
+        convert16Neon(y + x, chroma.val[0], chroma.val[1], c, dst + x * 4);
+    }
+    return x;
+}
+
+#endif // YUV_HAVE_NEON
+
+// 向量内核处理 16 像素对齐的部分并返回已处理的像素数，剩余部分由标量补齐
+typedef int (*VectorRowFunc)(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                             uint8_t *dst, int width, const Coefficients &c);
+
+} // namespace
+
+YuvConverter::YuvConverter()
+    : m_kernel(bestKernel())
+{
+}
+
+bool YuvConverter::supports(const AVFrame *frame)
+{
+    switch (frame->format)
+    {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+        return frame->width > 0 && frame->height > 0;
+    default:
+        return false;
+    }
+}
+
+bool YuvConverter::kernelAvailable(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case KernelScalar:
+        return true;
+#ifdef YUV_HAVE_X86
+    case KernelSse2:
+        return __builtin_cpu_supports("sse2");
+    case KernelAvx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef YUV_HAVE_NEON
+    case KernelNeon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+YuvConverter::Kernel YuvConverter::bestKernel()
+{
+    if (kernelAvailable(KernelNeon))
+        return KernelNeon;
+    if (kernelAvailable(KernelAvx2))
+        return KernelAvx2;
+    if (kernelAvailable(KernelSse2))
+        return KernelSse2;
+    return KernelScalar;
+}
+
+const char *YuvConverter::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case KernelScalar:
+        return "scalar";
+    case KernelSse2:
+        return "sse2";
+    case KernelAvx2:
+        return "avx2";
+    case KernelNeon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+bool YuvConverter::setKernel(Kernel kernel)
+{
+    if (!kernelAvailable(kernel))
+    {
+        return false;
+    }
+    m_kernel = kernel;
+    return true;
+}
+
+YuvConverter::Coefficients YuvConverter::coefficientsFor(const AVFrame *frame)
+{
+    const bool fullRange = frame->color_range == AVCOL_RANGE_JPEG ||
+                           frame->format == AV_PIX_FMT_YUVJ420P;
+    // 未标注色彩空间时与 sws_scale 默认行为一致，按 BT.601 处理
+    if (frame->colorspace == AVCOL_SPC_BT709)
+    {
+        return fullRange ? kBt709Full : kBt709Limited;
+    }
+    return fullRange ? kBt601Full : kBt601Limited;
+}
+
+void YuvConverter::convert(const AVFrame *frame, uint8_t *dst, int dstStride, int rowBegin, int rowEnd) const
+{
+    const bool nv12 = frame->format == AV_PIX_FMT_NV12;
+    const Coefficients c = coefficientsFor(frame);
+    RowFunc scalarRow = nv12 ? rowNv12Scalar : rowI420Scalar;
+
+    VectorRowFunc vectorRow = nullptr;
+    switch (m_kernel)
+    {
+#ifdef YUV_HAVE_X86
+    case KernelSse2:
+        vectorRow = nv12 ? rowNv12Sse2 : rowI420Sse2;
+        break;
+    case KernelAvx2:
+        vectorRow = nv12 ? rowNv12Avx2 : rowI420Avx2;
+        break;
+#endif
+#ifdef YUV_HAVE_NEON
+    case KernelNeon:
+        vectorRow = nv12 ? rowNv12Neon : rowI420Neon;
+        break;
+#endif
+    default:
+        break;
+    }
+
+    for (int row = rowBegin; row < rowEnd; row++)
+    {
+        const uint8_t *y = frame->data[0] + static_cast<ptrdiff_t>(row) * frame->linesize[0];
+        const uint8_t *u = frame->data[1] + static_cast<ptrdiff_t>(row >> 1) * frame->linesize[1];
+        const uint8_t *v = nv12 ? nullptr
+                                : frame->data[2] + static_cast<ptrdiff_t>(row >> 1) * frame->linesize[2];
+        uint8_t *out = dst + static_cast<ptrdiff_t>(row) * dstStride;
+
+        int done = vectorRow ? vectorRow(y, u, v, out, frame->width, c) : 0;
+        if (done < frame->width)
+        {
+            // NV12 的色度按 UV 成对存放，偏移为 done；YUV420P 为 done / 2
+            const int chromaOffset = nv12 ? done : done / 2;
+            scalarRow(y + done, u + chromaOffset, v ? v + chromaOffset : nullptr,
+                      out + done * 4, frame->width - done, c);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef YUVCONVERT_H
+#define YUVCONVERT_H
+
+#include <cstdint>
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+/**
+ * @brief 4:2:0 YUV（YUV420P / YUVJ420P / NV12）到 RGB32 的向量化转换
+ *
+ * 仅做颜色空间转换，不做缩放；输入与输出尺寸一致时用来替代 sws_scale。
+ * 运行时按 CPU 选择内核：aarch64 使用 NEON，x86 使用 AVX2 或 SSE2，其余使用标量实现。
+ * 各内核使用完全相同的定点运算（系数 Q13），输出逐字节一致。
+ * 输出格式与 AV_PIX_FMT_RGB32 / QImage::Format_RGB32 相同。
+ */
+class YuvConverter
+{
+public:
+    enum Kernel
+    {
+        KernelScalar,
+        KernelSse2,
+        KernelAvx2,
+        KernelNeon
+    };
+
+    /**
+     * @brief 定点转换系数（Q13）
+     */
+    struct Coefficients
+    {
+        int yOffset;    // 亮度偏移：有限范围为 16，全范围为 0
+        int cy;         // Y 系数
+        int crv;        // V 对 R 的系数
+        int cgu;        // U 对 G 的系数（取负）
+        int cgv;        // V 对 G 的系数（取负）
+        int cbu;        // U 对 B 的系数
+    };
+
+    /**
+     * @brief 以当前 CPU 支持的最快内核构造
+     */
+    YuvConverter();
+
+    /**
+     * @brief 判断该帧能否由本转换器处理（像素格式为 4:2:0 且为 8 位）
+     */
+    static bool supports(const AVFrame *frame);
+
+    /**
+     * @brief 转换 [rowBegin, rowEnd) 范围内的行，可按行段并行调用
+     * @param dst 指向输出图像第 0 行
+     */
+    void convert(const AVFrame *frame, uint8_t *dst, int dstStride, int rowBegin, int rowEnd) const;
+
+    Kernel kernel() const { return m_kernel; }
+
+    /**
+     * @brief 强制使用指定内核（当前 CPU 不支持时返回 false，保持原内核）
+     */
+    bool setKernel(Kernel kernel);
+
+    static bool kernelAvailable(Kernel kernel);
+    static Kernel bestKernel();
+    static const char *kernelName(Kernel kernel);
+
+    /**
+     * @brief 根据帧的色彩空间（BT.601 / BT.709）和取值范围选择系数
+     */
+    static Coefficients coefficientsFor(const AVFrame *frame);
+
+private:
+    Kernel m_kernel;
+};
+
+#endif // YUVCONVERT_H